@@ -0,0 +1,394 @@
+/*
+ * Arpeggiator.cpp
+ *
+ * Arpeggiator that plays the notes held on the MIDI buttons one after the other in up, down, up-down or random order,
+ * over a range of octaves. The held notes are kept sorted in two sets: the Timer1 interrupt plays one of them while
+ * the main loop updates the other one, which is published by switching the sets.
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "Arpeggiator.h"
+
+Arpeggiator::Arpeggiator()
+{
+    _numNotes[0] = 0;
+    _numNotes[1] = 0;
+    _playedSet = 0;
+
+    _mode = UP;
+    _octaves = 1;
+    _rate = 4;
+    _midiChannel = 1;
+
+    _ticks = 0;
+    _noteIndex = 0;
+    _octave = 0;
+    _direction = 1;
+    _playingNote = NO_NOTE;
+    _randomState = 1;
+}
+
+/*
+* GETTERS
+*/
+
+uint8_t Arpeggiator::getMode()
+{
+    return _mode;
+}
+
+uint8_t Arpeggiator::getOctaves()
+{
+    return _octaves;
+}
+
+uint8_t Arpeggiator::getRate()
+{
+    return _rate;
+}
+
+/*
+* Return the name of the playback order. The name is stored in PROGMEM
+*/
+const __FlashStringHelper *Arpeggiator::getModeName()
+{
+    return (const __FlashStringHelper *)pgm_read_word(&(arpeggiatorMessages[_mode]));
+}
+
+/*
+* SETTERS
+*/
+
+void Arpeggiator::setMode(uint8_t mode)
+{
+    _mode = mode;
+}
+
+void Arpeggiator::setOctaves(uint8_t octaves)
+{
+    _octaves = constrain(octaves, 1, MAX_OCTAVES);
+}
+
+/*
+* Set the number of notes played within a quarter note: 1, 2, 4 or 8
+*/
+void Arpeggiator::setRate(uint8_t rate)
+{
+    _rate = rate;
+}
+
+void Arpeggiator::setMIDIChannel(uint8_t channel)
+{
+    _midiChannel = channel;
+}
+
+/*
+* Add a held note. The note is inserted in order into a copy of the played set, which is published afterwards
+* note: the note
+*/
+void Arpeggiator::addNote(uint8_t note)
+{
+    uint8_t set = _playedSet;
+    uint8_t numNotes = _numNotes[set];
+    uint8_t position = findNote(_notes[set], numNotes, note);
+
+    // the note is already held or there is no room for it
+    if ((position < numNotes && _notes[set][position] == note) || numNotes == MAX_NOTES)
+    {
+        return;
+    }
+
+    memcpy(_notes[set ^ 1], _notes[set], position);
+    _notes[set ^ 1][position] = note;
+    memcpy(&_notes[set ^ 1][position + 1], &_notes[set][position], numNotes - position);
+    _numNotes[set ^ 1] = numNotes + 1;
+
+    publish(set ^ 1);
+}
+
+/*
+* Remove a held note. The note is removed from a copy of the played set, which is published afterwards
+* note: the note
+*/
+void Arpeggiator::removeNote(uint8_t note)
+{
+    uint8_t set = _playedSet;
+    uint8_t numNotes = _numNotes[set];
+    uint8_t position = findNote(_notes[set], numNotes, note);
+
+    // the note is not held
+    if (position == numNotes || _notes[set][position] != note)
+    {
+        return;
+    }
+
+    memcpy(_notes[set ^ 1], _notes[set], position);
+    memcpy(&_notes[set ^ 1][position], &_notes[set][position + 1], numNotes - position - 1);
+    _numNotes[set ^ 1] = numNotes - 1;
+
+    publish(set ^ 1);
+}
+
+/*
+* Release all the held notes
+*/
+void Arpeggiator::clear()
+{
+    _numNotes[_playedSet ^ 1] = 0;
+
+    publish(_playedSet ^ 1);
+}
+
+/*
+* Returns the position of a note within a sorted set of notes, or the position where it has to be inserted
+* notes: the sorted set of notes
+* numNotes: number of notes of the set
+* note: the note
+*/
+uint8_t Arpeggiator::findNote(uint8_t *notes, uint8_t numNotes, uint8_t note)
+{
+    uint8_t first = 0;
+    uint8_t last = numNotes;
+
+    while (first < last)
+    {
+        uint8_t middle = (first + last) / 2;
+
+        if (notes[middle] < note)
+        {
+            first = middle + 1;
+        }
+
+        else
+        {
+            last = middle;
+        }
+    }
+
+    return first;
+}
+
+/*
+* Make the interrupt play a set of notes. Switching the set is a single byte write, so the interrupt never sees a set
+* being updated. The barrier keeps the compiler from moving the writes of the set after it
+* set: the set of notes
+*/
+void Arpeggiator::publish(uint8_t set)
+{
+    __asm__ __volatile__("" ::: "memory");
+    _playedSet = set;
+}
+
+/*
+* Play the next held note when its time comes. This method is called from the Timer1 interrupt on every MIDI clock tick.
+* A note sounds until the next one starts, and the last one is released as soon as no note is held
+* midiWorker: worker used to send the notes
+*/
+void Arpeggiator::tick(MidiWorker *midiWorker)
+{
+    uint8_t *notes = _notes[_playedSet];
+    uint8_t numNotes = _numNotes[_playedSet];
+
+    if (numNotes == 0)
+    {
+        if (_playingNote != NO_NOTE)
+        {
+            sendNote(midiWorker, midi::NoteOff, _playingNote, 0);
+            _playingNote = NO_NOTE;
+        }
+
+        // the first note pressed is played on the next tick
+        _ticks = 0;
+
+        return;
+    }
+
+    if (_ticks == 0)
+    {
+        playNextNote(midiWorker, notes, numNotes);
+        _ticks = TICKS_PER_QUARTER / _rate;
+    }
+
+    _ticks--;
+}
+
+/*
+* Play the next note of the arpeggio and move to the following one regarding the playback order
+* midiWorker: worker used to send the notes
+* notes: the held notes
+* numNotes: number of held notes
+*/
+void Arpeggiator::playNextNote(MidiWorker *midiWorker, uint8_t *notes, uint8_t numNotes)
+{
+    // an arpeggio starts when the first note is pressed
+    if (_playingNote == NO_NOTE)
+    {
+        restart(numNotes);
+    }
+
+    // the held notes or the octaves may have changed since the previous note
+    _noteIndex = min(_noteIndex, numNotes - 1);
+    _octave = min(_octave, _octaves - 1);
+
+    uint8_t note = notes[_noteIndex] + (12 * _octave);
+
+    while (note > 127)
+    {
+        note -= 12;
+    }
+
+    if (_playingNote != NO_NOTE)
+    {
+        sendNote(midiWorker, midi::NoteOff, _playingNote, 0);
+    }
+
+    sendNote(midiWorker, midi::NoteOn, note, 127);
+    _playingNote = note;
+
+    switch (_mode)
+    {
+    case UP:
+        if (!moveUp(numNotes))
+        {
+            _noteIndex = 0;
+            _octave = 0;
+        }
+
+        break;
+
+    case DOWN:
+        if (!moveDown(numNotes))
+        {
+            _noteIndex = numNotes - 1;
+            _octave = _octaves - 1;
+        }
+
+        break;
+
+    // the highest and lowest notes are not repeated when the direction changes
+    case UP_DOWN:
+        if (!(_direction > 0 ? moveUp(numNotes) : moveDown(numNotes)))
+        {
+            _direction = -_direction;
+            _direction > 0 ? moveUp(numNotes) : moveDown(numNotes);
+        }
+
+        break;
+
+    default:
+        _noteIndex = getRandom() % numNotes;
+        _octave = getRandom() % _octaves;
+    }
+}
+
+/*
+* Move to the first note of the arpeggio regarding the playback order
+* numNotes: number of held notes
+*/
+void Arpeggiator::restart(uint8_t numNotes)
+{
+    _direction = 1;
+    _randomState = ((uint16_t)micros() ^ _randomState) | 1;
+
+    if (_mode == DOWN)
+    {
+        _noteIndex = numNotes - 1;
+        _octave = _octaves - 1;
+    }
+
+    else
+    {
+        _noteIndex = 0;
+        _octave = 0;
+    }
+}
+
+/*
+* Move to the next higher note
+* Return: 0 if the highest note of the highest octave is already reached, 1 otherwise
+* numNotes: number of held notes
+*/
+uint8_t Arpeggiator::moveUp(uint8_t numNotes)
+{
+    if (_noteIndex + 1 < numNotes)
+    {
+        _noteIndex++;
+    }
+
+    else if (_octave + 1 < _octaves)
+    {
+        _noteIndex = 0;
+        _octave++;
+    }
+
+    else
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+* Move to the next lower note
+* Return: 0 if the lowest note of the lowest octave is already reached, 1 otherwise
+* numNotes: number of held notes
+*/
+uint8_t Arpeggiator::moveDown(uint8_t numNotes)
+{
+    if (_noteIndex > 0)
+    {
+        _noteIndex--;
+    }
+
+    else if (_octave > 0)
+    {
+        _noteIndex = numNotes - 1;
+        _octave--;
+    }
+
+    else
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+* Send a note message on the arpeggiator MIDI channel
+* midiWorker: worker used to send the message
+* type: MIDI message type
+* note: note of the message
+* velocity: velocity of the message
+*/
+void Arpeggiator::sendNote(MidiWorker *midiWorker, uint8_t type, uint8_t note, uint8_t velocity)
+{
+    uint8_t message[3] = {(uint8_t)(type | ((_midiChannel - 1) & 0x0F)), note, velocity};
+
+    midiWorker->sendChannelMessages(message, 3);
+}
+
+/*
+* Returns the next value of a xorshift random number generator
+*/
+uint8_t Arpeggiator::getRandom()
+{
+    _randomState ^= _randomState << 7;
+    _randomState ^= _randomState >> 9;
+    _randomState ^= _randomState << 8;
+
+    return (uint8_t)_randomState;
+}
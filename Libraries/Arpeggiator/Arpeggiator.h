@@ -0,0 +1,119 @@
+/*
+ * Arpeggiator.h
+ *
+ * Arpeggiator that plays the notes held on the MIDI buttons one after the other in up, down, up-down or random order,
+ * over a range of octaves. The held notes are kept sorted in two sets: the Timer1 interrupt plays one of them while
+ * the main loop updates the other one, which is published by switching the sets.
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef Arpeggiator_h
+#define Arpeggiator_h
+
+#include <Arduino.h>
+#include <MidiWorker.h>
+#include <MIDI.h>
+#include <avr/pgmspace.h>
+
+/* String characters inserted into PROGMEM area */
+#define MSG_ARP_UP 0
+#define MSG_ARP_DOWN 1
+#define MSG_ARP_UP_DOWN 2
+#define MSG_ARP_RANDOM 3
+
+// Messages that will be displayed on the screen
+const char msg_ArpUp[] PROGMEM = "Up";
+const char msg_ArpDown[] PROGMEM = "Dwn";
+const char msg_ArpUpDown[] PROGMEM = "U-D";
+const char msg_ArpRandom[] PROGMEM = "Rnd";
+
+const char *const arpeggiatorMessages[] PROGMEM = {msg_ArpUp, msg_ArpDown, msg_ArpUpDown, msg_ArpRandom};
+
+class Arpeggiator
+{
+public:
+  Arpeggiator();
+
+  enum
+  {
+    UP,
+    DOWN,
+    UP_DOWN,
+    RANDOM
+  }; // playback orders
+  enum
+  {
+    MODE_TYPES = 4
+  }; // number of playback orders
+  enum
+  {
+    MAX_NOTES = 12
+  }; // maximum number of notes held at the same time
+  enum
+  {
+    MAX_OCTAVES = 4
+  }; // maximum number of octaves the held notes are played over
+  enum
+  {
+    TICKS_PER_QUARTER = 24
+  }; // MIDI clock ticks within a quarter note
+  enum
+  {
+    NO_NOTE = 0xFF
+  }; // no note is being played
+
+  void addNote(uint8_t note);
+  void removeNote(uint8_t note);
+  void clear();
+  void tick(MidiWorker *midiWorker);
+
+  uint8_t getMode();
+  uint8_t getOctaves();
+  uint8_t getRate();
+  const __FlashStringHelper *getModeName();
+
+  void setMode(uint8_t mode);
+  void setOctaves(uint8_t octaves);
+  void setRate(uint8_t rate);
+  void setMIDIChannel(uint8_t channel);
+
+private:
+  uint8_t findNote(uint8_t *notes, uint8_t numNotes, uint8_t note);
+  void publish(uint8_t set);
+  void playNextNote(MidiWorker *midiWorker, uint8_t *notes, uint8_t numNotes);
+  void restart(uint8_t numNotes);
+  uint8_t moveUp(uint8_t numNotes);
+  uint8_t moveDown(uint8_t numNotes);
+  void sendNote(MidiWorker *midiWorker, uint8_t type, uint8_t note, uint8_t velocity);
+  uint8_t getRandom();
+
+  uint8_t _notes[2][MAX_NOTES];  // held notes sorted from the lowest one. The interrupt plays one set while the other one is updated
+  uint8_t _numNotes[2];          // number of held notes of each set
+  volatile uint8_t _playedSet;   // set of notes played by the interrupt
+
+  uint8_t _mode;                 // playback order
+  uint8_t _octaves;              // number of octaves the held notes are played over
+  uint8_t _rate;                 // notes played within a quarter note
+  uint8_t _midiChannel;          // MIDI channel of the notes played
+
+  // State of the interrupt
+  uint8_t _ticks;                // MIDI clock ticks left until the next note is played
+  uint8_t _noteIndex;            // held note to be played next
+  uint8_t _octave;               // octave of the note to be played next
+  int8_t _direction;             // direction (1 or -1) of the up-down order
+  uint8_t _playingNote;          // note being played. NO_NOTE if there is none
+  uint16_t _randomState;         // state of the xorshift random number generator
+};
+#endif
@@ -41,6 +41,9 @@
  *************************************************/
 const uint8_t OPERATION_MODE_BUTTON_PIN = 12;
 
+// Note of the MIDI button that leaves the sequencer untransposed when pressed while holding the edit mode button (C3)
+const uint8_t TRANSPOSE_REFERENCE_NOTE = 48;
+
 /*************************************************
  * MIDI BUTTONS CONFIGURATION
  *************************************************/
@@ -115,12 +118,24 @@ const uint8_t OPERATION_MODE_BUTTON_PIN = 12;
 const uint8_t I2C_ADDRESS = 0x27;
 const uint8_t COLUMNS = 16;
 const uint8_t ROWS = 2;
+const uint8_t SCREEN_REFRESH_MS = 33; // minimum time (ms) between two refreshes of the values edited with the select value potentiometer (30 Hz)
 //-------------------------------- E N D  O F  S C R E E N  S E C T I O N ---------------------------------------------
 
+//-------------------------------- I 2 C  B U S  S E C T I O N ---------------------------------------------------------
+const uint32_t I2C_CLOCK = 400000; // I2C bus clock (Hz): fast mode. Set it to 100000 if a device on the bus only supports the standard mode
+const uint8_t MEMORY_ON_I2C = 0;   // 1 when the pages and sequences are stored into an external I2C EEPROM, so the memory shares the bus with the screen
+//-------------------------------- E N D  O F  I 2 C  B U S  S E C T I O N ---------------------------------------------
+
+//-------------------------------- M I D I  O U T P U T  S E C T I O N ---------------------------------------------------------
+const uint8_t MIDI_RUNNING_STATUS = 1;             // omit repeated status bytes on the MIDI output
+const uint16_t RUNNING_STATUS_REFRESH_MS = 500;    // maximum time (ms) between two status bytes when running status is enabled
+//-------------------------------- E N D  O F  M I D I  O U T P U T  S E C T I O N ---------------------------------------------
+
 //-------------------------------- T E M P O  S E C T I O N ---------------------------------------------------------
 const uint8_t MIN_BPM = 20;
-const uint16_t MAX_BPM = 300;
+const uint16_t MAX_BPM = 300; // the worst clock tick of the tracks and the arpeggiator takes longer than a clock period on the MIDI wire, its bytes are sent during the next ticks from the serial buffer
 const uint8_t BAR_LENGTH = 4; // number of quarter notes within a bar
+const uint8_t SEQUENCER_TRACKS = 4; // number of sequencer tracks played at the same time, each one with its own sequence
 //-------------------------------- E N D  O F  T E M P O  S E C T I O N ---------------------------------------------
 
 //-------------------------------- M U L T I P L E X E R  S E C T I O N  ---------------------------------------------------------
@@ -134,6 +149,8 @@ const uint8_t MUX1_MIDI_POTS_CONTROL_PINS [MUX1_MIDI_POTS_NUM_CONTROL_PINS] = {2
 //-------------------------------- E N D  O F  M U L T I P L E X E R  S E C T I O N ---------------------------------------------
 const uint8_t NUM_PAGES = 10;
 const uint8_t NUM_SEQUENCES = 10;
+const uint8_t MAX_SEQUENCE_LENGTH = 64; // maximum number of steps within a stored sequence
+const uint8_t CHAIN_LENGTH = 16;        // maximum number of entries (sequence and repeats) within the song chain
 //-------------------------------- M E M O R Y  S E C T I O N  ---------------------------------------------------------
 
 //-------------------------------- E N D  O F  M E M O R Y  S E C T I O N ---------------------------------------------
@@ -0,0 +1,230 @@
+/*
+ * EuclideanGenerator.cpp
+ *
+ * Generator of euclidean rhythms: a number of hits spread as evenly as possible over a number of steps, calculated
+ * with Bjorklund's algorithm. The generation runs a few steps on each call, so it can be spread over several passes
+ * of the main loop. The resulting pattern is repeated over the length of a sequence and cached as a bitmap.
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "EuclideanGenerator.h"
+
+EuclideanGenerator::EuclideanGenerator()
+{
+    reset();
+}
+
+/*
+* Start the generation of a new pattern. Any pattern being generated is discarded
+* hits: number of hits of the pattern
+* steps: number of steps of the pattern, from 1 to MAX_STEPS
+* rotation: steps the pattern is rotated to the right
+* length: number of steps of the sequence the pattern is repeated over, from 1 to MAX_STEPS
+*/
+void EuclideanGenerator::start(uint8_t hits, uint8_t steps, uint8_t rotation, uint8_t length)
+{
+    _steps = constrain(steps, 1, MAX_STEPS);
+    _hits = min(hits, _steps);
+    _rotation = rotation % _steps;
+    _length = constrain(length, 1, MAX_STEPS);
+
+    _stackSize = 0;
+    _patternSteps = 0;
+    _firstHit = NO_HIT;
+    _sequenceSteps = 0;
+
+    _status = COUNTING;
+}
+
+/*
+* Run the generation of the current pattern
+* Return: 1 when the pattern is ready, 0 otherwise
+* numSteps: maximum number of steps to build or expand
+*/
+uint8_t EuclideanGenerator::generate(uint8_t numSteps)
+{
+    switch (_status)
+    {
+    case COUNTING:
+
+        count();
+        break;
+
+    case BUILDING:
+
+        // empty and full patterns have a single level, so they are filled directly
+        if (_hits == 0 || _hits == _steps)
+        {
+            while (_patternSteps < _steps && numSteps-- > 0)
+            {
+                emit(_hits != 0);
+            }
+        }
+
+        // each frame of the stack makes the next call of the recursive build of Bjorklund's algorithm
+        else
+        {
+            while (_stackSize > 0 && _patternSteps < _steps && numSteps > 0)
+            {
+                Frame *frame = &_stack[_stackSize - 1];
+                uint8_t builtSteps = _patternSteps;
+
+                if (frame->calls < _counts[frame->level])
+                {
+                    frame->calls++;
+                    build(frame->level - 1);
+                }
+
+                else if (frame->calls == _counts[frame->level] && _remainders[frame->level] != 0)
+                {
+                    frame->calls++;
+                    build(frame->level - 2);
+                }
+
+                else
+                {
+                    _stackSize--;
+                }
+
+                numSteps -= _patternSteps - builtSteps;
+            }
+        }
+
+        if (_patternSteps >= _steps)
+        {
+            // the pattern starts with its first hit and is rotated from there
+            _patternStep = ((_firstHit == NO_HIT ? 0 : _firstHit) + _steps - _rotation) % _steps;
+            _status = EXPANDING;
+        }
+
+        break;
+
+    case EXPANDING:
+
+        while (_sequenceSteps < _length && numSteps-- > 0)
+        {
+            bitWrite(_sequence[_sequenceSteps / 8], _sequenceSteps % 8, bitRead(_pattern[_patternStep / 8], _patternStep % 8));
+
+            _sequenceSteps++;
+            _patternStep = (_patternStep + 1 < _steps) ? _patternStep + 1 : 0;
+        }
+
+        if (_sequenceSteps >= _length)
+        {
+            _status = READY;
+        }
+
+        break;
+    }
+
+    return _status == READY;
+}
+
+/*
+* Calculate the counts and remainders of each level of Bjorklund's algorithm and start the build from the top level
+*/
+void EuclideanGenerator::count()
+{
+    if (_hits == 0 || _hits == _steps)
+    {
+        _status = BUILDING;
+        return;
+    }
+
+    uint8_t divisor = _steps - _hits;
+    uint8_t level = 0;
+
+    _remainders[0] = _hits;
+
+    do
+    {
+        _counts[level] = divisor / _remainders[level];
+        _remainders[level + 1] = divisor % _remainders[level];
+        divisor = _remainders[level];
+        level++;
+    } while (_remainders[level] > 1 && level < MAX_LEVELS - 1);
+
+    _counts[level] = divisor;
+
+    build(level);
+
+    _status = BUILDING;
+}
+
+/*
+* Make a call of the recursive build of Bjorklund's algorithm. Levels -1 and -2 emit a step without and with a hit,
+* the rest of them are pushed into the stack
+* level: level of the call
+*/
+void EuclideanGenerator::build(int8_t level)
+{
+    if (level == -1)
+    {
+        emit(0);
+    }
+
+    else if (level == -2)
+    {
+        emit(1);
+    }
+
+    else
+    {
+        _stack[_stackSize].level = level;
+        _stack[_stackSize].calls = 0;
+        _stackSize++;
+    }
+}
+
+/*
+* Add a step to the built pattern
+* hit: 1 if the step has a hit, 0 otherwise
+*/
+void EuclideanGenerator::emit(uint8_t hit)
+{
+    if (hit && _firstHit == NO_HIT)
+    {
+        _firstHit = _patternSteps;
+    }
+
+    bitWrite(_pattern[_patternSteps / 8], _patternSteps % 8, hit ? 1 : 0);
+    _patternSteps++;
+}
+
+/*
+* Returns 1 if the pattern is ready, 0 otherwise
+*/
+uint8_t EuclideanGenerator::isReady()
+{
+    return _status == READY;
+}
+
+/*
+* Returns 1 if a step of the sequence has a hit in the generated pattern, 0 otherwise
+* step: the step of the sequence
+*/
+uint8_t EuclideanGenerator::isHit(uint8_t step)
+{
+    return (step < _length) ? bitRead(_sequence[step / 8], step % 8) : 0;
+}
+
+/*
+* Discard the pattern
+*/
+void EuclideanGenerator::reset()
+{
+    _status = IDLE;
+    _stackSize = 0;
+}
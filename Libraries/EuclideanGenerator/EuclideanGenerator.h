@@ -0,0 +1,88 @@
+/*
+ * EuclideanGenerator.h
+ *
+ * Generator of euclidean rhythms: a number of hits spread as evenly as possible over a number of steps, calculated
+ * with Bjorklund's algorithm. The generation runs a few steps on each call, so it can be spread over several passes
+ * of the main loop. The resulting pattern is repeated over the length of a sequence and cached as a bitmap.
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef EuclideanGenerator_h
+#define EuclideanGenerator_h
+
+#include <Arduino.h>
+
+class EuclideanGenerator
+{
+public:
+  EuclideanGenerator();
+
+  enum
+  {
+    MAX_STEPS = 64
+  }; // maximum number of steps of a pattern and of the sequence it is repeated over
+  enum
+  {
+    MAX_LEVELS = 12
+  }; // maximum recursion levels of Bjorklund's algorithm for MAX_STEPS steps
+  enum
+  {
+    NO_HIT = 0xFF
+  }; // the built pattern has no hits yet
+  enum
+  {
+    IDLE,
+    COUNTING,
+    BUILDING,
+    EXPANDING,
+    READY
+  }; // generation status
+
+  void start(uint8_t hits, uint8_t steps, uint8_t rotation, uint8_t length);
+  uint8_t generate(uint8_t numSteps);
+  uint8_t isReady();
+  uint8_t isHit(uint8_t step);
+  void reset();
+
+private:
+  void count();
+  void build(int8_t level);
+  void emit(uint8_t hit);
+
+  struct Frame
+  {
+    int8_t level;  // recursion level of the frame
+    uint8_t calls; // calls to the lower levels already made by the frame
+  };
+
+  uint8_t _status;                         // generation status
+  uint8_t _hits;                           // number of hits of the pattern
+  uint8_t _steps;                          // number of steps of the pattern
+  uint8_t _rotation;                       // steps the pattern is rotated to the right
+  uint8_t _length;                         // number of steps of the sequence the pattern is repeated over
+
+  uint8_t _counts[MAX_LEVELS];             // Bjorklund's counts of each level
+  uint8_t _remainders[MAX_LEVELS];         // Bjorklund's remainders of each level
+  Frame _stack[MAX_LEVELS + 1];            // pending recursive calls while the pattern is built
+  uint8_t _stackSize;                      // number of frames within the stack
+
+  uint8_t _pattern[MAX_STEPS / 8];         // pattern as returned by Bjorklund's algorithm, one bit per step
+  uint8_t _patternSteps;                   // number of steps already built
+  uint8_t _firstHit;                       // first step of the built pattern with a hit
+  uint8_t _sequence[MAX_STEPS / 8];        // rotated pattern repeated over the sequence length, one bit per step
+  uint8_t _sequenceSteps;                  // number of sequence steps already expanded
+  uint8_t _patternStep;                    // step of the built pattern that corresponds to the next sequence step
+};
+#endif
@@ -0,0 +1,155 @@
+/*
+ * EventScheduler.cpp
+ *
+ * Timing wheel that sends MIDI channel messages a number of MIDI clock ticks after they were scheduled.
+ * It is used by the sequencer for note offs (gate length) and repeated notes (ratchets).
+ * Scheduling and expiring an event take constant time regardless of the number of pending events.
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "EventScheduler.h"
+
+EventScheduler::EventScheduler()
+{
+    // all the events are free and the wheel is empty
+    for (uint8_t i = 0; i < POOL_SIZE; i++)
+    {
+        _events[i].message[0] = 0;
+        _events[i].next = i + 1;
+    }
+
+    _events[POOL_SIZE - 1].next = NO_EVENT;
+    _freeEvents = 0;
+
+    for (uint8_t i = 0; i < WHEEL_SIZE; i++)
+    {
+        _slots[i] = NO_EVENT;
+    }
+
+    _currentSlot = 0;
+}
+
+/*
+* Schedule a MIDI channel message
+* ticks: number of MIDI clock ticks from now when the message is sent, from 1 to WHEEL_SIZE - 1
+* status: status byte of the message
+* data1: first data byte of the message
+* data2: second data byte of the message
+* returns the event of the message, used to cancel it. NO_EVENT if there are no free events
+*/
+uint8_t EventScheduler::schedule(uint8_t ticks, uint8_t status, uint8_t data1, uint8_t data2)
+{
+    if (_freeEvents == NO_EVENT)
+    {
+        return NO_EVENT;
+    }
+
+    if (ticks == 0)
+    {
+        ticks = 1;
+    }
+
+    else if (ticks >= WHEEL_SIZE)
+    {
+        ticks = WHEEL_SIZE - 1;
+    }
+
+    // take an event from the free list
+    uint8_t event = _freeEvents;
+    _freeEvents = _events[event].next;
+
+    _events[event].message[0] = status;
+    _events[event].message[1] = data1;
+    _events[event].message[2] = data2;
+
+    // insert the event at the head of its slot
+    uint8_t slot = (_currentSlot + ticks) & (WHEEL_SIZE - 1);
+    _events[event].next = _slots[slot];
+    _slots[slot] = event;
+
+    return event;
+}
+
+/*
+* Cancel a pending message, so it is never sent. The event stays in its slot until the slot expires
+* and frees it, so the message is cancelled without searching the wheel
+* event: the event returned by schedule() for the message
+* status: status byte of the message, checked because the event may have been sent and reused since it was scheduled
+* data1: first data byte of the message
+* returns 1 if the message was cancelled, 0 if it was not pending
+*/
+uint8_t EventScheduler::cancel(uint8_t event, uint8_t status, uint8_t data1)
+{
+    if (event >= POOL_SIZE || _events[event].message[0] != status || _events[event].message[1] != data1)
+    {
+        return 0;
+    }
+
+    _events[event].message[0] = 0;
+
+    return 1;
+}
+
+/*
+* Move the wheel one MIDI clock tick and send the messages scheduled for it. Called from the Timer1 interrupt
+* midiWorker: worker used to send the messages
+*/
+void EventScheduler::tick(MidiWorker *midiWorker)
+{
+    _currentSlot = (_currentSlot + 1) & (WHEEL_SIZE - 1);
+
+    expireSlot(_currentSlot, midiWorker, 1);
+}
+
+/*
+* Send all the pending messages right now, but the note ons, which are discarded. Used when the playback is stopped
+* midiWorker: worker used to send the messages
+*/
+void EventScheduler::flush(MidiWorker *midiWorker)
+{
+    for (uint8_t i = 1; i <= WHEEL_SIZE; i++)
+    {
+        expireSlot((_currentSlot + i) & (WHEEL_SIZE - 1), midiWorker, 0);
+    }
+}
+
+/*
+* Send the messages of a slot, but the cancelled ones, and return its events to the free list
+* slot: the slot to expire
+* midiWorker: worker used to send the messages
+* sendNoteOns: 1 to send the note ons of the slot, 0 to discard them
+*/
+void EventScheduler::expireSlot(uint8_t slot, MidiWorker *midiWorker, uint8_t sendNoteOns)
+{
+    uint8_t event = _slots[slot];
+
+    while (event != NO_EVENT)
+    {
+        uint8_t next = _events[event].next;
+
+        if (_events[event].message[0] != 0 && (sendNoteOns || (_events[event].message[0] & 0xF0) != midi::NoteOn))
+        {
+            midiWorker->sendChannelMessages(_events[event].message, 3);
+        }
+
+        _events[event].message[0] = 0;
+        _events[event].next = _freeEvents;
+        _freeEvents = event;
+
+        event = next;
+    }
+
+    _slots[slot] = NO_EVENT;
+}
@@ -0,0 +1,65 @@
+/*
+ * EventScheduler.h
+ *
+ * Timing wheel that sends MIDI channel messages a number of MIDI clock ticks after they were scheduled.
+ * It is used by the sequencer for note offs (gate length) and repeated notes (ratchets).
+ * Scheduling and expiring an event take constant time regardless of the number of pending events.
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef EventScheduler_h
+#define EventScheduler_h
+
+#include <Arduino.h>
+#include <MidiWorker.h>
+#include <Step.h>
+#include <ControllerConfig.h>
+
+class EventScheduler
+{
+public:
+  EventScheduler();
+
+  enum
+  {
+    WHEEL_SIZE = 32,
+    POOL_SIZE = SEQUENCER_TRACKS * (2 + 2 * (Step::MAX_RATCHETS - 1))
+  }; // number of ticks covered by the wheel (power of two) and maximum number of pending events. Every track can have
+     // the note off of a legato step pending when its next step schedules its note off and the note on and off of its ratchets
+  enum
+  {
+    NO_EVENT = 0xFF
+  }; // end of an event list
+
+  uint8_t schedule(uint8_t ticks, uint8_t status, uint8_t data1, uint8_t data2);
+  uint8_t cancel(uint8_t event, uint8_t status, uint8_t data1);
+  void tick(MidiWorker *midiWorker);
+  void flush(MidiWorker *midiWorker);
+
+private:
+  void expireSlot(uint8_t slot, MidiWorker *midiWorker, uint8_t sendNoteOns);
+
+  struct Event
+  {
+    uint8_t message[3]; // status, data1 and data2 bytes of the channel message. Status 0 if the event is free or cancelled
+    uint8_t next;       // next event within the same slot or within the free list
+  };
+
+  Event _events[POOL_SIZE];    // pool of events
+  uint8_t _slots[WHEEL_SIZE];  // first event to be sent on each tick of the wheel
+  uint8_t _freeEvents;         // first event of the free list
+  uint8_t _currentSlot;        // slot of the current tick
+};
+#endif
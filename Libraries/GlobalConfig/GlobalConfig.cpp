@@ -30,6 +30,8 @@ GlobalConfig::GlobalConfig(uint8_t MIDIChannel, uint8_t sequencerMIDIChannel, ui
      _mode = mode; 
      _rootNote = rootNote;
      _sendClockWhilePlayback = sendClockWhilePlayback;
+
+     updateScale();
 }   
 
 /*
@@ -53,11 +55,13 @@ void GlobalConfig::setSequencerMIDIChannel(uint8_t sequencerMIDIChannel)
 void GlobalConfig::setMode(uint8_t mode)
 {
     _mode = mode;
+    updateScale();
 }
 
 void GlobalConfig::setRootNote(uint8_t rootNote)
 {
     _rootNote = rootNote;
+    updateScale();
 }
 
 void GlobalConfig::setSendClockWhilePlayback (uint8_t sendClockWhilePlayback)
@@ -96,4 +100,59 @@ uint8_t GlobalConfig::getSendClockWhilePlayback()
 uint8_t GlobalConfig::getSize()
 {
     return sizeof(uint8_t) * 5;    
-}
\ No newline at end of file
+}
+
+uint16_t GlobalConfig::getScaleMask()
+{
+    return _scaleMask;
+}
+
+/*
+* Return the number of notes of the scale within a range
+* lowNote: lowest note of the range
+* highNote: highest note of the range
+*/
+uint8_t GlobalConfig::getScaleNotesNumber(uint8_t lowNote, uint8_t highNote)
+{
+    return getScaleRank(highNote + 1) - getScaleRank(lowNote);
+}
+
+/*
+* Return the note of the scale placed at a position from a note. Used to map the potentiometer positions to notes of the scale
+* lowNote: note from which the notes of the scale are counted
+* index: position of the note within the notes of the scale from lowNote. The first note of the scale from lowNote is 0
+*/
+uint8_t GlobalConfig::getScaleNote(uint8_t lowNote, uint8_t index)
+{
+    uint8_t rank = getScaleRank(lowNote) + index;
+
+    return ((rank / _scaleSize) * 12) + _scaleNotes[rank % _scaleSize];
+}
+
+/*
+* Build the scale mask and its rank/select indexes. Called each time the mode or the root note change
+*/
+void GlobalConfig::updateScale()
+{
+    _scaleMask = MIDIUtils::getScaleMask(_rootNote, _mode);
+    _scaleSize = 0;
+
+    for (uint8_t note = 0; note < 12; note++)
+    {
+        _scaleRanks[note] = _scaleSize;
+
+        if (bitRead(_scaleMask, note))
+        {
+            _scaleNotes[_scaleSize++] = note;
+        }
+    }
+}
+
+/*
+* Return the number of notes of the scale below a note
+* note: note which rank will be returned. It can be 128 to count all the notes of the scale
+*/
+uint8_t GlobalConfig::getScaleRank(uint8_t note)
+{
+    return ((note / 12) * _scaleSize) + _scaleRanks[note % 12];
+}
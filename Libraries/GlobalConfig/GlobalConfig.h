@@ -21,6 +21,7 @@
 #define GlobalConfig_h
 
 #include "Arduino.h"
+#include <MIDIUtils.h>
 
 class GlobalConfig
 {
@@ -40,6 +41,9 @@ class GlobalConfig
         uint8_t getRootNote();     
         uint8_t getSendClockWhilePlayback();
         uint8_t getSize();
+        uint16_t getScaleMask();
+        uint8_t getScaleNotesNumber(uint8_t lowNote, uint8_t highNote);
+        uint8_t getScaleNote(uint8_t lowNote, uint8_t index);
     
     private:             
         uint8_t _MIDIChannel;                   // Controller's MIDI channel
@@ -47,5 +51,12 @@ class GlobalConfig
         uint8_t _mode;                          // Musical mode of the controller (Ionian,...)
         uint8_t _rootNote;                      // Root note of the musical mode (C, D,...)
         uint8_t _sendClockWhilePlayback;        // Flag which indicates wether the MIDI clock and the sequence playback has to be executed in sync        
+        uint16_t _scaleMask;                    // Notes (C = bit 0, Db = bit 1,...) of the scale defined by the mode and the root note
+        uint8_t _scaleSize;                     // Number of notes per octave of the scale
+        uint8_t _scaleNotes[12];                // Select index: the k-th note of the scale within an octave
+        uint8_t _scaleRanks[12];                // Rank index: number of notes of the scale below each note within an octave
+
+        void updateScale();
+        uint8_t getScaleRank(uint8_t note);
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+/*
+ * I2CBusManager.cpp
+ *
+ * Class that schedules the transactions of the workers that share the I2C bus, such as the screen and the memory, and
+ * accounts the bus time spent by each one of them. The transactions are scheduled on each pass of the main loop:
+ * a transaction is granted when no transaction of a higher priority has been queued on the same pass, otherwise it is
+ * queued and its worker retries it on the next pass.
+ *
+ * Copyright 2018 3K MEDIALAB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "I2CBusManager.h"
+
+I2CBusManager I2CBus;
+
+/*
+* Set the clock of the I2C bus and reset the scheduling and the accounting.
+* Wire.begin() sets the standard mode clock, so this must be called after the devices that start the Wire library
+* by themselves, such as the LCD
+*/
+void I2CBusManager::begin()
+{
+    Wire.setClock(I2C_CLOCK);
+
+    _queue = 0;
+    _owner = SCREEN_CLIENT;
+    _transactionStart = micros();
+
+    resetBusTime();
+}
+
+/*
+* Ask for the bus to do a transaction. The transaction is queued on the current pass of the main loop, and it is
+* granted if no transaction of a higher priority has been queued on the same pass.
+* Return: 1 if the transaction is granted and can be done right now, 0 if it has to be retried on the next pass
+* client: the worker that does the transaction
+* priority: priority of the transaction
+*/
+uint8_t I2CBusManager::acquire(uint8_t client, uint8_t priority)
+{
+    bitSet(_queue, priority);
+
+    if (_queue & ((1 << priority) - 1))
+    {
+        return 0;
+    }
+
+    _owner = client;
+    _transactionStart = micros();
+
+    return 1;
+}
+
+/*
+* End the transaction in progress, accounting its bus time to its client
+*/
+void I2CBusManager::release()
+{
+    _busTime[_owner] += micros() - _transactionStart;
+    _transactions[_owner]++;
+}
+
+/*
+* End the current pass of the main loop. The transactions queued on it are dropped, so the ones that were not granted
+* compete again on the next pass
+*/
+void I2CBusManager::endPass()
+{
+    _queue = 0;
+}
+
+/*
+* Returns the bus time (us) spent by a client since the accounting was reset
+* client: the worker
+*/
+uint32_t I2CBusManager::getBusTime(uint8_t client)
+{
+    return _busTime[client];
+}
+
+/*
+* Returns the number of transactions done by a client since the accounting was reset
+* client: the worker
+*/
+uint16_t I2CBusManager::getTransactions(uint8_t client)
+{
+    return _transactions[client];
+}
+
+/*
+* Reset the bus time and the transactions accounted to each client
+*/
+void I2CBusManager::resetBusTime()
+{
+    for (uint8_t client = 0; client < NUM_CLIENTS; client++)
+    {
+        _busTime[client] = 0;
+        _transactions[client] = 0;
+    }
+}
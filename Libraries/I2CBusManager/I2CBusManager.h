@@ -0,0 +1,65 @@
+/*
+ * I2CBusManager.h
+ *
+ * Class that schedules the transactions of the workers that share the I2C bus, such as the screen and the memory, and
+ * accounts the bus time spent by each one of them. The transactions are scheduled on each pass of the main loop:
+ * a transaction is granted when no transaction of a higher priority has been queued on the same pass, otherwise it is
+ * queued and its worker retries it on the next pass.
+ *
+ * Copyright 2018 3K MEDIALAB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef I2CBusManager_h
+#define I2CBusManager_h
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <ControllerConfig.h>
+
+class I2CBusManager
+{
+public:
+  enum Client
+  {
+    SCREEN_CLIENT,
+    MEMORY_CLIENT,
+    NUM_CLIENTS
+  }; // workers that use the I2C bus
+
+  enum Priority
+  {
+    LOAD_PRIORITY,     // reads and writes of pages, sequences and configuration
+    PLAYBACK_PRIORITY, // step grid following the sequencer playback
+    REFRESH_PRIORITY   // values and meters drawn by the screen refresh
+  }; // transaction priorities, from the highest one
+
+  void begin();
+  uint8_t acquire(uint8_t client, uint8_t priority);
+  void release();
+  void endPass();
+  uint32_t getBusTime(uint8_t client);
+  uint16_t getTransactions(uint8_t client);
+  void resetBusTime();
+
+private:
+  uint8_t _queue;                       // priorities (one bit each) of the transactions queued on the current pass of the main loop
+  uint8_t _owner;                       // client of the transaction in progress
+  uint32_t _transactionStart;           // time (us) when the transaction in progress was granted
+  uint32_t _busTime[NUM_CLIENTS];       // bus time (us) spent by each client since the accounting was reset
+  uint16_t _transactions[NUM_CLIENTS];  // transactions done by each client since the accounting was reset
+};
+
+extern I2CBusManager I2CBus; // the I2C bus shared by the controller workers
+#endif
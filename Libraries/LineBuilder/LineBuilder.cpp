@@ -0,0 +1,198 @@
+/*
+ * LineBuilder.cpp
+ *
+ * Class that builds a line of the screen into a char buffer. It keeps a cursor with the column where the next field is
+ * written, so the fields are appended and the line is padded without scanning it. Numbers can be written as fixed-width
+ * right aligned fields, and their digits are emitted without divisions.
+ *
+ * Copyright 2018 3K MEDIALAB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LineBuilder.h"
+
+// Powers of ten subtracted to get each digit of a number, from the most significant one
+const uint16_t powersOfTen[LINE_BUILDER_MAX_DIGITS - 1] PROGMEM = {10000, 1000, 100, 10};
+
+/*
+* Constructor
+* line: buffer where the line is built. It must have room for width chars plus the string terminator
+* width: number of columns of the line
+*/
+LineBuilder::LineBuilder(char *line, uint8_t width)
+{
+    _line = line;
+    _width = width;
+
+    clear();
+}
+
+/*
+* Move the cursor back to the first column, so a new line can be built into the buffer
+*/
+void LineBuilder::clear()
+{
+    _column = 0;
+    _line[0] = '\0';
+}
+
+/*
+* Append a char at the cursor. Chars beyond the width of the line are discarded
+* c: the char to be appended
+*/
+void LineBuilder::append(char c)
+{
+    if (_column < _width)
+    {
+        _line[_column++] = c;
+    }
+}
+
+/*
+* Append a string stored into the PROGMEM
+* text: the PROGMEM string
+*/
+void LineBuilder::appendText(const __FlashStringHelper *text)
+{
+    PGM_P p = (PGM_P)text;
+    char c;
+
+    while ((c = pgm_read_byte(p++)) != '\0')
+    {
+        append(c);
+    }
+}
+
+/*
+* Append a string stored into the RAM
+* text: the string
+*/
+void LineBuilder::appendText(const char *text)
+{
+    while (*text != '\0')
+    {
+        append(*text++);
+    }
+}
+
+/*
+* Append a number left aligned, using as many columns as digits it has
+* value: the number, with its sign if it is negative
+*/
+void LineBuilder::appendNumber(int16_t value)
+{
+    char digits[LINE_BUILDER_MAX_DIGITS];
+    uint8_t numDigits;
+
+    if (value < 0)
+    {
+        append('-');
+        value = -value;
+    }
+
+    numDigits = getDigits((uint16_t)value, digits);
+
+    for (uint8_t i = 0; i < numDigits; i++)
+    {
+        append(digits[i]);
+    }
+}
+
+/*
+* Append a number right aligned into a fixed-width field padded with spaces, so the fields after it do not move
+* when the number of digits changes. A number wider than the field takes as many columns as digits it has
+* value: the number
+* width: columns of the field
+*/
+void LineBuilder::appendNumber(uint16_t value, uint8_t width)
+{
+    char digits[LINE_BUILDER_MAX_DIGITS];
+    uint8_t numDigits = getDigits(value, digits);
+
+    for (uint8_t i = numDigits; i < width; i++)
+    {
+        append(' ');
+    }
+
+    for (uint8_t i = 0; i < numDigits; i++)
+    {
+        append(digits[i]);
+    }
+}
+
+/*
+* Append spaces up to a column of the line. Nothing is done if the cursor is already beyond it
+* column: column where the next field starts
+*/
+void LineBuilder::padTo(uint8_t column)
+{
+    while (_column < column)
+    {
+        append(' ');
+    }
+}
+
+/*
+* Return the column where the next char is written
+*/
+uint8_t LineBuilder::getColumn()
+{
+    return _column;
+}
+
+/*
+* Pad the line with spaces up to its width and terminate it. Returns the line, ready to be printed
+*/
+char *LineBuilder::finish()
+{
+    padTo(_width);
+    _line[_column] = '\0';
+
+    return _line;
+}
+
+/*
+* Write the decimal digits of a number, without leading zeros, by subtracting powers of ten: at most nine
+* subtractions per digit instead of a division and a modulo, which the ATmega has to do in software.
+* Returns the number of digits written
+* value: the number
+* digits: buffer where the digits are written, with room for LINE_BUILDER_MAX_DIGITS chars
+*/
+uint8_t LineBuilder::getDigits(uint16_t value, char *digits)
+{
+    uint8_t numDigits = 0;
+
+    for (uint8_t i = 0; i < LINE_BUILDER_MAX_DIGITS - 1; i++)
+    {
+        uint16_t power = pgm_read_word(&powersOfTen[i]);
+        char digit = '0';
+
+        while (value >= power)
+        {
+            value -= power;
+            digit++;
+        }
+
+        // skip the leading zeros
+        if (numDigits > 0 || digit != '0')
+        {
+            digits[numDigits++] = digit;
+        }
+    }
+
+    // the units digit is always written, so zero is displayed as '0'
+    digits[numDigits++] = '0' + value;
+
+    return numDigits;
+}
@@ -0,0 +1,53 @@
+/*
+ * LineBuilder.h
+ *
+ * Class that builds a line of the screen into a char buffer. It keeps a cursor with the column where the next field is
+ * written, so the fields are appended and the line is padded without scanning it. Numbers can be written as fixed-width
+ * right aligned fields, and their digits are emitted without divisions.
+ *
+ * Copyright 2018 3K MEDIALAB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LineBuilder_h
+#define LineBuilder_h
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+#define LINE_BUILDER_MAX_DIGITS 5 // digits of the largest 16 bit number
+
+class LineBuilder
+{
+public:
+  LineBuilder(char *line, uint8_t width);
+
+  void clear();
+  void append(char c);
+  void appendText(const __FlashStringHelper *text);
+  void appendText(const char *text);
+  void appendNumber(int16_t value);
+  void appendNumber(uint16_t value, uint8_t width);
+  void padTo(uint8_t column);
+  uint8_t getColumn();
+  char *finish();
+
+private:
+  char *_line;     // buffer of the line, with room for the width plus the string terminator
+  uint8_t _width;  // number of columns of the line
+  uint8_t _column; // column where the next char is written
+
+  uint8_t getDigits(uint16_t value, char *digits);
+};
+#endif
@@ -23,6 +23,136 @@
 
 #include "MIDIController.h"
 
+// transition of each state on each event, in the same order as the events and the states
+const MIDIController::Transition MIDIController::transitions[EVENTS][STATES] PROGMEM = {
+    // SELECT_VALUE_EVENT
+    {{&MIDIController::selectTempo, CONTROLLER},
+     {&MIDIController::selectTempo, SEQUENCER},
+     {&MIDIController::selectParameterValue, EDIT_PAGE},
+     {&MIDIController::selectParameterValue, EDIT_GLOBAL_CONFIG},
+     {&MIDIController::selectParameterValue, SEQUENCER_EDIT_STEP},
+     {&MIDIController::selectParameterValue, SEQUENCER_EDIT_CONFIG},
+     {&MIDIController::selectParameterValue, ARPEGGIATOR}},
+
+    // MULTIPLE_PURPOSE_PRESSED_EVENT
+    {{&MIDIController::updateMIDIClockState, CONTROLLER},
+     {&MIDIController::switchScaleLock, SEQUENCER},
+     {&MIDIController::moveCursorToNextParameter, EDIT_PAGE},
+     {&MIDIController::moveCursorToNextParameter, EDIT_GLOBAL_CONFIG},
+     {&MIDIController::moveCursorToNextParameter, SEQUENCER_EDIT_STEP},
+     {&MIDIController::moveCursorToNextParameter, SEQUENCER_EDIT_CONFIG},
+     {&MIDIController::moveCursorToNextParameter, ARPEGGIATOR}},
+
+    // MULTIPLE_PURPOSE_RELEASED_EVENT
+    {{NULL, CONTROLLER},
+     {&MIDIController::releaseMultiplePurposeButton, SEQUENCER},
+     {NULL, EDIT_PAGE},
+     {NULL, EDIT_GLOBAL_CONFIG},
+     {NULL, SEQUENCER_EDIT_STEP},
+     {NULL, SEQUENCER_EDIT_CONFIG},
+     {NULL, ARPEGGIATOR}},
+
+    // MULTIPLE_PURPOSE_HELD_EVENT
+    {{NULL, CONTROLLER},
+     {&MIDIController::switchRecording, SEQUENCER},
+     {NULL, EDIT_PAGE},
+     {NULL, EDIT_GLOBAL_CONFIG},
+     {NULL, SEQUENCER_EDIT_STEP},
+     {NULL, SEQUENCER_EDIT_CONFIG},
+     {NULL, ARPEGGIATOR}},
+
+    // DEC_PAGE_PRESSED_EVENT
+    {{&MIDIController::loadPreviousPage, CONTROLLER},
+     {&MIDIController::loadPreviousSequence, SEQUENCER},
+     {&MIDIController::displayPreviousMIDIMessage, EDIT_PAGE},
+     {NULL, EDIT_GLOBAL_CONFIG},
+     {&MIDIController::displayPreviousStep, SEQUENCER_EDIT_STEP},
+     {NULL, SEQUENCER_EDIT_CONFIG},
+     {NULL, ARPEGGIATOR}},
+
+    // INC_PAGE_PRESSED_EVENT
+    {{&MIDIController::loadNextPage, CONTROLLER},
+     {&MIDIController::loadNextSequence, SEQUENCER},
+     {&MIDIController::displayNextMIDIMessage, EDIT_PAGE},
+     {NULL, EDIT_GLOBAL_CONFIG},
+     {&MIDIController::displayNextStep, SEQUENCER_EDIT_STEP},
+     {NULL, SEQUENCER_EDIT_CONFIG},
+     {NULL, ARPEGGIATOR}},
+
+    // EDIT_RELEASED_EVENT
+    {{&MIDIController::enterEditPage, EDIT_PAGE},
+     {&MIDIController::enterEditStep, SEQUENCER_EDIT_STEP},
+     {&MIDIController::exitToController, CONTROLLER},
+     {&MIDIController::exitGlobalConfig, CONTROLLER},
+     {&MIDIController::exitToSequencer, SEQUENCER},
+     {&MIDIController::exitSequencerConfig, SEQUENCER},
+     {NULL, ARPEGGIATOR}},
+
+    // EDIT_RELEASED_AFTER_SAVE_EVENT
+    {{&MIDIController::acknowledgeControllerSave, CONTROLLER},
+     {&MIDIController::acknowledgeSequencerSave, SEQUENCER},
+     {&MIDIController::switchMIDILedOff, EDIT_PAGE},
+     {&MIDIController::switchMIDILedOff, EDIT_GLOBAL_CONFIG},
+     {&MIDIController::switchMIDILedOff, SEQUENCER_EDIT_STEP},
+     {&MIDIController::switchMIDILedOff, SEQUENCER_EDIT_CONFIG},
+     {&MIDIController::switchMIDILedOff, ARPEGGIATOR}},
+
+    // EDIT_HELD_EVENT
+    {{&MIDIController::enterGlobalConfig, EDIT_GLOBAL_CONFIG},
+     {&MIDIController::enterSequencerConfig, SEQUENCER_EDIT_CONFIG},
+     {&MIDIController::saveCurrentPage, CONTROLLER},
+     {&MIDIController::saveGlobalConfig, CONTROLLER},
+     {&MIDIController::saveCurrentSequence, SEQUENCER},
+     {&MIDIController::saveSequencerConfig, SEQUENCER},
+     {NULL, ARPEGGIATOR}},
+
+    // OPERATION_MODE_PRESSED_EVENT
+    {{&MIDIController::enterSequencer, SEQUENCER},
+     {&MIDIController::selectNextTrack, ARPEGGIATOR},
+     {NULL, EDIT_PAGE},
+     {NULL, EDIT_GLOBAL_CONFIG},
+     {NULL, SEQUENCER_EDIT_STEP},
+     {NULL, SEQUENCER_EDIT_CONFIG},
+     {&MIDIController::exitArpeggiator, CONTROLLER}}};
+
+// value selection and cursor move of each substate, in the same order as the substates
+const MIDIController::ParameterTransition MIDIController::parameterTransitions[SUBSTATES] PROGMEM = {
+    {NULL, MIDI_CLOCK_ON, NULL},
+    {NULL, MIDI_CLOCK_OFF, NULL},
+    {&MIDIController::selectGlobalMode, EDIT_GLOBAL_ROOT_NOTE, &MIDIController::moveCursorToRootNote},
+    {&MIDIController::selectGlobalRootNote, EDIT_GLOBAL_MIDI_CH, &MIDIController::moveCursorToMIDIChannel},
+    {&MIDIController::selectGlobalMIDIChannel, EDIT_GLOBAL_MODE, &MIDIController::moveCursorToMode},
+    {NULL, DEFAULT_EDIT_MSG, NULL},
+    {&MIDIController::selectMIDIType, EDIT_MIDI_TYPE, &MIDIController::moveCursorToMIDIData},
+    {&MIDIController::selectNote, EDIT_VELOCITY, &MIDIController::moveCursorToVelocity},
+    {&MIDIController::selectVelocity, EDIT_MIDI_TYPE, &MIDIController::moveCursorToMsgType},
+    {&MIDIController::selectCC, EDIT_MIDI_TYPE, &MIDIController::moveCursorToMsgType},
+    {&MIDIController::selectParameterMSB, EDIT_PARAM_LSB, &MIDIController::moveCursorToParameterLSB},
+    {&MIDIController::selectParameterLSB, EDIT_MIDI_TYPE, &MIDIController::moveCursorToMsgType},
+    {NULL, PLAYBACK_ON, NULL},
+    {NULL, PLAYBACK_OFF, NULL},
+    {&MIDIController::selectStepNote, SEQUENCER_EDIT_STEP_LEGATO, &MIDIController::moveCursorToStepLegato},
+    {&MIDIController::selectStepLegato, SEQUENCER_EDIT_STEP_ENABLED, &MIDIController::moveCursorToStepEnabled},
+    {&MIDIController::selectStepEnabled, SEQUENCER_EDIT_STEP_LENGTH, &MIDIController::moveCursorToStepLength},
+    {&MIDIController::selectSequenceLength, SEQUENCER_EDIT_STEP_VELOCITY, &MIDIController::moveCursorToStepVelocity},
+    {&MIDIController::selectStepVelocity, SEQUENCER_EDIT_STEP_PROBABILITY, &MIDIController::moveCursorToStepProbability},
+    {&MIDIController::selectStepProbability, SEQUENCER_EDIT_STEP_RATCHETS, &MIDIController::moveCursorToStepRatchets},
+    {&MIDIController::selectStepRatchets, SEQUENCER_EDIT_STEP_NOTE, &MIDIController::moveCursorToStepNote},
+    {&MIDIController::selectPlayBackMode, SEQUENCER_EDIT_SEND_CLOCK_WHILE_PLAYBACK, &MIDIController::moveCursorToSendClockWhilePlayback},
+    {&MIDIController::selectSendClockWhilePlayback, SEQUENCER_EDIT_STEP_SIZE, &MIDIController::moveCursorToStepSize},
+    {&MIDIController::selectStepSize, SEQUENCER_EDIT_MIDI_CH, &MIDIController::moveCursorToSequencerMIDIChannel},
+    {&MIDIController::selectSequencerMIDIChannel, SEQUENCER_EDIT_EUCLIDEAN_HITS, &MIDIController::moveCursorToEuclideanHits},
+    {&MIDIController::selectEuclideanHits, SEQUENCER_EDIT_EUCLIDEAN_STEPS, &MIDIController::moveCursorToEuclideanSteps},
+    {&MIDIController::selectEuclideanSteps, SEQUENCER_EDIT_EUCLIDEAN_ROTATION, &MIDIController::moveCursorToEuclideanRotation},
+    {&MIDIController::selectEuclideanRotation, SEQUENCER_EDIT_PLAYBACK_MODE, &MIDIController::printSequencerConfig},
+    {&MIDIController::selectArpeggiatorMode, ARPEGGIATOR_EDIT_OCTAVES, &MIDIController::moveCursorToArpeggiatorOctaves},
+    {&MIDIController::selectArpeggiatorOctaves, ARPEGGIATOR_EDIT_RATE, &MIDIController::moveCursorToArpeggiatorRate},
+    {&MIDIController::selectArpeggiatorRate, ARPEGGIATOR_EDIT_MODE, &MIDIController::moveCursorToArpeggiatorMode}};
+
+// substate each state starts on. The controller and sequencer default states start on the MIDI clock or playback status
+const uint8_t MIDIController::entrySubStates[STATES] PROGMEM = {MIDI_CLOCK_OFF, PLAYBACK_OFF, DEFAULT_EDIT_MSG, EDIT_GLOBAL_MODE,
+                                                                SEQUENCER_EDIT_STEP_NOTE, SEQUENCER_EDIT_PLAYBACK_MODE, ARPEGGIATOR_EDIT_MODE};
+
 /*
 * Constructor
 * midiWorker: the MIDI interface that the controller will use.
@@ -66,11 +196,18 @@ void MIDIController::begin()
     _memoryManager.loadMIDIComponents(_currentPage, _midiComponents, _numMIDIComponents);
     _wasPageSaved = 0;
 
-    // load from EEPROM the default sequence into the sequencer
+    // the sequencer scale lock uses the scale of the global configuration
+    _sequencer.setScale(_globalConfig.getRootNote(), _globalConfig.getMode());
+
+    // load from EEPROM the song chain and the default sequence into the sequencer
+    _sequencer.loadChain();
     _sequencer.setCurrentSequence(1);
     _sequencer.loadCurrentSequence();
     _sequencer.setMidiWorker(_midiWorker);
     _wasSequenceSaved = 0;
+    _wasShortcutPressed = 0;
+    _wasTransposeEdited = 0;
+    _transposingButtons = 0;
     _accesToSequencerEdit = 0;
 
     // set the default tempo
@@ -96,112 +233,19 @@ void MIDIController::begin()
 */
 void MIDIController::processIncDecButtons()
 {
-    /**************************** DECREASE BUTTON **********************/
     _decPageButton.read();
 
     if (_decPageButton.wasPressed())
     {
-        switch (_state)
-        {
-        // load the previous page from memory
-        case CONTROLLER:
-
-            if (_currentPage > 1)
-            {
-                _currentPage -= 1;
-                loadPage(_currentPage);
-                _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
-            }
-
-            break;
-
-        // display the previous MIDI message of the component loaded into the Screen Manager
-        case EDIT_PAGE:
-
-            if (_subState != DEFAULT_EDIT_MSG && _screenManager.getDisplayedMessageIndex() > 1)
-            {
-                _screenManager.displayPreviousMIDIMsg();
-                _subState = EDIT_MIDI_TYPE;
-            }
-
-            break;
-
-        // load the previous sequence from memory
-        case SEQUENCER:
-
-            if (_sequencer.getCurrentSequence() > 1)
-            {
-                _sequencer.setCurrentSequence(_sequencer.getCurrentSequence() - 1);
-                _sequencer.loadCurrentSequence();
-                _sequencer.printDefault(_syncManager);
-            }
-
-            break;
-
-        // display the previous step in the sequence
-        case SEQUENCER_EDIT_STEP:
-
-            _subState = SEQUENCER_EDIT_STEP_NOTE;
-            _sequencer.printPreviousStep();
-
-            break;
-        }
+        processEvent(DEC_PAGE_PRESSED_EVENT);
     }
-    /**************************** END DECREASE BUTTON **********************/
 
-    /**************************** INCREASE BUTTON **********************/
     _incPageButton.read();
 
     if (_incPageButton.wasPressed())
     {
-        switch (_state)
-        {
-        // load the next page from memory
-        case CONTROLLER:
-
-            if (_currentPage < NUM_PAGES)
-            {
-                _currentPage += 1;
-                loadPage(_currentPage);
-                _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
-            }
-
-            break;
-
-        // display the next MIDI message of the component loaded into the Screen Manager
-        case EDIT_PAGE:
-
-            if (_subState != DEFAULT_EDIT_MSG && (_screenManager.getDisplayedMessageIndex() < _screenManager.getDisplayedMIDIComponent()->getNumMessages()))
-            {
-                _screenManager.displayNextMIDIMsg();
-                _subState = EDIT_MIDI_TYPE;
-            }
-
-            break;
-
-        // load the next sequence from memory
-        case SEQUENCER:
-
-            if (_sequencer.getCurrentSequence() < NUM_SEQUENCES)
-            {
-                _sequencer.setCurrentSequence(_sequencer.getCurrentSequence() + 1);
-                _sequencer.loadCurrentSequence();
-                _sequencer.printDefault(_syncManager);
-            }
-
-            break;
-
-        // display the next step in the sequence
-        case SEQUENCER_EDIT_STEP:
-
-            _subState = SEQUENCER_EDIT_STEP_NOTE;
-            _sequencer.printNextStep();
-
-            break;
-        }
+        processEvent(INC_PAGE_PRESSED_EVENT);
     }
-
-    /**************************** INCREASE BUTTON **********************/
 }
 
 /* 
@@ -211,15 +255,16 @@ void MIDIController::processMIDIComponents()
 {
     for (int i = 0; i < _numMIDIComponents; i++)
     {
-        processMidiComponent(_midiComponents[i]);
+        processMidiComponent(_midiComponents[i], i);
     }
 }
 
 /* 
 * Process a MIDI component in order to send the corresponding MIDI Message regarding the component event triggered
 * component: the MIDI component to process.
+* index: position of the component into the MIDI components array. The MIDI potentiometers follow the MIDI buttons
 */
-void MIDIController::processMidiComponent(IMIDIComponent *component)
+void MIDIController::processMidiComponent(IMIDIComponent *component, uint8_t index)
 {
     // edit mode is off: send MIDI message
     switch (_state)
@@ -232,7 +277,64 @@ void MIDIController::processMidiComponent(IMIDIComponent *component)
 
         if (message != NULL)
         {
-            if (message->getType() != midi::InvalidType)
+            // while the edit mode button is held, a note transposes the sequencer regarding the reference note instead of being sent
+            if (_state == SEQUENCER && _editButton.isPressed() && message->getType() == midi::NoteOn)
+            {
+                _sequencer.setTranspose(message->getDataByte1() - TRANSPOSE_REFERENCE_NOTE);
+                _wasTransposeEdited = 1;
+                bitSet(_transposingButtons, index);
+
+                _screenManager.printTranspose(_sequencer.getTranspose(), _sequencer.isScaleLockOn());
+            }
+
+            // the note off of a button whose note on transposed the sequencer is not sent, even if the edit mode button was released
+            else if (message->getType() == midi::NoteOff && bitRead(_transposingButtons, index))
+            {
+                bitClear(_transposingButtons, index);
+            }
+
+            else if (message->getType() != midi::InvalidType)
+            {
+                _midiLed.setState(HIGH);
+                delay(5);
+                _midiWorker->sendMIDIMessage(message, _globalConfig.getMIDIChannel());
+                _midiLed.setState(LOW);
+
+                // the notes played over the sequencer playback are recorded into the selected track
+                if (_state == SEQUENCER && message->getType() == midi::NoteOn && message->getDataByte2() > 0)
+                {
+                    _sequencer.recordNote(message->getDataByte1(), message->getDataByte2());
+                }
+
+                // the meter view displays the CC values sent by the MIDI potentiometers
+                if (_state == CONTROLLER && message->getType() == midi::ControlChange && index >= NUM_MIDI_BUTTONS)
+                {
+                    _screenManager.refreshMeter(index - NUM_MIDI_BUTTONS, message->getDataByte2());
+                }
+            }
+        }
+
+        break;
+    }
+
+    // the notes are held by the arpeggiator instead of being sent. Other MIDI messages are sent as usual
+    case ARPEGGIATOR:
+    {
+        MIDIMessage *message = component->getMessageToSend();
+
+        if (message != NULL)
+        {
+            if (message->getType() == midi::NoteOn)
+            {
+                _arpeggiator.addNote(message->getDataByte1());
+            }
+
+            else if (message->getType() == midi::NoteOff)
+            {
+                _arpeggiator.removeNote(message->getDataByte1());
+            }
+
+            else if (message->getType() != midi::InvalidType)
             {
                 _midiLed.setState(HIGH);
                 delay(5);
@@ -307,288 +409,14 @@ void MIDIController::processSelectValuePot()
 {
     if (_selectValuePot.wasChanged())
     {
-        switch (_state)
-        {
-        // set controller's tempo and calculate delays for led blinking, MIDI clock signal sending and step sequence playing
-        case CONTROLLER:
-        case SEQUENCER:
-        {
-            // set the new bpm value into the sync manager
-            _syncManager.setBpm(map(_selectValuePot.getSmoothValue(), 0, 1022, MIN_BPM, MAX_BPM));
-
-            // update screen regarding the state
-            if (_state == CONTROLLER)
-            {
-                _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
-            }
-
-            if (_state == SEQUENCER)
-            {
-                _sequencer.printDefault(_syncManager);
-            }
-
-            break;
-        }
-
-        // select a value for a midi message part
-        case EDIT_PAGE:
-        {
-            // get the component displayed on screen currently
-            IMIDIComponent *displayedComponent = _screenManager.getDisplayedMIDIComponent();
-            uint8_t displayedMessageIndex = (_screenManager.getDisplayedMessageIndex()) - 1;
-
-            switch (_subState)
-            {
-            case EDIT_MIDI_TYPE:
-            {
-                // get the current MIDI message type
-                MIDIMessage oldMessage = displayedComponent->getMessages()[displayedMessageIndex];
-
-                // set the new MIDI message type into the component and refresh the screen
-                uint8_t *availableMIDIMessages = displayedComponent->getAvailableMessageTypes();
-                uint8_t numAvailableMsgTypes = displayedComponent->getNumAvailableMessageTypes();
-
-                displayedComponent->getMessages()[displayedMessageIndex].setType(availableMIDIMessages[map(_selectValuePot.getSmoothValue(), 0, 1022, 0, numAvailableMsgTypes - 1)]);
-
-                if (oldMessage.getType() != displayedComponent->getMessages()[displayedMessageIndex].getType())
-                {
-                    _screenManager.refreshMIDIData();
-                }
-                break;
-            }
-
-            case EDIT_NOTE:
-            {
-                // set the new note value in to the component
-                uint8_t note = map(_selectValuePot.getSmoothValue(), 0, 1022, NOTE_C_1, NOTE_C7);
-
-                if (MIDIUtils::isNoteInScale(note, _globalConfig.getRootNote(), _globalConfig.getMode()))
-                {
-                    displayedComponent->getMessages()[displayedMessageIndex].setDataByte1(note);
-
-                    // print the new note value on the screen
-                    _screenManager.refreshNoteValue(note);
-                }
-
-                break;
-            }
-
-            case EDIT_VELOCITY:
-            {
-
-                //set the new velocity value into the component
-                uint8_t velocity = map(_selectValuePot.getSmoothValue(), 0, 1022, 1, 127);
-                displayedComponent->getMessages()[displayedMessageIndex].setDataByte2(velocity);
-
-                // print the new velocity value on the screen
-                _screenManager.refreshVelocityValue(velocity);
-
-                break;
-            }
-
-            case EDIT_CC:
-            {
-                //set the new control change type value into the component
-                uint8_t ccValue = map(_selectValuePot.getSmoothValue(), 0, 1022, 0, 127);
-                displayedComponent->getMessages()[displayedMessageIndex].setDataByte1(ccValue);
-
-                // print the new cc value on the screen
-                _screenManager.refreshCCValue(ccValue);
-
-                break;
-            }
-            }
-
-            break;
-        }
-
-        // select a value for a Global Configuration Parameter
-        case EDIT_GLOBAL_CONFIG:
-
-            switch (_subState)
-            {
-            // select the musical mode value
-            case EDIT_GLOBAL_MODE:
-            {
-                // get the current mode
-                uint8_t currentMode = _globalConfig.getMode();
-
-                _globalConfig.setMode(map(_selectValuePot.getSmoothValue(), 0, 1022, MIDIUtils::Ionian, MIDIUtils::Chromatic));
-
-                if (currentMode != _globalConfig.getMode())
-                {
-                    _screenManager.refreshModeData(_globalConfig.getMode());
-                }
-
-                break;
-            }
-
-            // select the root note value
-            case EDIT_GLOBAL_ROOT_NOTE:
-            {
-                // get the current root note
-                uint8_t currentRootNote = _globalConfig.getRootNote();
-
-                _globalConfig.setRootNote(map(_selectValuePot.getSmoothValue(), 0, 1022, MIDIUtils::C, MIDIUtils::B));
-
-                if (currentRootNote != _globalConfig.getRootNote())
-                {
-                    _screenManager.refreshRootNoteData(_globalConfig.getRootNote());
-                }
-
-                break;
-            }
-
-            // select the MIDI channel value
-            case EDIT_GLOBAL_MIDI_CH:
-            {
-                // get the current root note
-                uint8_t currentMIDIChannel = _globalConfig.getMIDIChannel();
-
-                _globalConfig.setMIDIChannel(map(_selectValuePot.getSmoothValue(), 0, 1022, MIDIUtils::CHANNEL1, MIDIUtils::CHANNEL16));
-
-                if (currentMIDIChannel != _globalConfig.getMIDIChannel())
-                {
-                    _screenManager.refreshMIDIChannelData(_globalConfig.getMIDIChannel());
-                }
-
-                break;
-            }
-            }
-
-            break;
-
-        // select a value for a step sequencer parameter
-        case SEQUENCER_EDIT_STEP:
-
-            switch (_subState)
-            {
-            // update the note assigned to the current edited step
-            case SEQUENCER_EDIT_STEP_NOTE:
-            {
-                uint8_t note = map(_selectValuePot.getSmoothValue(), 0, 1022, NOTE_C_1, NOTE_C7);
-
-                if (MIDIUtils::isNoteInScale(note, _globalConfig.getRootNote(), _globalConfig.getMode()))
-                {
-                    _sequencer.setDisplayedStepNote(note);
-                }
-
-                break;
-            }
-
-            // update legato value assigned to the current edited step
-            case SEQUENCER_EDIT_STEP_LEGATO:
-            {
-                uint8_t legatoValue = map(_selectValuePot.getSmoothValue(), 0, 1022, 0, 1);
-                _sequencer.setDisplayedStepLegato(legatoValue);
-
-                break;
-            }
-
-            // update enabled value assigned to the current edited step
-            case SEQUENCER_EDIT_STEP_ENABLED:
-            {
-                uint8_t enabledValue = map(_selectValuePot.getSmoothValue(), 0, 1022, 0, 1);
-                _sequencer.setDisplayedStepEnabled(enabledValue);
-
-                break;
-            }
-            }
-
-            break;
-
-        // select a value for a Sequencer Configuration Parameter
-        case SEQUENCER_EDIT_CONFIG:
-
-            switch (_subState)
-            {
-            // select the sequencer playback mode
-            case SEQUENCER_EDIT_PLAYBACK_MODE:
-            {
-                // get the current playback mode
-                uint8_t currentMode = _sequencer.getPlayBackMode();
-
-                _sequencer.setPlayBackMode(map(_selectValuePot.getSmoothValue(), 0, 1022, 0, _sequencer.getPlayBackModeTypesNumber() - 1));
-
-                if (currentMode != _sequencer.getPlayBackMode())
-                {
-                    if (_sequencer.isPlayBackOn())
-                    {
-                        _sequencer.stopNote();
-                    }
-
-                    _sequencer.refreshDisplayedPlayBackMode(_sequencer.getPlayBackMode());
-                }
-
-                break;
-            }
-            // activate/deactivate send clock in sync with sequencer playback
-            case SEQUENCER_EDIT_SEND_CLOCK_WHILE_PLAYBACK:
-            {
-                if (!_sequencer.isPlayBackOn())
-                {
-
-                    uint8_t currentSendClockWhilePlayBack = _globalConfig.getSendClockWhilePlayback();
-                    _globalConfig.setSendClockWhilePlayback(map(_selectValuePot.getSmoothValue(), 0, 1022, 0, 1));
-
-                    if (currentSendClockWhilePlayBack != _globalConfig.getSendClockWhilePlayback())
-                    {
-                        _sequencer.refreshDisplayedSendClockWhilePlayback(_globalConfig.getSendClockWhilePlayback());
-                    }
-                }
-
-                break;
-            }
-
-            // select the sequencer step size
-            case SEQUENCER_EDIT_STEP_SIZE:
-            {
-                //sequencer step size cannot be changed while playback is on
-                if (!_sequencer.isPlayBackOn())
-                {
-                    uint8_t currentStepSize = _sequencer.getStepSize();
-
-                    // set the new value of the step size if valid
-                    uint8_t newStepSize = map(_selectValuePot.getSmoothValue(), 0, 1022, Sequencer::QUARTER, Sequencer::THIRTYSECOND);
-
-                    if (_sequencer.isStepSizeValueValid(newStepSize))
-                    {
-                        _sequencer.setStepSize(newStepSize);
-
-                        if (currentStepSize != _sequencer.getStepSize())
-                        {
-                            _sequencer.refreshDisplayedStepSizeValue(_sequencer.getStepSize());
-                        }
-                    }
-                }
-
-                break;
-            }
-
-            // select the sequencer MIDI channel value
-            case SEQUENCER_EDIT_MIDI_CH:
-            {
-                uint8_t currentSeqMIDIChannel = _globalConfig.getSequencerMIDIChannel();
-
-                _globalConfig.setSequencerMIDIChannel(map(_selectValuePot.getSmoothValue(), 0, 1022, MIDIUtils::CHANNEL1, MIDIUtils::CHANNEL16));
-
-                if (currentSeqMIDIChannel != _globalConfig.getSequencerMIDIChannel())
-                {
-                    _sequencer.refreshDisplayedMIDIChannel(_globalConfig.getSequencerMIDIChannel());
-                }
-
-                break;
-            }
-            }
-
-            break;
-        }
+        processEvent(SELECT_VALUE_EVENT);
     }
 }
 
 /*
 * Process the button that controls MIDI clock when CONTROLLER mode is on, or move the cursor through the screen
-* when EDIT mode is on, or star / stop sequencer playbak
+* when EDIT mode is on, or star / stop sequencer playbak. On long presses switches sequencer recording on/off,
+* and while the edit mode button is held switches the sequencer scale lock on/off
 */
 void MIDIController::processMultiplePurposeButton()
 {
@@ -596,40 +424,25 @@ void MIDIController::processMultiplePurposeButton()
 
     if (_multiplePurposeButton.wasPressed())
     {
-        switch (_state)
-        {
-        // activate/deactivate MIDI clock signal sending
-        case CONTROLLER:
-            updateMIDIClockState();
-            break;
-
-        case EDIT_PAGE:
-            moveCursorToValue();
-            break;
-
-        case EDIT_GLOBAL_CONFIG:
-            moveCursorToGLobalConfigParameter();
-            break;
-
-        case SEQUENCER:
-            updateSequencerPlayBackStatus();
-            break;
+        processEvent(MULTIPLE_PURPOSE_PRESSED_EVENT);
+    }
 
-        case SEQUENCER_EDIT_STEP:
-            moveCursorToStepValue();
-            break;
+    if (_multiplePurposeButton.wasReleased())
+    {
+        processEvent(MULTIPLE_PURPOSE_RELEASED_EVENT);
+    }
 
-        case SEQUENCER_EDIT_CONFIG:
-            moveCursorToSequencerConfigParameter();
-            break;
-        }
+    if (_multiplePurposeButton.pressedFor(PRESSED_FOR_WAIT))
+    {
+        processEvent(MULTIPLE_PURPOSE_HELD_EVENT);
     }
 }
 
 /*
 * Control the MIDI clock sending status
+* Return: 1 if the MIDI clock is switched on/off, 0 if the sequencer playback is on
 */
-void MIDIController::updateMIDIClockState()
+uint8_t MIDIController::updateMIDIClockState()
 {
     // if sequencer playback is on, MIDI clock cannot be activated/deactivated
     if (!_sequencer.isPlayBackOn())
@@ -652,7 +465,11 @@ void MIDIController::updateMIDIClockState()
         }
 
         _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
+
+        return 1;
     }
+
+    return 0;
 }
 
 /*
@@ -699,532 +516,1251 @@ void MIDIController::updateSequencerPlayBackStatus()
 }
 
 /*
-* Move the cursor to the different MIDI parameters while controller is on EDIT mode
+* Display the arpeggiator parameters and place the cursor on the one being edited
 */
-void MIDIController::moveCursorToValue()
+void MIDIController::printArpeggiator()
 {
-    // get the current MIDI message type displayed on the screen, set the next subState and move the cursor to the next value to edit
-    switch (_screenManager.getDisplayedMessageType())
-    {
-    case midi::ControlChange:
-
-        switch (_subState)
-        {
-        case EDIT_MIDI_TYPE:
-
-            _subState = EDIT_CC;
-            _screenManager.moveCursorToCC();
-
-            break;
-
-        case EDIT_CC:
+    _screenManager.printArpeggiator(_arpeggiator.getModeName(), _arpeggiator.getOctaves(), _arpeggiator.getRate());
 
-            _subState = EDIT_MIDI_TYPE;
-            _screenManager.moveCursorToMsgType();
-
-            break;
-        }
+    switch (_subState)
+    {
+    case ARPEGGIATOR_EDIT_MODE:
+        _screenManager.moveCursorToArpeggiatorMode();
+        break;
 
+    case ARPEGGIATOR_EDIT_OCTAVES:
+        _screenManager.moveCursorToArpeggiatorOctaves();
         break;
 
-    case midi::ProgramChange:
+    case ARPEGGIATOR_EDIT_RATE:
+        _screenManager.moveCursorToArpeggiatorRate();
+        break;
+    }
+}
 
-        switch (_subState)
-        {
-            _subState = EDIT_MIDI_TYPE;
-            _screenManager.moveCursorToMsgType();
-        }
-
-        break;
+/*
+* Send a MIDI clock tick. This method is called from the interrupt method set to the timer1 interrupt
+*/
+void MIDIController::sendMIDIClock()
+{
+    // send MIDI clock signal regarding the tempo
+    if (_isMIDIClockOn)
+    {
+        _midiWorker->sendMIDIClock();
+    }
+}
 
-    case midi::NoteOn:
-    case midi::NoteOff:
+/*
+* Playback the sequencer tracks on every MIDI clock tick. This method is called from the interrupt method set to the timer1 interrupt
+*/
+void MIDIController::playBackSequence()
+{
+    // play the tracks whose next step starts on this tick if sequencer playback is on
+    _sequencer.tick();
+}
 
-        switch (_subState)
-        {
-        case EDIT_MIDI_TYPE:
+/*
+* Play the arpeggio of the held notes on every MIDI clock tick. This method is called from the interrupt method set to the timer1 interrupt
+*/
+void MIDIController::playArpeggio()
+{
+    _arpeggiator.tick(_midiWorker);
+}
 
-            _subState = EDIT_NOTE;
-            _screenManager.moveCursorToNote();
+/*
+* Draw the screen fields changed since the last screen refresh, if it is time to refresh the screen.
+* It is the last task of the loop, so it also ends the scheduling of the I2C bus transactions of the loop
+*/
+void MIDIController::refreshScreen()
+{
+    _screenManager.refresh();
 
-            break;
+    I2CBus.endPass();
+}
 
-        case EDIT_NOTE:
+/*
+* Prepare the MIDI messages of the next step so the timer1 interrupt only has to send them
+*/
+void MIDIController::renderNextStep()
+{
+    _sequencer.renderNextStep();
 
-            _subState = EDIT_VELOCITY;
-            _screenManager.moveCursorToVelocity();
+    // the song position is refreshed when the song moves to another entry
+    if (_sequencer.wasSongPositionChanged() && _state == SEQUENCER)
+    {
+        _sequencer.printDefault(_syncManager);
+    }
 
-            break;
+    // the step grid follows the steps played by the selected track
+    if (_state == SEQUENCER)
+    {
+        _sequencer.updateDisplayedPlaybackStep();
+    }
+}
 
-        case EDIT_VELOCITY:
+/*
+* Update led bpm status
+*/
+void MIDIController::updateBpmIndicatorStatus()
+{
+    if (_isMIDIClockOn || _sequencer.isPlayBackOn())
+    {
+        _midiLed.setState(!_midiLed.getState());
+    }
 
-            _subState = EDIT_MIDI_TYPE;
-            _screenManager.moveCursorToMsgType();
+    else
+    {
+        _midiLed.setState(LOW);
+    }
+}
 
-            break;
-        }
-        break;
+/*
+* Process the button that set the mode operation: MIDI Controller or Sequencer
+*/
+void MIDIController::processOperationModeButton()
+{
+    _operationModeButton.read();
 
-    case midi::InvalidType:
-        break;
+    if (_operationModeButton.wasPressed())
+    {
+        processEvent(OPERATION_MODE_PRESSED_EVENT);
     }
 }
 
 /*
-* Move the cursor to the different parameters on EDIT_GLOBAL_CONFIG mode
+* Process the button that activates/deactivates the edit mode.
 */
-void MIDIController::moveCursorToGLobalConfigParameter()
+void MIDIController::processEditModeButton()
 {
-    switch (_subState)
+    _editButton.read();
+
+    // the release that follows saving a page, a sequence or the global configuration, or changing the sequencer transposition, only acknowledges it
+    if (_editButton.wasReleased())
+    {
+        processEvent((_wasPageSaved || _wasGlobalConfigSaved || _wasSequenceSaved || _wasTransposeEdited) ? EDIT_RELEASED_AFTER_SAVE_EVENT : EDIT_RELEASED_EVENT);
+    }
+
+    // save current page component's configuration / steps within a sequence / global configuration and exits edit mode
+    if (_editButton.pressedFor(PRESSED_FOR_WAIT))
     {
-    case EDIT_GLOBAL_MODE:
+        processEvent(EDIT_HELD_EVENT);
+    }
+}
 
-        _subState = EDIT_GLOBAL_ROOT_NOTE;
-        _screenManager.moveCursorToRootNote();
+/*
+* Run the transition of the current state on an event. The transition is read from the transitions table in constant
+* time: its action is done and, if the action does not keep the controller on its state, the next state is entered
+* event: the event of the buttons or the select value potentiometer
+*/
+void MIDIController::processEvent(uint8_t event)
+{
+    Transition transition;
 
-        break;
+    memcpy_P(&transition, &transitions[event][_state], sizeof(Transition));
 
-    case EDIT_GLOBAL_ROOT_NOTE:
+    if (transition.action != NULL && (this->*transition.action)() && transition.nextState != _state)
+    {
+        enterState(transition.nextState);
+    }
+}
 
-        _subState = EDIT_GLOBAL_MIDI_CH;
-        _screenManager.moveCursorToMIDIChannel();
+/*
+* Move the controller to a state, starting on its first substate
+* state: the new state
+*/
+void MIDIController::enterState(uint8_t state)
+{
+    _state = state;
 
+    switch (state)
+    {
+    case CONTROLLER:
+        _subState = _isMIDIClockOn ? MIDI_CLOCK_ON : MIDI_CLOCK_OFF;
         break;
 
-    case EDIT_GLOBAL_MIDI_CH:
-
-        _subState = EDIT_GLOBAL_MODE;
-        _screenManager.moveCursorToMode();
+    case SEQUENCER:
+        _subState = _sequencer.isPlayBackOn() ? PLAYBACK_ON : PLAYBACK_OFF;
+        break;
 
+    default:
+        _subState = pgm_read_byte(&entrySubStates[state]);
         break;
     }
 }
 
 /*
-* Moves the cursor to the different step parameters in step edit screen
+* Set controller's tempo regarding the select value potentiometer
+* Return: 1
 */
-void MIDIController::moveCursorToStepValue()
+uint8_t MIDIController::selectTempo()
 {
-    switch (_subState)
-    {
+    // set the new bpm value into the sync manager
+    _syncManager.setBpm(map(_selectValuePot.getSmoothValue(), 0, 1022, MIN_BPM, MAX_BPM));
 
-    case SEQUENCER_EDIT_STEP_NOTE:
+    // only the tempo field of the default screen is refreshed, at the screen refresh rate
+    _screenManager.refreshTempo(_syncManager.getBpm());
 
-        _subState = SEQUENCER_EDIT_STEP_LEGATO;
-        _sequencer.moveCursorToLegato();
+    return 1;
+}
 
-        break;
+/*
+* Set the parameter under the cursor to the value of the select value potentiometer
+* Return: 1
+*/
+uint8_t MIDIController::selectParameterValue()
+{
+    ParameterAction selectValue;
 
-    case SEQUENCER_EDIT_STEP_LEGATO:
+    memcpy_P(&selectValue, &parameterTransitions[_subState].selectValue, sizeof(ParameterAction));
 
-        _subState = SEQUENCER_EDIT_STEP_ENABLED;
-        _sequencer.moveCursorToEnabled();
+    if (selectValue != NULL)
+    {
+        (this->*selectValue)();
+    }
 
-        break;
+    return 1;
+}
 
-    case SEQUENCER_EDIT_STEP_ENABLED:
+/*
+* Move the cursor to the next parameter of the edit screen
+* Return: 1
+*/
+uint8_t MIDIController::moveCursorToNextParameter()
+{
+    ParameterAction moveCursor;
 
-        _subState = SEQUENCER_EDIT_STEP_NOTE;
-        _sequencer.moveCursorToNote();
+    memcpy_P(&moveCursor, &parameterTransitions[_subState].moveCursor, sizeof(ParameterAction));
+    _subState = pgm_read_byte(&parameterTransitions[_subState].nextSubState);
 
-        break;
+    if (moveCursor != NULL)
+    {
+        (this->*moveCursor)();
     }
+
+    return 1;
 }
 
 /*
-* Moves the cursor to the different sequencer global configuration parameters in global configuration screen
+* Switch the sequencer scale lock on/off when the multiple purpose button is pressed while the edit mode button is held
+* Return: 1 if the scale lock is switched, 0 otherwise
 */
-void MIDIController::moveCursorToSequencerConfigParameter()
+uint8_t MIDIController::switchScaleLock()
 {
-    switch (_subState)
+    if (!_editButton.isPressed())
     {
-    case SEQUENCER_EDIT_PLAYBACK_MODE:
-
-        _subState = SEQUENCER_EDIT_SEND_CLOCK_WHILE_PLAYBACK;
-        _sequencer.moveCursorToSendClockWhilePlayback();
+        return 0;
+    }
 
-        break;
+    _sequencer.setScaleLock(!_sequencer.isScaleLockOn());
+    _wasShortcutPressed = 1;
+    _wasTransposeEdited = 1;
 
-    case SEQUENCER_EDIT_SEND_CLOCK_WHILE_PLAYBACK:
+    _screenManager.printTranspose(_sequencer.getTranspose(), _sequencer.isScaleLockOn());
 
-        _subState = SEQUENCER_EDIT_STEP_SIZE;
-        _sequencer.moveCursorToStepSize();
+    return 1;
+}
 
-        break;
+/*
+* Start/stop the sequencer playback when the multiple purpose button is released, so a long press only switches
+* recording on/off
+* Return: 1 if the playback status is updated, 0 if the press was a shortcut
+*/
+uint8_t MIDIController::releaseMultiplePurposeButton()
+{
+    if (_wasShortcutPressed)
+    {
+        _wasShortcutPressed = 0;
+        return 0;
+    }
 
-    case SEQUENCER_EDIT_STEP_SIZE:
+    updateSequencerPlayBackStatus();
 
-        _subState = SEQUENCER_EDIT_MIDI_CH;
-        _sequencer.moveCursorToMIDIChannel();
+    return 1;
+}
 
-        break;
+/*
+* Switch the sequencer recording on/off on a long press of the multiple purpose button
+* Return: 1 if recording is switched, 0 if the press has already been used as a shortcut
+*/
+uint8_t MIDIController::switchRecording()
+{
+    if (_wasShortcutPressed)
+    {
+        return 0;
+    }
 
-    case SEQUENCER_EDIT_MIDI_CH:
+    _sequencer.setRecording(!_sequencer.isRecording());
+    _wasShortcutPressed = 1;
 
-        _subState = SEQUENCER_EDIT_PLAYBACK_MODE;
-        _sequencer.moveCursorToPlayBackMode();
+    _sequencer.printDefault(_syncManager);
 
-        break;
-    }
+    return 1;
 }
 
 /*
-* Send a MIDI clock tick. This method is called from the interrupt method set to the timer1 interrupt
+* Load the previous page from memory
+* Return: 1 if the page is loaded, 0 if the first page is already loaded
 */
-void MIDIController::sendMIDIClock()
+uint8_t MIDIController::loadPreviousPage()
 {
-    // send MIDI clock signal regarding the tempo
-    if (_isMIDIClockOn)
+    if (_currentPage <= 1)
     {
-        _midiWorker->sendMIDIClock();
+        return 0;
     }
+
+    _currentPage -= 1;
+    _midiWorker->panic();
+    loadPage(_currentPage);
+    _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
+
+    return 1;
 }
 
 /*
-* Playback current sequence assigned to the sequencer. This method is called from the interrupt method set to the timer1 interrupt
+* Load the next page from memory
+* Return: 1 if the page is loaded, 0 if the last page is already loaded
 */
-void MIDIController::playBackSequence()
+uint8_t MIDIController::loadNextPage()
 {
-    // play next step in the sequence if sequencer playback is on
-    _sequencer.playBackSequence();
+    if (_currentPage >= NUM_PAGES)
+    {
+        return 0;
+    }
+
+    _currentPage += 1;
+    _midiWorker->panic();
+    loadPage(_currentPage);
+    _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
+
+    return 1;
 }
 
 /*
-* Update led bpm status
+* Load the previous sequence from memory
+* Return: 1 if the sequence is loaded, 0 if the first sequence is already loaded
 */
-void MIDIController::updateBpmIndicatorStatus()
+uint8_t MIDIController::loadPreviousSequence()
 {
-    if (_isMIDIClockOn || _sequencer.isPlayBackOn())
+    if (_sequencer.getCurrentSequence() <= _sequencer.getFirstSequence())
     {
-        _midiLed.setState(!_midiLed.getState());
+        return 0;
     }
 
-    else
+    _midiWorker->panic();
+    _sequencer.setCurrentSequence(_sequencer.getCurrentSequence() - 1);
+    _sequencer.loadCurrentSequence();
+    _sequencer.printDefault(_syncManager);
+
+    return 1;
+}
+
+/*
+* Load the next sequence from memory
+* Return: 1 if the sequence is loaded, 0 if the last sequence is already loaded
+*/
+uint8_t MIDIController::loadNextSequence()
+{
+    if (_sequencer.getCurrentSequence() >= NUM_SEQUENCES)
     {
-        _midiLed.setState(LOW);
+        return 0;
     }
+
+    _midiWorker->panic();
+    _sequencer.setCurrentSequence(_sequencer.getCurrentSequence() + 1);
+    _sequencer.loadCurrentSequence();
+    _sequencer.printDefault(_syncManager);
+
+    return 1;
 }
 
 /*
-* Process the button that set the mode operation: MIDI Controller or Sequencer
+* Display the previous MIDI message of the component loaded into the Screen Manager
+* Return: 1 if the message is displayed, 0 otherwise
 */
-void MIDIController::processOperationModeButton()
+uint8_t MIDIController::displayPreviousMIDIMessage()
 {
-    _operationModeButton.read();
-
-    if (_operationModeButton.wasPressed())
+    if (_subState == DEFAULT_EDIT_MSG || _screenManager.getDisplayedMessageIndex() <= 1)
     {
-        switch (_state)
-        {
-        // Set the operation mode to Sequencer
-        case CONTROLLER:
-            _state = SEQUENCER;
-            _subState = _sequencer.isPlayBackOn() ? PLAYBACK_ON : PLAYBACK_OFF;
-            _sequencer.printDefault(_syncManager);
+        return 0;
+    }
 
-            break;
-        
-        // Set the operation mode to Controller
-        case SEQUENCER:
-            _state = CONTROLLER;
-            _subState = _isMIDIClockOn ? MIDI_CLOCK_ON : MIDI_CLOCK_OFF;
-            _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
+    _screenManager.displayPreviousMIDIMsg();
+    _subState = EDIT_MIDI_TYPE;
 
-            break;
-        }
-    }
+    return 1;
 }
 
 /*
-* Process the button that activates/deactivates the edit mode.
+* Display the next MIDI message of the component loaded into the Screen Manager
+* Return: 1 if the message is displayed, 0 otherwise
 */
-void MIDIController::processEditModeButton()
+uint8_t MIDIController::displayNextMIDIMessage()
 {
-    // activate/deactivate edit mode
-    _editButton.read();
-
-    if (_editButton.wasReleased())
+    if (_subState == DEFAULT_EDIT_MSG || _screenManager.getDisplayedMessageIndex() >= _screenManager.getDisplayedMIDIComponent()->getNumMessages())
     {
-        if (!_wasPageSaved && !_wasGlobalConfigSaved && !_wasSequenceSaved)
-        {
-            switch (_state)
-            {
-            // defaut edit message is displayed on screen
-            case CONTROLLER:
+        return 0;
+    }
 
-                _state = EDIT_PAGE;
-                _subState = DEFAULT_EDIT_MSG;
+    _screenManager.displayNextMIDIMsg();
+    _subState = EDIT_MIDI_TYPE;
 
-                _midiLed.setState(HIGH);  
+    return 1;
+}
 
-                _screenManager.printSelectComponentMessage();
+/*
+* Display the previous step in the sequence
+* Return: 1
+*/
+uint8_t MIDIController::displayPreviousStep()
+{
+    _subState = SEQUENCER_EDIT_STEP_NOTE;
+    _sequencer.printPreviousStep();
 
-                break;
+    return 1;
+}
 
-            // Enter in edit page components mode: LED doesn't blink, default message is displayed on screen
-            case EDIT_PAGE:
+/*
+* Display the next step in the sequence
+* Return: 1
+*/
+uint8_t MIDIController::displayNextStep()
+{
+    _subState = SEQUENCER_EDIT_STEP_NOTE;
+    _sequencer.printNextStep();
 
-                _state = CONTROLLER;
-                _subState = _isMIDIClockOn ? MIDI_CLOCK_ON : MIDI_CLOCK_OFF;
+    return 1;
+}
 
-                _midiLed.setState(LOW);  
+/*
+* Enter in edit page components mode: the default edit message is displayed on screen
+* Return: 1
+*/
+uint8_t MIDIController::enterEditPage()
+{
+    _midiLed.setState(HIGH);
 
-                _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
+    _screenManager.printSelectComponentMessage();
 
-                break;
+    return 1;
+}
 
-            // Enter in global config edit mode: default message is displayed on screen
-            case EDIT_GLOBAL_CONFIG:
+/*
+* Display the step edit screen
+* Return: 1
+*/
+uint8_t MIDIController::enterEditStep()
+{
+    _midiLed.setState(HIGH);
 
-                if (_accesToGloabalEdit)              
-                    _accesToGloabalEdit = 0;                   
-          
-                else
-                {
-                    _state = CONTROLLER;
-                    _subState = _isMIDIClockOn ? MIDI_CLOCK_ON : MIDI_CLOCK_OFF;
+    _sequencer.printEditStepData();
 
-                    _midiLed.setState(LOW);  
+    return 1;
+}
 
-                    _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
-                }
+/*
+* Display the controller default screen when an edit mode is left
+* Return: 1
+*/
+uint8_t MIDIController::exitToController()
+{
+    _midiLed.setState(LOW);
 
-                break;
+    _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
 
-            // display step edit screen
-            case SEQUENCER:
+    return 1;
+}
 
-                _state = SEQUENCER_EDIT_STEP;
-                _subState = SEQUENCER_EDIT_STEP_NOTE;
+/*
+* Display the sequencer default screen when an edit mode is left
+* Return: 1
+*/
+uint8_t MIDIController::exitToSequencer()
+{
+    _midiLed.setState(LOW);
 
-                _midiLed.setState(HIGH);  
+    _sequencer.printDefault(_syncManager);
 
-                _sequencer.printEditStepData();
+    return 1;
+}
 
-                break;
+/*
+* Leave the global configuration edit mode. The release of the long press that entered it is ignored
+* Return: 1 if the edit mode is left, 0 otherwise
+*/
+uint8_t MIDIController::exitGlobalConfig()
+{
+    if (_accesToGloabalEdit)
+    {
+        _accesToGloabalEdit = 0;
+        return 0;
+    }
 
-            // display sequencer default screen
-            case SEQUENCER_EDIT_STEP:
+    return exitToController();
+}
 
-                _state = SEQUENCER;
-                _subState = _sequencer.isPlayBackOn() ? PLAYBACK_ON : PLAYBACK_OFF;
+/*
+* Leave the sequencer configuration edit mode. The release of the long press that entered it is ignored
+* Return: 1 if the edit mode is left, 0 otherwise
+*/
+uint8_t MIDIController::exitSequencerConfig()
+{
+    if (_accesToSequencerEdit)
+    {
+        _accesToSequencerEdit = 0;
+        return 0;
+    }
 
-                _midiLed.setState(LOW);  
+    return exitToSequencer();
+}
 
-                _sequencer.printDefault(_syncManager);
+/*
+* Display the controller default screen after saving a page or the global configuration
+* Return: 0, the controller keeps its state
+*/
+uint8_t MIDIController::acknowledgeControllerSave()
+{
+    _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
 
-                break;
+    // Reset the flags for further button events
+    _wasPageSaved = 0;
+    _wasGlobalConfigSaved = 0;
 
-            // display sequencer global configuration screen
-            case SEQUENCER_EDIT_CONFIG:
+    return switchMIDILedOff();
+}
 
-                if (_accesToSequencerEdit)              
-                    _accesToSequencerEdit = 0;                  
+/*
+* Display the sequencer default screen after saving a sequence or the global configuration, or after changing
+* the sequencer transposition
+* Return: 0, the controller keeps its state
+*/
+uint8_t MIDIController::acknowledgeSequencerSave()
+{
+    _sequencer.printDefault(_syncManager);
 
-                else
-                {
-                    _state = SEQUENCER;
-                    _subState = _sequencer.isPlayBackOn() ? PLAYBACK_ON : PLAYBACK_OFF;
+    // Reset the flags for further button events
+    _wasSequenceSaved = 0;
+    _wasGlobalConfigSaved = 0;
+    _wasTransposeEdited = 0;
 
-                    _midiLed.setState(LOW);  
+    return switchMIDILedOff();
+}
 
-                    _sequencer.printDefault(_syncManager);
-                }
+/*
+* Switch the MIDI led off
+* Return: 0, the controller keeps its state
+*/
+uint8_t MIDIController::switchMIDILedOff()
+{
+    _midiLed.setState(LOW);
 
-                break;
-            }
-        }
+    return 0;
+}
 
-        // after saving a page or global configuration
-        else
-        {
-            switch (_state)
-            {
-            case CONTROLLER:
+/*
+* Display the global configuration edit screen on a long press of the edit mode button
+* Return: 1
+*/
+uint8_t MIDIController::enterGlobalConfig()
+{
+    _accesToGloabalEdit = 1;
 
-                // display default message on screen
-                _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
+    _midiLed.setState(HIGH);
 
-                // Reset the flags for further button events
-                _wasPageSaved = 0;
-                _wasGlobalConfigSaved = 0;
+    _screenManager.printEditGlobalConfig(_globalConfig);
 
-                break;
+    return 1;
+}
 
-            case SEQUENCER:
+/*
+* Display the sequencer configuration edit screen on a long press of the edit mode button
+* Return: 1 if the screen is displayed, 0 if the button is held to transpose the sequencer
+*/
+uint8_t MIDIController::enterSequencerConfig()
+{
+    if (_wasTransposeEdited)
+    {
+        return 0;
+    }
 
-                _sequencer.printDefault(_syncManager);
+    _accesToSequencerEdit = 1;
 
-                // Reset the flags for further button events
-                _wasSequenceSaved = 0;
-                _wasGlobalConfigSaved = 0;
+    _midiLed.setState(HIGH);
 
-                break;
-            }
+    _sequencer.printEditConfig(_globalConfig);
 
-            _midiLed.setState(LOW);  
-        }
+    return 1;
+}
+
+/*
+* Stop the MIDI clock and the sequencer playback before saving data into the EEPROM
+*/
+void MIDIController::stopBeforeSave()
+{
+    if (_isMIDIClockOn)
+    {
+        _isMIDIClockOn = 0;
+        _midiWorker->sendMIDIStopClock();
     }
 
-    // save current page component's configuration / steps within a sequence / global configuration and exits edit mode
-    if (_editButton.pressedFor(PRESSED_FOR_WAIT))
+    if (_sequencer.isPlayBackOn())
     {
-        switch (_state)
-        {
-        case CONTROLLER:
+        _sequencer.stopPlayBack();
+    }
 
-            _state = EDIT_GLOBAL_CONFIG;
-            _subState = EDIT_GLOBAL_MODE;
+    _midiLed.setState(LOW);
+}
 
-            _accesToGloabalEdit = 1;
+/*
+* Save the current page and display a message for a while
+* Return: 1
+*/
+uint8_t MIDIController::saveCurrentPage()
+{
+    stopBeforeSave();
 
-            _midiLed.setState(HIGH);  
+    // saves the current page
+    savePage(_currentPage);
+    _wasPageSaved = 1;
 
-            _screenManager.printEditGlobalConfig(_globalConfig);
+    // prints a message and waits to continue
+    _screenManager.printSavedMessage();
+    delay(2000);
 
-            break;
+    return 1;
+}
 
-        case SEQUENCER:
+/*
+* Save the current sequence and display a message for a while
+* Return: 1
+*/
+uint8_t MIDIController::saveCurrentSequence()
+{
+    stopBeforeSave();
 
-            _state = SEQUENCER_EDIT_CONFIG;
-            _subState = SEQUENCER_EDIT_PLAYBACK_MODE;
+    // saves the current sequence
+    _wasSequenceSaved = 1;
 
-            _accesToSequencerEdit = 1;
+    // prints a message and waits to continue
+    _sequencer.saveCurrentSequence() ? _screenManager.printSavedMessage() : _screenManager.printMemoryFullMessage();
+    delay(2000);
 
-            _midiLed.setState(HIGH);  
+    return 1;
+}
 
-            _sequencer.printEditConfig(_globalConfig);
+/*
+* Save the global configuration parameters and display a message for a while
+*/
+void MIDIController::saveConfiguration()
+{
+    stopBeforeSave();
 
-            break;
+    // saves the global configuration parameters
+    _memoryManager.saveGlobalConfiguration(_globalConfig);
+    _wasGlobalConfigSaved = 1;
 
-        case EDIT_PAGE:
+    // prints a message and waits to continue
+    _screenManager.printSavedMessage();
+    delay(2000);
+}
 
-            if (_isMIDIClockOn)
-            {
-                _isMIDIClockOn = 0;
-                _midiWorker->sendMIDIStopClock();
-            }
+/*
+* Save the global configuration from its edit screen. The long press that entered the screen does not save it
+* Return: 1 if the configuration is saved, 0 otherwise
+*/
+uint8_t MIDIController::saveGlobalConfig()
+{
+    if (_accesToGloabalEdit)
+    {
+        return 0;
+    }
 
-            if (_sequencer.isPlayBackOn())
-            {
-                _sequencer.stopPlayBack();
-            }
+    saveConfiguration();
 
-            _midiLed.setState(LOW);
+    return 1;
+}
 
-            // saves the current page
-            savePage(_currentPage);
-            _wasPageSaved = 1;
+/*
+* Save the global configuration from the sequencer configuration screen. The long press that entered the screen does not save it
+* Return: 1 if the configuration is saved, 0 otherwise
+*/
+uint8_t MIDIController::saveSequencerConfig()
+{
+    if (_accesToSequencerEdit)
+    {
+        return 0;
+    }
 
-            // prints a message and waits to continue
-            _screenManager.printSavedMessage();
-            delay(2000);
+    saveConfiguration();
 
-            _state = CONTROLLER;
-            _subState = MIDI_CLOCK_OFF;
+    return 1;
+}
 
-            break;
+/*
+* Set the operation mode to Sequencer, starting on the first track
+* Return: 1
+*/
+uint8_t MIDIController::enterSequencer()
+{
+    _sequencer.setSelectedTrack(0);
+    _sequencer.printDefault(_syncManager);
 
-        case EDIT_GLOBAL_CONFIG:
+    return 1;
+}
 
-            if (!_accesToGloabalEdit)
-            {
-                if (_isMIDIClockOn)
-                {
-                    _isMIDIClockOn = 0;
-                    _midiWorker->sendMIDIStopClock();
-                }
+/*
+* Select the next track. After the last one the arpeggiator is displayed, with the cursor on its mode
+* Return: 1 if the operation mode is set to Arpeggiator, 0 if the next track is selected
+*/
+uint8_t MIDIController::selectNextTrack()
+{
+    if (_sequencer.getSelectedTrack() < _sequencer.getTracksNumber() - 1)
+    {
+        _sequencer.setSelectedTrack(_sequencer.getSelectedTrack() + 1);
+        _sequencer.printDefault(_syncManager);
 
-                if (_sequencer.isPlayBackOn())
-                {
-                    _sequencer.stopPlayBack();
-                }
-                _midiLed.setState(LOW);
+        return 0;
+    }
 
-                // saves the global configuration parameters
-                _memoryManager.saveGlobalConfiguration(_globalConfig);
-                _wasGlobalConfigSaved = 1;
+    _arpeggiator.setMIDIChannel(_globalConfig.getMIDIChannel());
 
-                // prints a message and waits to continue
-                _screenManager.printSavedMessage();
-                delay(2000);
+    _screenManager.printArpeggiator(_arpeggiator.getModeName(), _arpeggiator.getOctaves(), _arpeggiator.getRate());
+    _screenManager.moveCursorToArpeggiatorMode();
 
-                _state = CONTROLLER;
-                _subState = MIDI_CLOCK_OFF;
-            }
+    return 1;
+}
 
-            break;
+/*
+* Set the operation mode to Controller. The held notes are released
+* Return: 1
+*/
+uint8_t MIDIController::exitArpeggiator()
+{
+    _arpeggiator.clear();
 
-        case SEQUENCER_EDIT_STEP:
+    _screenManager.printDefault(_currentPage, NUM_PAGES, _syncManager.getBpm(), _isMIDIClockOn);
 
-            if (_isMIDIClockOn)
-            {
-                _isMIDIClockOn = 0;
-                _midiWorker->sendMIDIStopClock();
-            }
+    return 1;
+}
 
-            if (_sequencer.isPlayBackOn())
-            {
-                _sequencer.stopPlayBack();
-            }
+/*
+* Returns the MIDI message of the component displayed on the screen that is being edited
+*/
+MIDIMessage *MIDIController::getDisplayedMessage()
+{
+    return &(_screenManager.getDisplayedMIDIComponent()->getMessages()[_screenManager.getDisplayedMessageIndex() - 1]);
+}
 
-            _midiLed.setState(LOW);
+/*
+* Select the type of the MIDI message being edited
+*/
+void MIDIController::selectMIDIType()
+{
+    IMIDIComponent *displayedComponent = _screenManager.getDisplayedMIDIComponent();
+    MIDIMessage *message = getDisplayedMessage();
 
-            // saves the current page
-            _sequencer.saveCurrentSequence();
-            _wasSequenceSaved = 1;
+    // get the current MIDI message type
+    uint8_t oldType = message->getType();
 
-            // prints a message and waits to continue
-            _screenManager.printSavedMessage();
-            delay(2000);
+    // set the new MIDI message type into the component and refresh the screen
+    uint8_t *availableMIDIMessages = displayedComponent->getAvailableMessageTypes();
+    uint8_t numAvailableMsgTypes = displayedComponent->getNumAvailableMessageTypes();
 
-            _state = SEQUENCER;
-            _subState = PLAYBACK_OFF;
+    message->setType(availableMIDIMessages[map(_selectValuePot.getSmoothValue(), 0, 1022, 0, numAvailableMsgTypes - 1)]);
 
-            break;
+    if (oldType != message->getType())
+    {
+        _screenManager.refreshMIDIData();
+    }
+}
 
-        case SEQUENCER_EDIT_CONFIG:
+/*
+* Select the note of the MIDI message being edited. The whole potentiometer range selects notes of the scale
+*/
+void MIDIController::selectNote()
+{
+    uint8_t note = _globalConfig.getScaleNote(NOTE_C_1, map(_selectValuePot.getSmoothValue(), 0, 1022, 0, _globalConfig.getScaleNotesNumber(NOTE_C_1, NOTE_C7) - 1));
 
-            if (!_accesToSequencerEdit)
-            {
-                if (_isMIDIClockOn)
-                {
-                    _isMIDIClockOn = 0;
-                    _midiWorker->sendMIDIStopClock();
-                }
+    getDisplayedMessage()->setDataByte1(note);
 
-                if (_sequencer.isPlayBackOn())
-                {
-                    _sequencer.stopPlayBack();
-                }
+    // print the new note value on the screen
+    _screenManager.refreshNoteValue(note);
+}
 
-                _midiLed.setState(LOW);
+/*
+* Select the velocity of the MIDI message being edited
+*/
+void MIDIController::selectVelocity()
+{
+    uint8_t velocity = map(_selectValuePot.getSmoothValue(), 0, 1022, 1, 127);
+
+    getDisplayedMessage()->setDataByte2(velocity);
+
+    // print the new velocity value on the screen
+    _screenManager.refreshVelocityValue(velocity);
+}
+
+/*
+* Select the control change number of the MIDI message being edited
+*/
+void MIDIController::selectCC()
+{
+    uint8_t ccValue = map(_selectValuePot.getSmoothValue(), 0, 1022, 0, 127);
+
+    getDisplayedMessage()->setDataByte1(ccValue);
+
+    // print the new cc value on the screen
+    _screenManager.refreshCCValue(ccValue);
+}
+
+/*
+* Select the NRPN/RPN parameter number MSB of the MIDI message being edited
+*/
+void MIDIController::selectParameterMSB()
+{
+    uint8_t msb = map(_selectValuePot.getSmoothValue(), 0, 1022, 0, 127);
+
+    getDisplayedMessage()->setDataByte1(msb);
+
+    // print the new parameter number MSB on the screen
+    _screenManager.refreshParameterMSBValue(msb);
+}
+
+/*
+* Select the NRPN/RPN parameter number LSB of the MIDI message being edited
+*/
+void MIDIController::selectParameterLSB()
+{
+    uint8_t lsb = map(_selectValuePot.getSmoothValue(), 0, 1022, 0, 127);
+
+    getDisplayedMessage()->setDataByte2(lsb);
+
+    // print the new parameter number LSB on the screen
+    _screenManager.refreshParameterLSBValue(lsb);
+}
+
+/*
+* Select the musical mode of the global configuration
+*/
+void MIDIController::selectGlobalMode()
+{
+    // get the current mode
+    uint8_t currentMode = _globalConfig.getMode();
+
+    _globalConfig.setMode(map(_selectValuePot.getSmoothValue(), 0, 1022, MIDIUtils::Ionian, MIDIUtils::Chromatic));
+
+    if (currentMode != _globalConfig.getMode())
+    {
+        _sequencer.setScale(_globalConfig.getRootNote(), _globalConfig.getMode());
+        _screenManager.refreshModeData(_globalConfig.getMode());
+    }
+}
+
+/*
+* Select the root note of the global configuration
+*/
+void MIDIController::selectGlobalRootNote()
+{
+    // get the current root note
+    uint8_t currentRootNote = _globalConfig.getRootNote();
+
+    _globalConfig.setRootNote(map(_selectValuePot.getSmoothValue(), 0, 1022, MIDIUtils::C, MIDIUtils::B));
+
+    if (currentRootNote != _globalConfig.getRootNote())
+    {
+        _sequencer.setScale(_globalConfig.getRootNote(), _globalConfig.getMode());
+        _screenManager.refreshRootNoteData(_globalConfig.getRootNote());
+    }
+}
+
+/*
+* Select the MIDI channel of the global configuration
+*/
+void MIDIController::selectGlobalMIDIChannel()
+{
+    // get the current MIDI channel
+    uint8_t currentMIDIChannel = _globalConfig.getMIDIChannel();
+
+    _globalConfig.setMIDIChannel(map(_selectValuePot.getSmoothValue(), 0, 1022, MIDIUtils::CHANNEL1, MIDIUtils::CHANNEL16));
+
+    if (currentMIDIChannel != _globalConfig.getMIDIChannel())
+    {
+        _screenManager.refreshMIDIChannelData(_globalConfig.getMIDIChannel());
+    }
+}
+
+/*
+* Update the note assigned to the current edited step
+*/
+void MIDIController::selectStepNote()
+{
+    uint8_t note = _globalConfig.getScaleNote(NOTE_C_1, map(_selectValuePot.getSmoothValue(), 0, 1022, 0, _globalConfig.getScaleNotesNumber(NOTE_C_1, NOTE_C7) - 1));
+
+    _sequencer.setDisplayedStepNote(note);
+}
+
+/*
+* Update legato value assigned to the current edited step
+*/
+void MIDIController::selectStepLegato()
+{
+    _sequencer.setDisplayedStepLegato(map(_selectValuePot.getSmoothValue(), 0, 1022, 0, 1));
+}
+
+/*
+* Update enabled value assigned to the current edited step
+*/
+void MIDIController::selectStepEnabled()
+{
+    _sequencer.setDisplayedStepEnabled(map(_selectValuePot.getSmoothValue(), 0, 1022, 0, 1));
+}
+
+/*
+* Update the number of steps of the edited sequence
+*/
+void MIDIController::selectSequenceLength()
+{
+    _sequencer.setDisplayedSequenceLength(map(_selectValuePot.getSmoothValue(), 0, 1022, 1, _sequencer.getMaxSequenceLength()));
+}
+
+/*
+* Update the velocity of the current edited step
+*/
+void MIDIController::selectStepVelocity()
+{
+    _sequencer.setDisplayedStepVelocity(map(_selectValuePot.getSmoothValue(), 0, 1022, 1, 127));
+}
+
+/*
+* Update the probability level of the current edited step
+*/
+void MIDIController::selectStepProbability()
+{
+    _sequencer.setDisplayedStepProbability(map(_selectValuePot.getSmoothValue(), 0, 1022, 0, Step::MAX_PROBABILITY));
+}
+
+/*
+* Update the number of ratchets of the current edited step
+*/
+void MIDIController::selectStepRatchets()
+{
+    _sequencer.setDisplayedStepRatchets(map(_selectValuePot.getSmoothValue(), 0, 1022, 1, Step::MAX_RATCHETS));
+}
+
+/*
+* Select the sequencer playback mode
+*/
+void MIDIController::selectPlayBackMode()
+{
+    // get the current playback mode
+    uint8_t currentMode = _sequencer.getPlayBackMode();
 
-                // saves the global configuration parameters
-                _memoryManager.saveGlobalConfiguration(_globalConfig);
-                _wasGlobalConfigSaved = 1;
+    _sequencer.setPlayBackMode(map(_selectValuePot.getSmoothValue(), 0, 1022, 0, _sequencer.getPlayBackModeTypesNumber() - 1));
+
+    if (currentMode != _sequencer.getPlayBackMode())
+    {
+        _sequencer.refreshDisplayedPlayBackMode(_sequencer.getPlayBackMode());
+    }
+}
+
+/*
+* Activate/deactivate send clock in sync with sequencer playback. It cannot be changed while playback is on
+*/
+void MIDIController::selectSendClockWhilePlayback()
+{
+    if (!_sequencer.isPlayBackOn())
+    {
+        uint8_t currentSendClockWhilePlayBack = _globalConfig.getSendClockWhilePlayback();
+        _globalConfig.setSendClockWhilePlayback(map(_selectValuePot.getSmoothValue(), 0, 1022, 0, 1));
 
-                // prints a message and waits to continue
-                _screenManager.printSavedMessage();
-                delay(2000);
+        if (currentSendClockWhilePlayBack != _globalConfig.getSendClockWhilePlayback())
+        {
+            _sequencer.refreshDisplayedSendClockWhilePlayback(_globalConfig.getSendClockWhilePlayback());
+        }
+    }
+}
 
-                _state = SEQUENCER;
-                _subState = PLAYBACK_OFF;
+/*
+* Select the sequencer step size. It cannot be changed while playback is on
+*/
+void MIDIController::selectStepSize()
+{
+    if (!_sequencer.isPlayBackOn())
+    {
+        uint8_t currentStepSize = _sequencer.getStepSize();
+
+        // set the new value of the step size if valid
+        uint8_t newStepSize = map(_selectValuePot.getSmoothValue(), 0, 1022, Sequencer::QUARTER, Sequencer::THIRTYSECOND);
+
+        if (_sequencer.isStepSizeValueValid(newStepSize))
+        {
+            _sequencer.setStepSize(newStepSize);
+
+            if (currentStepSize != _sequencer.getStepSize())
+            {
+                _sequencer.refreshDisplayedStepSizeValue(_sequencer.getStepSize());
             }
+        }
+    }
+}
 
-            break;
+/*
+* Select the sequencer MIDI channel value
+*/
+void MIDIController::selectSequencerMIDIChannel()
+{
+    uint8_t currentSeqMIDIChannel = _sequencer.getMIDIChannel();
+
+    _sequencer.setMIDIChannel(map(_selectValuePot.getSmoothValue(), 0, 1022, MIDIUtils::CHANNEL1, MIDIUtils::CHANNEL16));
+
+    if (currentSeqMIDIChannel != _sequencer.getMIDIChannel())
+    {
+        // the MIDI channel of the first track is stored within the global configuration
+        if (_sequencer.getSelectedTrack() == 0)
+        {
+            _globalConfig.setSequencerMIDIChannel(_sequencer.getMIDIChannel());
         }
+
+        _sequencer.refreshDisplayedMIDIChannel(_sequencer.getMIDIChannel());
     }
 }
 
-uint16_t MIDIController::getBpm()
+/*
+* Select the hits of the euclidean pattern of the selected track
+*/
+void MIDIController::selectEuclideanHits()
 {
-    return _syncManager.getBpm();
+    uint8_t hits = map(_selectValuePot.getSmoothValue(), 0, 1022, 0, _sequencer.getEuclideanSteps());
+
+    if (hits != _sequencer.getEuclideanHits())
+    {
+        _sequencer.setEuclideanHits(hits);
+    }
+}
+
+/*
+* Select the steps of the euclidean pattern of the selected track
+*/
+void MIDIController::selectEuclideanSteps()
+{
+    uint8_t steps = map(_selectValuePot.getSmoothValue(), 0, 1022, 1, _sequencer.getSequenceLength());
+
+    if (steps != _sequencer.getEuclideanSteps())
+    {
+        _sequencer.setEuclideanSteps(steps);
+    }
+}
+
+/*
+* Select the rotation of the euclidean pattern of the selected track
+*/
+void MIDIController::selectEuclideanRotation()
+{
+    uint8_t rotation = map(_selectValuePot.getSmoothValue(), 0, 1022, 0, _sequencer.getEuclideanSteps() - 1);
+
+    if (rotation != _sequencer.getEuclideanRotation())
+    {
+        _sequencer.setEuclideanRotation(rotation);
+    }
+}
+
+/*
+* Select the arpeggiator mode
+*/
+void MIDIController::selectArpeggiatorMode()
+{
+    uint8_t mode = map(_selectValuePot.getSmoothValue(), 0, 1022, Arpeggiator::UP, Arpeggiator::MODE_TYPES - 1);
+
+    if (mode != _arpeggiator.getMode())
+    {
+        _arpeggiator.setMode(mode);
+        printArpeggiator();
+    }
+}
+
+/*
+* Select the octaves played by the arpeggiator
+*/
+void MIDIController::selectArpeggiatorOctaves()
+{
+    uint8_t octaves = map(_selectValuePot.getSmoothValue(), 0, 1022, 1, Arpeggiator::MAX_OCTAVES);
+
+    if (octaves != _arpeggiator.getOctaves())
+    {
+        _arpeggiator.setOctaves(octaves);
+        printArpeggiator();
+    }
+}
+
+/*
+* Select the arpeggiator rate, from a note per quarter note to a note per thirty-second note
+*/
+void MIDIController::selectArpeggiatorRate()
+{
+    uint8_t rate = 1 << map(_selectValuePot.getSmoothValue(), 0, 1022, 0, 3);
+
+    if (rate != _arpeggiator.getRate())
+    {
+        _arpeggiator.setRate(rate);
+        printArpeggiator();
+    }
+}
+
+/*
+* Move the cursor from the MIDI message type to its first data value, which depends on the type
+*/
+void MIDIController::moveCursorToMIDIData()
+{
+    switch (_screenManager.getDisplayedMessageType())
+    {
+    case midi::ControlChange:
+
+        _subState = EDIT_CC;
+        _screenManager.moveCursorToCC();
+
+        break;
+
+    case MIDIMessage::NRPN:
+    case MIDIMessage::RPN:
+
+        _subState = EDIT_PARAM_MSB;
+        _screenManager.moveCursorToParameterMSB();
+
+        break;
+
+    case midi::NoteOn:
+    case midi::NoteOff:
+
+        _subState = EDIT_NOTE;
+        _screenManager.moveCursorToNote();
+
+        break;
+    }
+}
+
+/*
+* Cursor moves to the parameters of the edit screens, called from the parameter transitions table
+*/
+void MIDIController::moveCursorToMsgType()
+{
+    _screenManager.moveCursorToMsgType();
+}
+
+void MIDIController::moveCursorToVelocity()
+{
+    _screenManager.moveCursorToVelocity();
+}
+
+void MIDIController::moveCursorToParameterLSB()
+{
+    _screenManager.moveCursorToParameterLSB();
+}
+
+void MIDIController::moveCursorToRootNote()
+{
+    _screenManager.moveCursorToRootNote();
+}
+
+void MIDIController::moveCursorToMIDIChannel()
+{
+    _screenManager.moveCursorToMIDIChannel();
+}
+
+void MIDIController::moveCursorToMode()
+{
+    _screenManager.moveCursorToMode();
+}
+
+void MIDIController::moveCursorToStepNote()
+{
+    _sequencer.moveCursorToNote();
+}
+
+void MIDIController::moveCursorToStepLegato()
+{
+    _sequencer.moveCursorToLegato();
+}
+
+void MIDIController::moveCursorToStepEnabled()
+{
+    _sequencer.moveCursorToEnabled();
 }
 
-uint8_t MIDIController::getStepSize()
+void MIDIController::moveCursorToStepLength()
 {
-    return _sequencer.getStepSize();
+    _sequencer.moveCursorToLength();
+}
+
+void MIDIController::moveCursorToStepVelocity()
+{
+    _sequencer.moveCursorToVelocity();
+}
+
+void MIDIController::moveCursorToStepProbability()
+{
+    _sequencer.moveCursorToProbability();
+}
+
+void MIDIController::moveCursorToStepRatchets()
+{
+    _sequencer.moveCursorToRatchets();
+}
+
+void MIDIController::moveCursorToSendClockWhilePlayback()
+{
+    _sequencer.moveCursorToSendClockWhilePlayback();
+}
+
+void MIDIController::moveCursorToStepSize()
+{
+    _sequencer.moveCursorToStepSize();
+}
+
+void MIDIController::moveCursorToSequencerMIDIChannel()
+{
+    _sequencer.moveCursorToMIDIChannel();
+}
+
+void MIDIController::moveCursorToEuclideanHits()
+{
+    _sequencer.moveCursorToEuclideanHits();
+}
+
+void MIDIController::moveCursorToEuclideanSteps()
+{
+    _sequencer.moveCursorToEuclideanSteps();
+}
+
+void MIDIController::moveCursorToEuclideanRotation()
+{
+    _sequencer.moveCursorToEuclideanRotation();
+}
+
+void MIDIController::moveCursorToArpeggiatorMode()
+{
+    _screenManager.moveCursorToArpeggiatorMode();
+}
+
+void MIDIController::moveCursorToArpeggiatorOctaves()
+{
+    _screenManager.moveCursorToArpeggiatorOctaves();
+}
+
+void MIDIController::moveCursorToArpeggiatorRate()
+{
+    _screenManager.moveCursorToArpeggiatorRate();
+}
+
+/*
+* Display the sequencer configuration again after the last parameter, so the step size and MIDI channel are displayed
+*/
+void MIDIController::printSequencerConfig()
+{
+    _sequencer.printEditConfig(_globalConfig);
+}
+
+uint16_t MIDIController::getBpm()
+{
+    return _syncManager.getBpm();
 }
 
 uint8_t MIDIController::getResetMIDIClockPeriod()
@@ -35,6 +35,7 @@
 #include <Led.h>
 #include <GlobalConfig.h>
 #include <Sequencer.h>
+#include <Arpeggiator.h>
 #include <SyncManager.h>
 #include <hd44780.h>                       // main hd44780 header
 #include <hd44780ioClass/hd44780_I2Cexp.h> // i2c expander i/o class header
@@ -55,11 +56,13 @@ public:
   void processMultiplePurposeButton();
   void processEditModeButton();
   void playBackSequence();
+  void playArpeggio();
+  void renderNextStep();
+  void refreshScreen();
   void processOperationModeButton();
   void sendMIDIClock();
   void updateBpmIndicatorStatus();
   uint16_t getBpm();
-  uint8_t getStepSize();
   uint8_t getResetMIDIClockPeriod();
   void setResetMIDIClockPeriod(uint8_t resetMIDIClockPeriod);
 
@@ -71,6 +74,9 @@ private:
   uint8_t _currentPage;          // current page of MIDI messages loaded into the controller
   uint8_t _wasPageSaved;         // flag that indicates wether a page was saved or not.
   uint8_t _wasSequenceSaved;     // flag that indicates wether a sequence was saved or not.
+  uint8_t _wasShortcutPressed;   // flag that indicates wether the multiple purpose button press switched recording or scale lock on/off or not.
+  uint8_t _wasTransposeEdited;   // flag that indicates wether transposition or scale lock were changed while holding the edit button or not.
+  uint16_t _transposingButtons;  // MIDI components (one bit each) whose note on transposed the sequencer. Their note off is not sent either.
   uint8_t _wasGlobalConfigSaved; // flag that indicates wether global configuration was saved or not.
   uint8_t _accesToGloabalEdit;   // flag that indicates wether we have just accesed to edit global config or not.
   uint8_t _accesToSequencerEdit; // flag that indicates wether we have just accesed to sequencer config edit or not.
@@ -95,6 +101,8 @@ private:
 
   SyncManager _syncManager; // Bpm manager
 
+  Arpeggiator _arpeggiator; // Arpeggiator played with the notes held on the MIDI buttons
+
   enum State
   {
     CONTROLLER,
@@ -102,7 +110,9 @@ private:
     EDIT_PAGE,
     EDIT_GLOBAL_CONFIG,
     SEQUENCER_EDIT_STEP,
-    SEQUENCER_EDIT_CONFIG
+    SEQUENCER_EDIT_CONFIG,
+    ARPEGGIATOR,
+    STATES
   }; // Controller status list
   enum SubState
   {
@@ -116,30 +126,164 @@ private:
     EDIT_NOTE,
     EDIT_VELOCITY,
     EDIT_CC,
+    EDIT_PARAM_MSB,
+    EDIT_PARAM_LSB,
     PLAYBACK_ON,
     PLAYBACK_OFF,
     SEQUENCER_EDIT_STEP_NOTE,
     SEQUENCER_EDIT_STEP_LEGATO,
     SEQUENCER_EDIT_STEP_ENABLED,
+    SEQUENCER_EDIT_STEP_LENGTH,
+    SEQUENCER_EDIT_STEP_VELOCITY,
+    SEQUENCER_EDIT_STEP_PROBABILITY,
+    SEQUENCER_EDIT_STEP_RATCHETS,
     SEQUENCER_EDIT_PLAYBACK_MODE,
     SEQUENCER_EDIT_SEND_CLOCK_WHILE_PLAYBACK,
     SEQUENCER_EDIT_STEP_SIZE,
-    SEQUENCER_EDIT_MIDI_CH
+    SEQUENCER_EDIT_MIDI_CH,
+    SEQUENCER_EDIT_EUCLIDEAN_HITS,
+    SEQUENCER_EDIT_EUCLIDEAN_STEPS,
+    SEQUENCER_EDIT_EUCLIDEAN_ROTATION,
+    ARPEGGIATOR_EDIT_MODE,
+    ARPEGGIATOR_EDIT_OCTAVES,
+    ARPEGGIATOR_EDIT_RATE,
+    SUBSTATES
   }; // Controller substatus list
+  enum Event
+  {
+    SELECT_VALUE_EVENT,
+    MULTIPLE_PURPOSE_PRESSED_EVENT,
+    MULTIPLE_PURPOSE_RELEASED_EVENT,
+    MULTIPLE_PURPOSE_HELD_EVENT,
+    DEC_PAGE_PRESSED_EVENT,
+    INC_PAGE_PRESSED_EVENT,
+    EDIT_RELEASED_EVENT,
+    EDIT_RELEASED_AFTER_SAVE_EVENT,
+    EDIT_HELD_EVENT,
+    OPERATION_MODE_PRESSED_EVENT,
+    EVENTS
+  }; // Events of the buttons and the select value potentiometer that drive the controller status
   uint8_t _state, _subState; // Controller current status and substatus
 
+  typedef uint8_t (MIDIController::*TransitionAction)();
+  typedef void (MIDIController::*ParameterAction)();
+
+  struct Transition
+  {
+    TransitionAction action; // action done on the event. Returns 1 if the transition is taken, 0 if its guard keeps the current status
+    uint8_t nextState;       // status the controller moves to when the transition is taken
+  };
+
+  struct ParameterTransition
+  {
+    ParameterAction selectValue; // sets the parameter to the value of the select value potentiometer
+    uint8_t nextSubState;        // parameter the multiple purpose button moves the cursor to
+    ParameterAction moveCursor;  // moves the cursor to the next parameter
+  };
+
+  static const Transition transitions[EVENTS][STATES];              // transition of each status on each event
+  static const ParameterTransition parameterTransitions[SUBSTATES]; // value selection and cursor move of each substatus
+  static const uint8_t entrySubStates[STATES];                      // substatus each status starts on
+
   GlobalConfig _globalConfig = GlobalConfig(); // Object containing the global configuration
 
-  void processMidiComponent(IMIDIComponent *component);
+  void processMidiComponent(IMIDIComponent *component, uint8_t index);
 
   void printSerial(MIDIMessage message);
   void savePage(uint8_t page);
   void loadPage(uint8_t page);
-  void updateMIDIClockState();
+  uint8_t updateMIDIClockState();
   void updateSequencerPlayBackStatus();
-  void moveCursorToValue();
-  void moveCursorToStepValue();
-  void moveCursorToGLobalConfigParameter();
-  void moveCursorToSequencerConfigParameter();
+  void printArpeggiator();
+
+  void processEvent(uint8_t event);
+  void enterState(uint8_t state);
+  uint8_t selectTempo();
+  uint8_t selectParameterValue();
+  uint8_t moveCursorToNextParameter();
+  uint8_t switchScaleLock();
+  uint8_t releaseMultiplePurposeButton();
+  uint8_t switchRecording();
+  uint8_t loadPreviousPage();
+  uint8_t loadNextPage();
+  uint8_t loadPreviousSequence();
+  uint8_t loadNextSequence();
+  uint8_t displayPreviousMIDIMessage();
+  uint8_t displayNextMIDIMessage();
+  uint8_t displayPreviousStep();
+  uint8_t displayNextStep();
+  uint8_t enterEditPage();
+  uint8_t enterEditStep();
+  uint8_t exitToController();
+  uint8_t exitToSequencer();
+  uint8_t exitGlobalConfig();
+  uint8_t exitSequencerConfig();
+  uint8_t acknowledgeControllerSave();
+  uint8_t acknowledgeSequencerSave();
+  uint8_t switchMIDILedOff();
+  uint8_t enterGlobalConfig();
+  uint8_t enterSequencerConfig();
+  void stopBeforeSave();
+  uint8_t saveCurrentPage();
+  uint8_t saveCurrentSequence();
+  void saveConfiguration();
+  uint8_t saveGlobalConfig();
+  uint8_t saveSequencerConfig();
+  uint8_t enterSequencer();
+  uint8_t selectNextTrack();
+  uint8_t exitArpeggiator();
+
+  MIDIMessage *getDisplayedMessage();
+  void selectMIDIType();
+  void selectNote();
+  void selectVelocity();
+  void selectCC();
+  void selectParameterMSB();
+  void selectParameterLSB();
+  void selectGlobalMode();
+  void selectGlobalRootNote();
+  void selectGlobalMIDIChannel();
+  void selectStepNote();
+  void selectStepLegato();
+  void selectStepEnabled();
+  void selectSequenceLength();
+  void selectStepVelocity();
+  void selectStepProbability();
+  void selectStepRatchets();
+  void selectPlayBackMode();
+  void selectSendClockWhilePlayback();
+  void selectStepSize();
+  void selectSequencerMIDIChannel();
+  void selectEuclideanHits();
+  void selectEuclideanSteps();
+  void selectEuclideanRotation();
+  void selectArpeggiatorMode();
+  void selectArpeggiatorOctaves();
+  void selectArpeggiatorRate();
+
+  void moveCursorToMIDIData();
+  void moveCursorToMsgType();
+  void moveCursorToVelocity();
+  void moveCursorToParameterLSB();
+  void moveCursorToRootNote();
+  void moveCursorToMIDIChannel();
+  void moveCursorToMode();
+  void moveCursorToStepNote();
+  void moveCursorToStepLegato();
+  void moveCursorToStepEnabled();
+  void moveCursorToStepLength();
+  void moveCursorToStepVelocity();
+  void moveCursorToStepProbability();
+  void moveCursorToStepRatchets();
+  void moveCursorToSendClockWhilePlayback();
+  void moveCursorToStepSize();
+  void moveCursorToSequencerMIDIChannel();
+  void moveCursorToEuclideanHits();
+  void moveCursorToEuclideanSteps();
+  void moveCursorToEuclideanRotation();
+  void moveCursorToArpeggiatorMode();
+  void moveCursorToArpeggiatorOctaves();
+  void moveCursorToArpeggiatorRate();
+  void printSequencerConfig();
 };
 #endif
\ No newline at end of file
@@ -32,6 +32,7 @@ MIDIMessage::MIDIMessage(uint8_t type, uint8_t dataByte1, uint8_t dataByte2)
   _type = type;
   _dataByte1 = dataByte1;
   _dataByte2 = dataByte2; 
+  _value = 0;
 }
 
 /*
@@ -42,6 +43,7 @@ MIDIMessage::MIDIMessage()
   _type = 0;
   _dataByte1 = 0;
   _dataByte2 = 0; 
+  _value = 0;
 }
 
 /*
@@ -62,6 +64,11 @@ uint8_t MIDIMessage::getDataByte2()
   return _dataByte2;
 }
 
+uint16_t MIDIMessage::getValue()
+{
+  return _value;
+}
+
 /*
 * Setter methods.
 */
@@ -78,4 +85,9 @@ void MIDIMessage::setDataByte1(uint8_t dataByte1)
 void MIDIMessage::setDataByte2(uint8_t dataByte2)
 {
   _dataByte2 = dataByte2;
+}
+
+void MIDIMessage::setValue(uint16_t value)
+{
+  _value = value;
 }
\ No newline at end of file
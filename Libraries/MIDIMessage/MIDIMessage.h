@@ -28,18 +28,30 @@ class MIDIMessage
   public:
     MIDIMessage(); 
     MIDIMessage(uint8_t type, uint8_t dataByte1, uint8_t dataByte2); 
+
+    // Parameter number message types. They are not defined by the MIDI library, so values below 0x80
+    // are used: they can never be a MIDI status byte, so they do not collide with any real MIDI message type.
+    // Data byte 1 and data byte 2 hold the MSB and LSB of the 14-bit parameter number.
+    enum
+    {
+      NRPN = 0x01,
+      RPN = 0x02
+    };
     
     uint8_t getType();
     uint8_t getDataByte1();
     uint8_t getDataByte2();
+    uint16_t getValue();
 
     void setType(uint8_t type);
     void setDataByte1(uint8_t dataByte1);
     void setDataByte2(uint8_t dataByte2);  
+    void setValue(uint16_t value);
 
   private:
     uint8_t _type;      // MIDI message type
     uint8_t _dataByte1; // data byte 1
     uint8_t _dataByte2; // data byte 2 
+    uint16_t _value;    // 14-bit value of NRPN/RPN messages. It is not stored into the EEPROM
 };
 #endif
\ No newline at end of file
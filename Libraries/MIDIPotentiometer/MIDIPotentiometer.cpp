@@ -32,7 +32,9 @@ MIDIPotentiometer<T>::MIDIPotentiometer(uint8_t pin, uint8_t windowSize, MIDIMes
 
 	_availableMessageTypes[0] = midi::ControlChange;
 	_availableMessageTypes[1] = midi::ProgramChange;
-	_availableMessageTypes[2] = midi::InvalidType; 
+	_availableMessageTypes[2] = MIDIMessage::NRPN;
+	_availableMessageTypes[3] = MIDIMessage::RPN;
+	_availableMessageTypes[4] = midi::InvalidType;
 }
 
 /*
@@ -44,8 +46,10 @@ template<class T>
 MIDIPotentiometer<T>::MIDIPotentiometer(uint8_t pin, uint8_t windowSize) : T (pin, windowSize)
 {
 	_availableMessageTypes[0] = midi::ControlChange;
-	_availableMessageTypes[1] = midi::ProgramChange; 
-	_availableMessageTypes[2] = midi::InvalidType;
+	_availableMessageTypes[1] = midi::ProgramChange;
+	_availableMessageTypes[2] = MIDIMessage::NRPN;
+	_availableMessageTypes[3] = MIDIMessage::RPN;
+	_availableMessageTypes[4] = midi::InvalidType;
 }
 
 /*
@@ -62,7 +66,9 @@ MIDIPotentiometer<T>::MIDIPotentiometer(Multiplexer * mux, uint8_t channel, uint
 
 	_availableMessageTypes[0] = midi::ControlChange;
 	_availableMessageTypes[1] = midi::ProgramChange;
-	_availableMessageTypes[2] = midi::InvalidType; 
+	_availableMessageTypes[2] = MIDIMessage::NRPN;
+	_availableMessageTypes[3] = MIDIMessage::RPN;
+	_availableMessageTypes[4] = midi::InvalidType;
 }
 
 /*
@@ -75,8 +81,10 @@ template<class T>
 MIDIPotentiometer<T>::MIDIPotentiometer(Multiplexer * mux, uint8_t channel, uint8_t windowSize) : T (mux, channel, windowSize)
 {
 	_availableMessageTypes[0] = midi::ControlChange;
-	_availableMessageTypes[1] = midi::ProgramChange; 
-	_availableMessageTypes[2] = midi::InvalidType;
+	_availableMessageTypes[1] = midi::ProgramChange;
+	_availableMessageTypes[2] = MIDIMessage::NRPN;
+	_availableMessageTypes[3] = MIDIMessage::RPN;
+	_availableMessageTypes[4] = midi::InvalidType;
 }
 
 /*
@@ -95,7 +103,12 @@ MIDIMessage * MIDIPotentiometer<T>::getMessageToSend()
 
 			case midi::ControlChange:
 				_midiMessages[ACTION_MESSAGE].setDataByte2(map(this->getSmoothValue(), 0, 1022, 0, 127));
-			break;			
+			break;
+
+			case MIDIMessage::NRPN:
+			case MIDIMessage::RPN:
+				_midiMessages[ACTION_MESSAGE].setValue(min(map(this->getSmoothValue(), 0, 1023, 0, 16383), 16383));
+			break;
 		}      
 		
 		return &(_midiMessages[ACTION_MESSAGE]);                
@@ -22,18 +22,19 @@
 #include <MIDIUtils.h>
 #include <avr/pgmspace.h>
 
-// Musical modes intervals
-const uint8_t intervals [9][7] PROGMEM = {
-
-    {0, 2, 4, 5, 7, 9, 11}, // Ionian
-    {0, 2, 3, 5, 7, 9, 10}, // Dorian
-    {0, 1, 3, 5, 7, 8, 10}, // Phrygian
-    {0, 2, 4, 6, 7, 8, 10}, // Lydian
-    {0, 2, 4, 5, 7, 9, 10}, // Mixolydian
-    {0, 2, 3, 5, 7, 8, 10}, // Aeolian
-    {0, 1, 3, 5, 6, 8, 10}, // Locrian
-    {0, 2, 3, 4, 7, 9, 0},  // Major Blues
-    {0, 3, 5, 6, 7, 10, 0}  // Minor Blues
+// Musical modes as 12 bit masks. Bit n is set when the interval of n semitones from the root note belongs to the mode
+const uint16_t scaleMasks [10] PROGMEM = {
+
+    0xAB5, // Ionian:      0, 2, 4, 5, 7, 9, 11
+    0x6AD, // Dorian:      0, 2, 3, 5, 7, 9, 10
+    0x5AB, // Phrygian:    0, 1, 3, 5, 7, 8, 10
+    0x5D5, // Lydian:      0, 2, 4, 6, 7, 8, 10
+    0x6B5, // Mixolydian:  0, 2, 4, 5, 7, 9, 10
+    0x5AD, // Aeolian:     0, 2, 3, 5, 7, 8, 10
+    0x56B, // Locrian:     0, 1, 3, 5, 6, 8, 10
+    0x29D, // Major Blues: 0, 2, 3, 4, 7, 9
+    0x4E9, // Minor Blues: 0, 3, 5, 6, 7, 10
+    0xFFF  // Chromatic
 };
 
 /*
@@ -57,72 +58,36 @@ uint8_t MIDIUtils::getNoteNumber(uint8_t midiNote)
 }
 
 /*
-* Return the note name of a note
+* Return the note name of a note. The name is stored in PROGMEM, so it can be printed or copied without any buffer
 * midiNote: note which name will be returned
 */
-char *  MIDIUtils::getNoteName(uint8_t midiNote)
+const __FlashStringHelper *MIDIUtils::getNoteName(uint8_t midiNote)
 {
-    char buffer [4];
+    return getString(NOTE_C + getNoteNumber(midiNote));
+}
 
-    //Get note number (0-11) 
-    uint8_t note = getNoteNumber(midiNote);
-    
-    //Use a switch statement to determine note name. This could also
-    //be done with a series of "if" statements. 
-    switch(note)
+/*
+* Return the notes of a scale as a 12 bit mask. Bit n is set when the note n (C = 0, Db = 1,...) belongs to the scale
+* rootNote: is the key of the scale
+* mode: musical mode of the scale
+*
+* EXAMPLE: how to generate G Aeolian scale
+* rootNote = 7
+* mode = Aeolian -> 0x5AD (0, 2, 3, 5, 7, 8, 10)
+* resulting mask = mode mask rotated 7 bits to the left -> 0x6AD (7, 9, 10, 0, 2, 3, 5)
+*/
+uint16_t MIDIUtils::getScaleMask(uint8_t rootNote, uint8_t mode)
+{
+    if (mode > Chromatic)
     {
-      //Note: each case returns so break keyword is not needed here
-       case C:   
-        getMessage(NOTE_C, buffer); 
-        break;    
-       
-       case Db:  
-        getMessage(NOTE_Db, buffer); 
-        break;
-
-       case D:   
-        getMessage(NOTE_D, buffer); 
-        break; 
-       
-       case Eb:  
-        getMessage(NOTE_Eb, buffer); 
-        break;
-
-       case E:
-        getMessage(NOTE_E, buffer); 
-        break;
-
-       case F:   
-        getMessage(NOTE_F, buffer); 
-        break; 
-       
-       case Gb: 
-        getMessage(NOTE_Gb, buffer); 
-        break;
-
-       case G:  
-        getMessage(NOTE_G, buffer); 
-        break;
-
-       case Ab:  
-        getMessage(NOTE_Ab, buffer); 
-        break;
+        mode = Chromatic;
+    }
 
-       case A:   
-        getMessage(NOTE_A, buffer); 
-        break;
+    uint16_t mask = pgm_read_word(&(scaleMasks[mode]));
 
-       case Bb:  
-        getMessage(NOTE_Bb, buffer); 
-        break;  
-       
-       case B:  
-        getMessage(NOTE_B, buffer); 
-        break;
+    rootNote = getNoteNumber(rootNote);
 
-       default:  
-        getMessage(ERROR, buffer);                 
-    }
+    return ((mask << rootNote) | (mask >> (12 - rootNote))) & 0xFFF;
 }
 
 /*
@@ -130,96 +95,31 @@ char *  MIDIUtils::getNoteName(uint8_t midiNote)
 * midiNote: note to determine if belongs to a scale
 * rootNote: is the key of the scale
 * mode: musical mode of the scale
-*
-* EXAMPLE: how to generate G Aeolian scale
-* rootNote = 7
-* mode = Aeolian
-* resulting scale = ((7+0)%12, (7+2)%12, (7+3)%12, (7+5)%12, (7+7)%12, (7+8)%12, (7+10)%12) -> (7, 9, 10, 0, 2, 3, 5) 
 */
 uint8_t MIDIUtils::isNoteInScale(uint8_t midiNote, uint8_t rootNote, uint8_t mode)
 {
-    if (mode == Chromatic)
-    {
-        return 1;
-    }        
-
-    for (int i=0; i<7; i++)
-    {
-        if ( (rootNote + pgm_read_byte (&(intervals[mode][i]))) % 12 == midiNote % 12 )
-        {
-            return 1;
-        }
-    }
-
-    return 0;
+    return bitRead(getScaleMask(rootNote, mode), getNoteNumber(midiNote));
 }
 
 /*
-* Return the name of a musical mode
+* Return the name of a musical mode. The name is stored in PROGMEM, so it can be printed or copied without any buffer
 * mode: mode number which name will be returned
 */
-char * MIDIUtils::getModeName(uint8_t mode)
+const __FlashStringHelper *MIDIUtils::getModeName(uint8_t mode)
 {
-    char buffer [12];
-
-    //Use a switch statement to determine mode name. 
-    switch(mode)
+    if (mode > Chromatic)
     {
-      //Note: each case returns so break keyword is not needed here
-     
-       case Ionian:     
-        getMessage(IONINAN, buffer); 
-        break;
-
-       case Dorian:     
-        getMessage(DORIAN, buffer); 
-        break;
-
-       case Phrygian:   
-        getMessage(PHRYGIAN, buffer); 
-        break;
-
-       case Lydian:     
-        getMessage(LYDIAN, buffer); 
-        break;
-
-       case Mixolydian: 
-        getMessage(MIXOLYDIAN, buffer); 
-        break;
-
-       case Aeolian:    
-        getMessage(AEOLIAN, buffer); 
-        break;
-
-       case Locrian:    
-        getMessage(LOCRIAN, buffer); 
-        break;
-
-       case Maj_Blues:  
-        getMessage(MAJBLUES, buffer);
-        break; 
-       
-       case Min_Blues:  
-        getMessage(MINBLUES, buffer); 
-        break;
-
-       case Chromatic:  
-        getMessage(CHROMATIC, buffer); 
-        break;
-
-       default:         
-        getMessage(ERROR, buffer);    
+        return getString(ERROR);
     }
 
-    return buffer;
+    return getString(mode);
 }
 
 /*
-* Load a string of chars from the PROGMEM
-* msgIndex: text to Load
-* buffer: array of chars where the text will be loaded
+* Return a string stored in PROGMEM
+* msgIndex: text to return
 */
-void MIDIUtils::getMessage(uint8_t msgIndex, char * buffer)
+const __FlashStringHelper *MIDIUtils::getString(uint8_t msgIndex)
 {
-    strcpy_P(buffer, (char*)pgm_read_word(&(midiStrings[msgIndex])));    
-}
\ No newline at end of file
+    return (const __FlashStringHelper *)pgm_read_word(&(midiStrings[msgIndex]));
+}
@@ -92,11 +92,12 @@ class MIDIUtils
 
     static int8_t getOctave(uint8_t midiNote);
     static uint8_t getNoteNumber(uint8_t midiNote);
-    static char * getNoteName(uint8_t midiNote);
+    static const __FlashStringHelper *getNoteName(uint8_t midiNote);
+    static uint16_t getScaleMask(uint8_t rootNote, uint8_t mode);
     static uint8_t isNoteInScale(uint8_t midiNote, uint8_t rootNote, uint8_t mode);     
-    static char * getModeName(uint8_t mode);    
+    static const __FlashStringHelper *getModeName(uint8_t mode);
 
   private:
-    static void getMessage(uint8_t msgIndex, char * buffer);
+    static const __FlashStringHelper *getString(uint8_t msgIndex);
 };
 #endif
\ No newline at end of file
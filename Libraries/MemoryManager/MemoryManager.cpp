@@ -21,12 +21,13 @@
 #include "MemoryManager.h"
 
 /*
-* Initializes the memory manager regarding the number of MIDI components that will be managed
+* Initializes the memory manager regarding the number of MIDI components that will be managed.
+* An EEPROM written by a previous firmware, without the format marker, is migrated to the current format
 * Return: 0 if the total components size don't fit into the EEPROM, 1 otherwise
 * midiComponents: list of the MIDI components that will be managed
 * numMIDIComponents: number of MIDI components
-* sequenceLength: number of steps in a sequence
-* stepSize: size of each step on a sequence
+* sequenceLength: default number of steps in a sequence
+* stepSize: size of each stored step on a sequence
 * globalConfigSize: size of the controller global configuration
 */
 uint8_t MemoryManager::initialize(IMIDIComponent ** midiComponents, uint8_t numMIDIComponents, uint8_t sequenceLength, uint8_t stepSize, uint8_t globalConfigSize)
@@ -37,31 +38,74 @@ uint8_t MemoryManager::initialize(IMIDIComponent ** midiComponents, uint8_t numM
         _pageSize += midiComponents[i]->getDataSize();
     }
 	
-	// calculate the sequence size in bytes in EEPROM
-	_sequenceSize = sequenceLength * stepSize;
+	// calculate the size in bytes in EEPROM of a sequence of the default length with all its steps enabled
+	_sequenceSize = sizeof(uint8_t) + (2 * getBitmapSize(sequenceLength)) + (sequenceLength * stepSize);
+	_sequenceLength = sequenceLength;
 	
 	_globalConfigSize = globalConfigSize;		
 
     // calculate the total size of data in bytes that will be stored into EEPROM and check if it fits
-	if (((_pageSize * NUM_PAGES) + (_sequenceSize * NUM_SEQUENCES) + globalConfigSize) > MEMORY_SIZE)
+	if (((_pageSize * NUM_PAGES) + (_sequenceSize * NUM_SEQUENCES) + globalConfigSize + FORMAT_SIZE + CHAIN_SIZE) > MEMORY_SIZE)
 	{
 		return 0;
 	}
+
+	if (EEPROM.read(_globalConfigSize) != MEMORY_FORMAT)
+	{
+		formatMemory();
+	}
 	
 	return 1;    
 }
 
+/*
+* Migrate an EEPROM without the format marker to the current format. The global configuration is kept, the pages
+* are moved after the format marker and the sequences and the song chain are cleared, as the fixed size sequences
+* of the previous format cannot be told apart from the variable size records.
+* It takes about one second, as every byte of the pages is written again
+*/
+void MemoryManager::formatMemory()
+{
+    uint16_t pagesAddress = _globalConfigSize + FORMAT_SIZE;
+    uint16_t sequencesAddress = pagesAddress + (_pageSize * NUM_PAGES);
+
+    acquireBus();
+
+    // move the pages one byte up, starting by the last byte
+    for (uint16_t i = sequencesAddress - 1; i >= pagesAddress; i--)
+    {
+        EEPROM.update(i, EEPROM.read(i - FORMAT_SIZE));
+    }
+
+    // a record with a wrong length takes only its length byte, so every sequence is loaded with the default length
+    for (uint8_t i = 0; i < NUM_SEQUENCES; i++)
+    {
+        EEPROM.update(sequencesAddress + i, 0);
+    }
+
+    // the song chain has no entries
+    EEPROM.update(SEQUENCES_END, 0);
+
+    EEPROM.update(_globalConfigSize, MEMORY_FORMAT);
+
+    releaseBus();
+}
+
 /*
 * Load the global configuration parameters from EEPROM
 * globalConfig: object in which the configuration will be loaded
 */
 void MemoryManager::loadGlobalConfiguration(GlobalConfig * globalConfig)
 {
+    acquireBus();
+
     globalConfig->setMIDIChannel(EEPROM.read(0));
 	globalConfig->setSequencerMIDIChannel(EEPROM.read(1));
     globalConfig->setMode(EEPROM.read(2));
     globalConfig->setRootNote(EEPROM.read(3));    
     globalConfig->setSendClockWhilePlayback(EEPROM.read(4));
+
+    releaseBus();
 }
 
 /*
@@ -70,11 +114,49 @@ void MemoryManager::loadGlobalConfiguration(GlobalConfig * globalConfig)
 */
 void MemoryManager::saveGlobalConfiguration(GlobalConfig globalConfig)
 {
+    acquireBus();
+
     EEPROM.update(0, globalConfig.getMIDIChannel());
 	EEPROM.update(1, globalConfig.getSequencerMIDIChannel());
     EEPROM.update(2, globalConfig.getMode());
     EEPROM.update(3, globalConfig.getRootNote());
     EEPROM.update(4, globalConfig.getSendClockWhilePlayback());  
+
+    releaseBus();
+}
+
+/*
+* Load the song chain from EEPROM. The chain ends at its first entry with a wrong sequence number or repeat count
+* Return: number of entries of the chain
+* sequences: array of CHAIN_LENGTH elements in which the sequence number of each entry will be loaded
+* repeats: array of CHAIN_LENGTH elements in which the times each entry is played will be loaded
+*/
+uint8_t MemoryManager::loadChain(uint8_t * sequences, uint8_t * repeats)
+{
+    uint16_t address = SEQUENCES_END;
+    uint8_t i;
+
+    acquireBus();
+
+    uint8_t chainLength = min(EEPROM.read(address), CHAIN_LENGTH);
+    address += sizeof(uint8_t);
+
+    for (i = 0; i < chainLength; i++)
+    {
+        sequences[i] = EEPROM.read(address);
+        address += sizeof(uint8_t);
+        repeats[i] = EEPROM.read(address);
+        address += sizeof(uint8_t);
+
+        if ((sequences[i] == 0) || (sequences[i] > NUM_SEQUENCES) || (repeats[i] == 0))
+        {
+            break;
+        }
+    }
+
+    releaseBus();
+
+    return i;
 }
 
 /*
@@ -86,18 +168,22 @@ void MemoryManager::saveGlobalConfiguration(GlobalConfig globalConfig)
 void MemoryManager::saveMIDIComponents(uint8_t page, IMIDIComponent ** midiComponents, uint8_t numMIDIComponents)
 {
     //get the begin address of the page
-    uint16_t address = _globalConfigSize;
+    uint16_t address = _globalConfigSize + FORMAT_SIZE;
     
     if (page > 1)
     {
         address += _pageSize * (page-1); 
     }
 
+    acquireBus();
+
     // save the MIDI messages assigned to each MIDI component into the EEPROM
     for (uint8_t i = 0; i < numMIDIComponents; i++)
     {
         saveMIDIComponent(&address, midiComponents[i]);        
     }
+
+    releaseBus();
 }
 
 /*
@@ -129,41 +215,116 @@ void MemoryManager::saveMIDIMessage(uint16_t * address, MIDIMessage message)
 }
 
 /*
-* Saves the steps within a sequence into the EEPROM
+* Saves the steps within a sequence into the EEPROM.
+* Sequences are stored one after the other as variable size records: the sequence length, a bitmap with one bit
+* per step set when the step is enabled, a bitmap with one bit per step set when the step has velocity, probability
+* or ratchets different from the default ones and the data of the enabled steps only. The records that follow the
+* saved one are moved when its size changes.
+* Return: 0 if the sequence does not fit into the EEPROM, 1 otherwise
 * numSequence: sequence number that will be stored
 * sequence: list of the steps that will be stored
 * sequenceLength: number of steps that will be stored
 */
-void MemoryManager::saveSequence(uint8_t numSequence, Step * sequence, uint8_t sequenceLength)
+uint8_t MemoryManager::saveSequence(uint8_t numSequence, Step * sequence, uint8_t sequenceLength)
 {
-    //calculate the start address of the sequence
-    uint16_t address = _globalConfigSize + (_pageSize * NUM_PAGES);
-    
-    if (numSequence > 1)
+    acquireBus();
+
+    uint16_t address = getSequenceAddress(numSequence);
+    uint16_t endAddress = getSequenceAddress(NUM_SEQUENCES + 1);
+    uint16_t oldSize = getSequenceRecordSize(address);
+    uint16_t newSize = sizeof(uint8_t) + (2 * getBitmapSize(sequenceLength));
+
+    for (uint8_t i = 0; i < sequenceLength; i++)
+    {
+        if (sequence[i].isEnabled())
+        {
+            newSize += Step::getSize() + (sequence[i].hasDefaultParameters() ? 0 : 2 * sizeof(uint8_t));
+        }
+    }
+
+    // check if the sequences fit into the EEPROM with the new record size
+    uint16_t newEndAddress = endAddress - oldSize + newSize;
+
+    if (newEndAddress > SEQUENCES_END)
     {
-        address += _sequenceSize * (numSequence-1); 
+        releaseBus();
+        return 0;
     }
 
-    // save the steps of the sequence into the EEPROM
+    // move the following sequences to make room for a bigger record, starting by the last byte
+    if (newSize > oldSize)
+    {
+        for (uint16_t i = endAddress; i > address + oldSize; i--)
+        {
+            EEPROM.update(i - 1 + (newSize - oldSize), EEPROM.read(i - 1));
+        }
+    }
+
+    // move the following sequences next to a smaller record, starting by the first byte
+    else if (newSize < oldSize)
+    {
+        for (uint16_t i = address + oldSize; i < endAddress; i++)
+        {
+            EEPROM.update(i - (oldSize - newSize), EEPROM.read(i));
+        }
+    }
+
+    // save the sequence length, the enabled steps bitmap and the stored parameters bitmap
+    EEPROM.update(address, sequenceLength);
+    address += sizeof(uint8_t);
+
+    for (uint8_t i = 0; i < getBitmapSize(sequenceLength); i++)
+    {
+        uint8_t enabledBitmap = 0;
+        uint8_t parametersBitmap = 0;
+
+        for (uint8_t j = 0; (j < 8) && ((i * 8) + j < sequenceLength); j++)
+        {
+            Step step = sequence[(i * 8) + j];
+
+            bitWrite(enabledBitmap, j, step.isEnabled() ? 1 : 0);
+            bitWrite(parametersBitmap, j, (step.isEnabled() && !step.hasDefaultParameters()) ? 1 : 0);
+        }
+
+        EEPROM.update(address, enabledBitmap);
+        EEPROM.update(address + getBitmapSize(sequenceLength), parametersBitmap);
+        address += sizeof(uint8_t);
+    }
+
+    address += getBitmapSize(sequenceLength);
+
+    // save the enabled steps of the sequence into the EEPROM
     for (uint8_t i = 0; i < sequenceLength; i++)
     {
-        saveStep(&address, sequence[i]);        
+        if (sequence[i].isEnabled())
+        {
+            saveStep(&address, sequence[i]);
+        }
     }
+
+    releaseBus();
+
+    return 1;
 }
 
 /*
-* Saves a step of a sequence into the EEPROM
+* Saves an enabled step of a sequence into the EEPROM, followed by its velocity, probability and ratchets
+* when they are not the default ones
 * address: start addres of the EEPROM where the step will be stored.
 * step: the step that will be stored
 */
 void MemoryManager::saveStep(uint16_t * address, Step step)
 {
-    EEPROM.update((*address),step.getNote());
+    EEPROM.update((*address), (step.getNote() & 0x7F) | (step.isLegato() ? 0x80 : 0));
     (*address) += sizeof(uint8_t);
-    EEPROM.update((*address),step.isEnabled());
-    (*address) += sizeof(uint8_t);
-    EEPROM.update((*address),step.isLegato());
-    (*address) += sizeof(uint8_t);    
+
+    if (!step.hasDefaultParameters())
+    {
+        EEPROM.update((*address), step.getVelocity());
+        (*address) += sizeof(uint8_t);
+        EEPROM.update((*address), step.getProbability() | ((step.getRatchets() - 1) << 4));
+        (*address) += sizeof(uint8_t);
+    }
 }
 
 /*
@@ -175,18 +336,22 @@ void MemoryManager::saveStep(uint16_t * address, Step step)
 void MemoryManager::loadMIDIComponents(uint8_t page, IMIDIComponent ** midiComponents, uint8_t numMIDIComponents)
 {
     //get the begin address of the page
-    uint16_t address = _globalConfigSize;
+    uint16_t address = _globalConfigSize + FORMAT_SIZE;
     
     if (page > 1)
     {
         address += _pageSize * (page-1); 
     }
 
+    acquireBus();
+
     // save the MIDI messages assigned to each MIDI component into the EEPROM
     for (uint8_t i = 0; i < numMIDIComponents; i++)
     {
         loadMIDIComponent(&address, midiComponents[i]);        
     }
+
+    releaseBus();
 }
 
 /*
@@ -219,38 +384,185 @@ void MemoryManager::loadMIDIMessage(uint16_t * address, MIDIMessage * message)
 
 /*
 * Load the steps data into a sequence
+* Return: number of steps loaded
 * numSequence: sequence number that will be loaded
 * sequence: sequence that will be loaded with the steps data
-* sequenceLength: number of steps that will be loaded
+* maxLength: maximum number of steps that can be loaded
 */
-void MemoryManager::loadSequence(uint8_t numSequence, Step * sequence, uint8_t sequenceLength)
+uint8_t MemoryManager::loadSequence(uint8_t numSequence, Step * sequence, uint8_t maxLength)
 {
-    //get the begin address of the sequence
-    uint16_t address = _globalConfigSize + (_pageSize * NUM_PAGES);
-    
-    if (numSequence > 1)
+    uint8_t sequenceLength = beginSequenceLoad(numSequence, maxLength);
+
+    loadSequenceSteps(sequence, sequenceLength);
+
+    return sequenceLength;
+}
+
+/*
+* Start the load of a sequence whose steps will be decoded later with loadSequenceSteps().
+* A sequence that has never been stored is loaded with the default length and all its steps disabled.
+* Return: number of steps of the sequence, limited to maxLength
+* numSequence: sequence number that will be loaded
+* maxLength: maximum number of steps that can be loaded
+*/
+uint8_t MemoryManager::beginSequenceLoad(uint8_t numSequence, uint8_t maxLength)
+{
+    acquireBus();
+
+    uint16_t address = getSequenceAddress(numSequence);
+
+    _loadLength = (address < SEQUENCES_END) ? EEPROM.read(address) : 0;
+    _loadStep = 0;
+
+    if (!isSequenceLengthValid(_loadLength))
     {
-        address += _sequenceSize * (numSequence-1); 
+        _loadLength = 0;
     }
-  
-    // load the steps into the sequence
-    for (uint8_t i = 0; i < sequenceLength; i++)
-    {      
-        loadStep(&address, &(sequence[i]));        
+
+    _loadBitmapAddress = address + sizeof(uint8_t);
+    _loadParametersAddress = _loadBitmapAddress + getBitmapSize(_loadLength);
+    _loadStepAddress = _loadParametersAddress + getBitmapSize(_loadLength);
+
+    releaseBus();
+
+    return min(_loadLength ? _loadLength : _sequenceLength, maxLength);
+}
+
+/*
+* Decode the next steps of the sequence whose load was started with beginSequenceLoad()
+* steps: steps that will be loaded with the decoded data
+* numSteps: number of steps to decode
+*/
+void MemoryManager::loadSequenceSteps(Step * steps, uint8_t numSteps)
+{
+    acquireBus();
+
+    for (uint8_t i = 0; i < numSteps; i++, _loadStep++)
+    {
+        if ((_loadStep < _loadLength) && (_loadStepAddress < SEQUENCES_END) && bitRead(EEPROM.read(_loadBitmapAddress + (_loadStep / 8)), _loadStep % 8))
+        {
+            loadStep(&_loadStepAddress, &(steps[i]), bitRead(EEPROM.read(_loadParametersAddress + (_loadStep / 8)), _loadStep % 8));
+        }
+
+        else
+        {
+            steps[i] = Step(Step::DEFAULT_NOTE, 0, 0);
+        }
     }
+
+    releaseBus();
 }
 
 /*
-* Load a step from the EEPROM
+* Load an enabled step from the EEPROM
 * address: start addres of the EEPROM where the step is stored.
 * step: the step that will be loaded with the data from the EEPROM
+* hasParameters: 1 if the velocity, probability and ratchets of the step are stored after its note, 0 otherwise
 */
-void MemoryManager::loadStep(uint16_t * address, Step * step)
+void MemoryManager::loadStep(uint16_t * address, Step * step, uint8_t hasParameters)
 {
-    step->setNote(EEPROM.read((*address)));
-    (*address) += sizeof(uint8_t);
-    step->setEnabled(EEPROM.read((*address)));
+    uint8_t data = EEPROM.read((*address));
+
+    (*step) = Step(data & 0x7F, 1, data & 0x80 ? 1 : 0);
     (*address) += sizeof(uint8_t);
-    step->setLegato(EEPROM.read((*address)));
-    (*address) += sizeof(uint8_t);   
-}
\ No newline at end of file
+
+    if (hasParameters)
+    {
+        step->setVelocity(EEPROM.read((*address)));
+        (*address) += sizeof(uint8_t);
+
+        data = EEPROM.read((*address));
+        step->setProbability(data & 0x0F);
+        step->setRatchets(((data >> 4) & 0x03) + 1);
+        (*address) += sizeof(uint8_t);
+    }
+}
+
+/*
+* Returns the EEPROM address of a sequence record, walking through the records stored before it.
+* NUM_SEQUENCES + 1 returns the address where the last record ends
+* numSequence: the sequence number
+*/
+uint16_t MemoryManager::getSequenceAddress(uint8_t numSequence)
+{
+    uint16_t address = _globalConfigSize + FORMAT_SIZE + (_pageSize * NUM_PAGES);
+
+    for (uint8_t i = 1; (i < numSequence) && (address < SEQUENCES_END); i++)
+    {
+        address += getSequenceRecordSize(address);
+    }
+
+    return min(address, SEQUENCES_END);
+}
+
+/*
+* Returns the size in bytes of a sequence record. A record with a wrong length takes only its length byte
+* address: start address of the record
+*/
+uint16_t MemoryManager::getSequenceRecordSize(uint16_t address)
+{
+    if (address >= SEQUENCES_END)
+    {
+        return 0;
+    }
+
+    uint8_t sequenceLength = EEPROM.read(address);
+    uint16_t size = sizeof(uint8_t);
+
+    if (!isSequenceLengthValid(sequenceLength))
+    {
+        return size;
+    }
+
+    // every enabled step within the bitmap has its data stored after the bitmaps, followed by its parameters if they are stored
+    for (uint8_t i = 0; i < getBitmapSize(sequenceLength); i++)
+    {
+        size += 2 * sizeof(uint8_t);
+        size += __builtin_popcount(EEPROM.read(address + sizeof(uint8_t) + i)) * Step::getSize();
+        size += __builtin_popcount(EEPROM.read(address + sizeof(uint8_t) + getBitmapSize(sequenceLength) + i)) * 2 * sizeof(uint8_t);
+    }
+
+    return size;
+}
+
+/*
+* Returns the number of bytes of the enabled steps bitmap of a sequence
+* sequenceLength: number of steps of the sequence
+*/
+uint8_t MemoryManager::getBitmapSize(uint8_t sequenceLength)
+{
+    return (sequenceLength + 7) / 8;
+}
+
+/*
+* Returns 1 if a stored sequence length is valid, 0 otherwise
+* sequenceLength: the stored length
+*/
+uint8_t MemoryManager::isSequenceLengthValid(uint8_t sequenceLength)
+{
+    return (sequenceLength > 0) && (sequenceLength <= MAX_SEQUENCE_LENGTH);
+}
+
+/*
+* Ask for the I2C bus before a memory transaction. The internal EEPROM is not on the bus, so the bus is only used
+* when the memory is an external I2C EEPROM. The memory transactions have the highest priority, so the bus is always
+* granted to them
+*/
+void MemoryManager::acquireBus()
+{
+    if (MEMORY_ON_I2C)
+    {
+        I2CBus.acquire(I2CBusManager::MEMORY_CLIENT, I2CBusManager::LOAD_PRIORITY);
+    }
+}
+
+/*
+* End a memory transaction on the I2C bus
+*/
+void MemoryManager::releaseBus()
+{
+    if (MEMORY_ON_I2C)
+    {
+        I2CBus.release();
+    }
+}
@@ -25,30 +25,52 @@
 #include <GlobalConfig.h>
 #include <ControllerConfig.h>
 #include <Step.h>
+#include <I2CBusManager.h>
 
 #define MEMORY_SIZE 1024
+#define CHAIN_SIZE (sizeof(uint8_t) + (2 * CHAIN_LENGTH))  // song chain stored at the end of the EEPROM: number of entries, then sequence and repeats of each entry
+#define SEQUENCES_END (MEMORY_SIZE - CHAIN_SIZE)         // address where the area of the sequence records ends
+#define FORMAT_SIZE sizeof(uint8_t)                      // format marker stored right after the global configuration
+#define MEMORY_FORMAT 0x5A                               // format marker of the EEPROM layout with variable size sequence records
 
 class MemoryManager
 {
   public:   
     uint8_t initialize(IMIDIComponent ** midiComponents, uint8_t numMIDIComponents, uint8_t sequenceLength, uint8_t stepSize, uint8_t globalConfigSize);
     void saveMIDIComponents(uint8_t page, IMIDIComponent ** midiComponents, uint8_t numMIDIComponents);
-	void saveSequence(uint8_t numSequence, Step * sequence, uint8_t sequenceLength);
+	uint8_t saveSequence(uint8_t numSequence, Step * sequence, uint8_t sequenceLength);
     void loadMIDIComponents(uint8_t page, IMIDIComponent ** midiComponents, uint8_t numMIDIComponents);
-	void loadSequence(uint8_t numSequence, Step * sequence, uint8_t sequenceLength);
+	uint8_t loadSequence(uint8_t numSequence, Step * sequence, uint8_t maxLength);
+	uint8_t beginSequenceLoad(uint8_t numSequence, uint8_t maxLength);
+	void loadSequenceSteps(Step * steps, uint8_t numSteps);
     void loadGlobalConfiguration(GlobalConfig * globalConfig);
     void saveGlobalConfiguration(GlobalConfig globalConfig);
+	uint8_t loadChain(uint8_t * sequences, uint8_t * repeats);
 
   private:
     uint8_t _pageSize;        // size of a MIDI messages page regarding the number of MIDI components 
-	uint8_t _sequenceSize; // size of a sequence regarding the nimber of steps
+	uint8_t _sequenceSize; // size of a sequence of the default length with all its steps enabled
+	uint8_t _sequenceLength; // number of steps of a sequence that has never been stored
 	uint8_t _globalConfigSize;	// size of the global configuration object
 
+	uint8_t _loadLength;          // number of steps of the sequence record being loaded. 0 if the record is not valid
+	uint8_t _loadStep;            // next step to be loaded from the sequence record
+	uint16_t _loadBitmapAddress;  // address of the enabled steps bitmap of the sequence record being loaded
+	uint16_t _loadParametersAddress; // address of the stored parameters bitmap of the sequence record being loaded
+	uint16_t _loadStepAddress;    // address of the next stored step of the sequence record being loaded
+
     void saveMIDIComponent(uint16_t * address , IMIDIComponent * midiComponent);
     void saveMIDIMessage(uint16_t * address, MIDIMessage message); 
 	void saveStep(uint16_t * address, Step step);
     void loadMIDIComponent(uint16_t * address , IMIDIComponent * midiComponent);
     void loadMIDIMessage(uint16_t * address, MIDIMessage * message); 
-	void loadStep(uint16_t * address, Step * step);
+	void loadStep(uint16_t * address, Step * step, uint8_t hasParameters);
+	uint16_t getSequenceAddress(uint8_t numSequence);
+	uint16_t getSequenceRecordSize(uint16_t address);
+	uint8_t getBitmapSize(uint8_t sequenceLength);
+	uint8_t isSequenceLengthValid(uint8_t sequenceLength);
+	void formatMemory();
+	void acquireBus();
+	void releaseBus();
 };
 #endif
\ No newline at end of file
@@ -19,11 +19,8 @@
  */
 #include "MidiWorker.h"
 
-MidiWorker::MidiWorker()
-{}
-
-MidiWorker::MidiWorker(MidiInterface& inInterface)
-: _mMidi(inInterface)
+MidiWorker::MidiWorker(MidiInterface& inInterface, HardwareSerial& serial)
+: _mMidi(inInterface), _serial(serial)
 {}
 
 /*
@@ -32,6 +29,52 @@ MidiWorker::MidiWorker(MidiInterface& inInterface)
 void MidiWorker::begin()
 {
     _mMidi.begin();
+
+    _useRunningStatus = MIDI_RUNNING_STATUS;
+    _runningStatus = 0;
+    _lastStatusSentTime = 0;
+
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        _currentParameter[i] = NO_PARAMETER;
+        _currentDataEntryMSB[i] = NO_DATA_ENTRY;
+    }
+
+    for (uint8_t i = 0; i < ACTIVE_NOTES_MAPS; i++)
+    {
+        clearActiveNotesMap(i);
+    }
+
+    _untrackedChannels = 0;
+}
+
+/*
+* Enable or disable running status on the MIDI output
+* enabled: TRUE for omitting repeated status bytes, FALSE for sending the status byte with every message
+*/
+void MidiWorker::setRunningStatus(uint8_t enabled)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        _useRunningStatus = enabled;
+        _runningStatus = 0;
+    }
+}
+
+/*
+* Send a System Exclusive message. The next channel message will send its status byte again.
+* The message is longer than the serial buffer, so it is written with the interrupts enabled
+* length: number of bytes of the message, without the 0xF0 and 0xF7 bytes
+* data: the System Exclusive message data
+*/
+void MidiWorker::sendSysEx(uint8_t length, const uint8_t * data)
+{
+    _mMidi.sendSysEx(length, data, false);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        _runningStatus = 0;
+    }
 }
 
 /*
@@ -44,19 +87,30 @@ void MidiWorker::sendMIDIMessage(MIDIMessage * message, uint8_t channel)
     switch(message->getType())
     {
         case midi::ControlChange:
-           _mMidi.sendControlChange(message->getDataByte1(), message->getDataByte2(), channel);
+           invalidateParameterCache(message->getDataByte1(), channel);
+           sendChannelMessage(midi::ControlChange, message->getDataByte1(), message->getDataByte2(), channel);
+        break;
+
+        case MIDIMessage::NRPN:
+           sendParameterNumber(((uint16_t)message->getDataByte1() << 7) | message->getDataByte2(), channel);
+           sendParameterValue(message->getValue(), channel);
+        break;
+
+        case MIDIMessage::RPN:
+           sendParameterNumber(RPN_PARAMETER | ((uint16_t)message->getDataByte1() << 7) | message->getDataByte2(), channel);
+           sendParameterValue(message->getValue(), channel);
         break;
 
         case midi::ProgramChange:
-           _mMidi.sendProgramChange(message->getDataByte1(), channel);
+           sendChannelMessage(midi::ProgramChange, message->getDataByte1(), 0, channel);
         break;
 
         case midi::NoteOn:
-           _mMidi.sendNoteOn(message->getDataByte1(), message->getDataByte2(), channel);
+           sendChannelMessage(midi::NoteOn, message->getDataByte1(), message->getDataByte2(), channel);
         break;
 
         case midi::NoteOff:
-           _mMidi.sendNoteOff(message->getDataByte1(), message->getDataByte2(), channel);
+           sendChannelMessage(midi::NoteOff, message->getDataByte1(), message->getDataByte2(), channel);
         break;
 
         case midi::InvalidType:        
@@ -64,6 +118,218 @@ void MidiWorker::sendMIDIMessage(MIDIMessage * message, uint8_t channel)
     }
 }
 
+/*
+* Send a block of pre-rendered channel messages. Used by the sequencer to send a step from the Timer1 interrupt
+* without building MIDIMessage objects.
+* data: complete three byte channel messages (status, data1, data2) one after the other
+* length: number of bytes within data
+*/
+void MidiWorker::sendChannelMessages(const uint8_t * data, uint8_t length)
+{
+    for (uint8_t i = 0; i < length; i += 3)
+    {
+        sendChannelMessage(data[i] & 0xF0, data[i + 1], data[i + 2], (data[i] & 0x0F) + 1);
+    }
+}
+
+/*
+* Write a channel message to the MIDI output. When running status is enabled the status byte is only
+* written if it differs from the last one sent, or if it was last sent more than RUNNING_STATUS_REFRESH_MS
+* ago so that a receiver that missed it can recover. Real time messages do not cancel the running status.
+* The running status and the writes are atomic because the sequencer sends messages from the Timer1 interrupt.
+* From the main loop the message waits until the serial buffer has room for all its bytes, so the writes never
+* wait for the serial buffer with the interrupts disabled. The Timer1 interrupt cannot wait, its bytes fit in the buffer.
+* type: MIDI message type
+* data1: first data byte
+* data2: second data byte. Not sent for Program Change messages
+* channel: MIDI channel where to send the message
+*/
+void MidiWorker::sendChannelMessage(uint8_t type, uint8_t data1, uint8_t data2, uint8_t channel)
+{
+    uint8_t status = type | ((channel - 1) & 0x0F);
+    uint8_t length = (type == midi::ProgramChange) ? 2 : 3;
+    uint8_t fromInterrupt = bit_is_clear(SREG, SREG_I);
+
+    while (true)
+    {
+        while (!fromInterrupt && _serial.availableForWrite() < length);
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            // the Timer1 interrupt may have filled the buffer since the wait
+            if (fromInterrupt || _serial.availableForWrite() >= length)
+            {
+                if (!_useRunningStatus || _runningStatus != status || (millis() - _lastStatusSentTime) >= RUNNING_STATUS_REFRESH_MS)
+                {
+                    _serial.write(status);
+                    _runningStatus = status;
+                    _lastStatusSentTime = millis();
+                }
+
+                _serial.write(data1 & 0x7F);
+
+                if (type != midi::ProgramChange)
+                {
+                    _serial.write(data2 & 0x7F);
+                }
+
+                updateActiveNotes(status, data1, data2);
+                return;
+            }
+        }
+    }
+}
+
+/*
+* Send a Note Off message for every note that is sounding. Channels whose notes could not be
+* tracked receive an All Notes Off message. Consecutive Note Off messages share the status byte
+* when running status is enabled.
+*/
+void MidiWorker::panic()
+{
+    for (uint8_t map = 0; map < ACTIVE_NOTES_MAPS; map++)
+    {
+        for (uint8_t i = 0; i < 16; i++)
+        {
+            uint8_t channel;
+            uint8_t notes;
+
+            // the Timer1 interrupt may play notes meanwhile, so the map is read again after each message
+            while ((channel = _activeNotesChannel[map]) != 0 && (notes = _activeNotes[map][i]) != 0)
+            {
+                sendChannelMessage(midi::NoteOff, (i << 3) + __builtin_ctz(notes), 0, channel);
+            }
+        }
+    }
+
+    for (uint8_t channel = 0; channel < 16; channel++)
+    {
+        if (bitRead(_untrackedChannels, channel))
+        {
+            sendChannelMessage(midi::ControlChange, midi::AllNotesOff, 0, channel + 1);
+        }
+    }
+}
+
+/*
+* Keep track of the notes that are sounding regarding a channel message that has been sent
+* status: status byte of the message
+* data1: first data byte of the message
+* data2: second data byte of the message
+*/
+void MidiWorker::updateActiveNotes(uint8_t status, uint8_t data1, uint8_t data2)
+{
+    uint8_t type = status & 0xF0;
+    uint8_t channel = (status & 0x0F) + 1;
+    int8_t map;
+
+    switch (type)
+    {
+        case midi::NoteOn:
+
+            if (data2 > 0)
+            {
+                map = getActiveNotesMap(channel);
+
+                // allocate a free map for the channel
+                for (uint8_t i = 0; map < 0 && i < ACTIVE_NOTES_MAPS; i++)
+                {
+                    if (_activeNotesChannel[i] == 0)
+                    {
+                        _activeNotesChannel[i] = channel;
+                        map = i;
+                    }
+                }
+
+                if (map < 0)
+                {
+                    bitSet(_untrackedChannels, channel - 1);
+                }
+
+                else
+                {
+                    bitSet(_activeNotes[map][data1 >> 3], data1 & 0x07);
+                }
+
+                break;
+            }
+
+        // Note On with velocity 0 is a Note Off
+        // fall through
+        case midi::NoteOff:
+
+            map = getActiveNotesMap(channel);
+
+            if (map >= 0)
+            {
+                bitClear(_activeNotes[map][data1 >> 3], data1 & 0x07);
+
+                // free the map when the channel has no sounding notes
+                uint8_t notes = 0;
+
+                for (uint8_t i = 0; i < 16; i++)
+                {
+                    notes |= _activeNotes[map][i];
+                }
+
+                if (notes == 0)
+                {
+                    _activeNotesChannel[map] = 0;
+                }
+            }
+
+            break;
+
+        case midi::ControlChange:
+
+            if (data1 == midi::AllNotesOff)
+            {
+                map = getActiveNotesMap(channel);
+
+                if (map >= 0)
+                {
+                    clearActiveNotesMap(map);
+                }
+
+                bitClear(_untrackedChannels, channel - 1);
+            }
+
+            break;
+    }
+}
+
+/*
+* Return the active notes map assigned to a channel
+* channel: MIDI channel
+* returns the index of the map or -1 when the channel has no map
+*/
+int8_t MidiWorker::getActiveNotesMap(uint8_t channel)
+{
+    for (uint8_t i = 0; i < ACTIVE_NOTES_MAPS; i++)
+    {
+        if (_activeNotesChannel[i] == channel)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*
+* Clear an active notes map and make it available for any channel
+* map: index of the map
+*/
+void MidiWorker::clearActiveNotesMap(uint8_t map)
+{
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        _activeNotes[map][i] = 0;
+    }
+
+    _activeNotesChannel[map] = 0;
+}
+
 /*
 * Send start MIDI clock signal
 */
@@ -86,4 +352,72 @@ void MidiWorker::sendMIDIClock()
 void MidiWorker::sendMIDIStopClock()
 {
     _mMidi.sendRealTime(midi::Stop);
+}
+/*
+* Select a NRPN/RPN parameter on the receiver. The parameter number is only sent when it differs
+* from the one currently selected on the channel, so a pot sweep only sends the Data Entry messages.
+* parameter: 14-bit parameter number. RPN_PARAMETER bit set for RPN parameters.
+* channel: MIDI channel where to send the message
+*/
+void MidiWorker::sendParameterNumber(uint16_t parameter, uint8_t channel)
+{
+    if (_currentParameter[channel - 1] == parameter)
+    {
+        return;
+    }
+
+    uint8_t msbControl = (parameter & RPN_PARAMETER) ? midi::RPNMSB : midi::NRPNMSB;
+    uint8_t lsbControl = (parameter & RPN_PARAMETER) ? midi::RPNLSB : midi::NRPNLSB;
+
+    sendChannelMessage(midi::ControlChange, msbControl, (parameter >> 7) & 0x7F, channel);
+    sendChannelMessage(midi::ControlChange, lsbControl, parameter & 0x7F, channel);
+
+    _currentParameter[channel - 1] = parameter;
+    _currentDataEntryMSB[channel - 1] = NO_DATA_ENTRY;
+}
+
+/*
+* Send the 14-bit value of the currently selected NRPN/RPN parameter. Data Entry MSB is skipped
+* when it did not change since the last value sent on the channel.
+* value: 14-bit value
+* channel: MIDI channel where to send the message
+*/
+void MidiWorker::sendParameterValue(uint16_t value, uint8_t channel)
+{
+    uint8_t msb = (value >> 7) & 0x7F;
+
+    if (_currentDataEntryMSB[channel - 1] != msb)
+    {
+        sendChannelMessage(midi::ControlChange, midi::DataEntryMSB, msb, channel);
+        _currentDataEntryMSB[channel - 1] = msb;
+    }
+
+    sendChannelMessage(midi::ControlChange, midi::DataEntryLSB, value & 0x7F, channel);
+}
+
+/*
+* Forget the NRPN/RPN state of a channel when a plain Control Change message touches the
+* parameter selection or Data Entry controllers.
+* controlNumber: the Control Change number being sent
+* channel: MIDI channel where the message is sent
+*/
+void MidiWorker::invalidateParameterCache(uint8_t controlNumber, uint8_t channel)
+{
+    switch (controlNumber)
+    {
+        case midi::NRPNLSB:
+        case midi::NRPNMSB:
+        case midi::RPNLSB:
+        case midi::RPNMSB:
+           _currentParameter[channel - 1] = NO_PARAMETER;
+           _currentDataEntryMSB[channel - 1] = NO_DATA_ENTRY;
+        break;
+
+        case midi::DataEntryMSB:
+        case midi::DataEntryLSB:
+        case midi::DataIncrement:
+        case midi::DataDecrement:
+           _currentDataEntryMSB[channel - 1] = NO_DATA_ENTRY;
+        break;
+    }
 }
\ No newline at end of file
@@ -22,23 +22,52 @@
 
 #include <MIDI.h>
 #include <MIDIMessage.h>
+#include <ControllerConfig.h>
+#include <util/atomic.h>
 
 typedef midi::MidiInterface<HardwareSerial> MidiInterface;
 
 class MidiWorker
 {
   public:   
-    MidiWorker();   
-    MidiWorker(MidiInterface& inInterface);   
+    MidiWorker(MidiInterface& inInterface, HardwareSerial& serial);
     void begin();
+    void setRunningStatus(uint8_t enabled);
+    void sendSysEx(uint8_t length, const uint8_t * data);
     void sendMIDIMessage(MIDIMessage * message, uint8_t channel);
+    void sendChannelMessages(const uint8_t * data, uint8_t length);
     void sendMIDIStartClock();
     void sendMIDIClock();
     void sendMIDIStopClock();
+    void panic();
 
   private:
+    void sendChannelMessage(uint8_t type, uint8_t data1, uint8_t data2, uint8_t channel);
+    void sendParameterNumber(uint16_t parameter, uint8_t channel);
+    void sendParameterValue(uint16_t value, uint8_t channel);
+    void invalidateParameterCache(uint8_t controlNumber, uint8_t channel);
+    void updateActiveNotes(uint8_t status, uint8_t data1, uint8_t data2);
+    int8_t getActiveNotesMap(uint8_t channel);
+    void clearActiveNotesMap(uint8_t map);
+
+    MidiInterface& _mMidi;   // the MIDI object interface
+    HardwareSerial& _serial; // serial port of the MIDI output, channel messages are written directly to it
+
+    uint8_t _useRunningStatus;     // TRUE when the status byte is omitted for consecutive messages of the same type and channel
+    uint8_t _runningStatus;        // last status byte sent. 0 when the next message must send its status byte
+    uint32_t _lastStatusSentTime;  // time (ms) when the last status byte was sent
+
+    uint16_t _currentParameter[16];   // last NRPN/RPN parameter number selected on each MIDI channel
+    uint8_t _currentDataEntryMSB[16]; // last Data Entry MSB sent on each MIDI channel
+
+    enum { NO_PARAMETER = 0xFFFF, RPN_PARAMETER = 0x8000 }; // Parameter cache markers: nothing selected and RPN (instead of NRPN) parameter
+    enum { NO_DATA_ENTRY = 0xFF };                          // Data Entry MSB cache marker: nothing sent
+
+    enum { ACTIVE_NOTES_MAPS = 4 }; // number of channels whose sounding notes are tracked note by note
+
+    uint8_t _activeNotes[ACTIVE_NOTES_MAPS][16];    // 128-bit map of the sounding notes of a channel
+    uint8_t _activeNotesChannel[ACTIVE_NOTES_MAPS]; // MIDI channel of each map. 0 when the map is free
+    uint16_t _untrackedChannels;                    // channels with sounding notes that did not get a map
 
-    MidiInterface& _mMidi; // the MIDI object interface
-   
 };
 #endif
\ No newline at end of file
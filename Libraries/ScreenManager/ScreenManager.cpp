@@ -27,10 +27,29 @@ void ScreenManager::initialize()
 {
     _lcd.begin(COLUMNS, ROWS); // initialize the lcd
 
-    Wire.setClock(400000L); // set the clock frequency for the I2C protocol (High Speed Mode)
+    I2CBus.begin(); // the lcd initialization starts the I2C bus in standard mode, so its clock is set after it
+
+    _lcd.busyFlagPolling(); // end long commands with the busy flag when the i/o expander drives the r/w pin
 
     _displayedMIDIComponent = NULL;
     _currentMIDIMessageDisplayed = 0;
+    _dirtyField = NO_FIELD;
+    _lastRefreshTime = millis();
+
+    clearDefaultScreenFields();
+
+    _dirtyMeters = 0;
+
+    for (uint8_t meter = 0; meter < NUM_MIDI_POTS; meter++)
+    {
+        _meterValues[meter] = 0;
+    }
+
+    // load the glyphs of the step grid and the meters into the CGRAM of the screen
+    for (uint8_t glyph = 0; glyph < GLYPHS; glyph++)
+    {
+        _lcd.createChar(glyph, glyphs[glyph]);
+    }
 }
 
 /*
@@ -40,7 +59,11 @@ void ScreenManager::initialize()
 */
 void ScreenManager::printDefault(uint8_t page, uint8_t numPages, uint16_t tempo, uint8_t isMIDIClockOn)
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+    clearDefaultScreenFields();
 
     // No MIDI component is assigned to the Screen Manager
     _displayedMIDIComponent = NULL;
@@ -48,38 +71,31 @@ void ScreenManager::printDefault(uint8_t page, uint8_t numPages, uint16_t tempo,
     //Set the cursor on the top left of the screen
     _lcd.setCursor(0, 0);
 
-    // prints the pages and tempo information
-    getMessage(MSG_PAGE, line);
-    itoa(page, line + strlen(line), 10);
-    append(line, '/');
-    itoa(numPages, line + strlen(line), 10);
-    append(line, ' ');
-    itoa(tempo, line + strlen(line), 10);
-    append(line, ' ');
-    getMessage(MSG_BPM, line + strlen(line));
-
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    // prints the pages and tempo information. Page and tempo are fixed-width fields, so the labels do not move
+    line.appendText(getMessage(MSG_PAGE));
+    line.appendNumber(page, PAGE_DIGITS);
+    line.append('/');
+    line.appendNumber(numPages);
+    line.append(' ');
+    _tempoPosition = line.getColumn();
+    line.appendNumber(tempo, BPM_DIGITS);
+    line.append(' ');
+    line.appendText(getMessage(MSG_BPM));
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     // second line is empty
     _lcd.setCursor(0, 1);
 
-    line[0] = '\0';
+    line.clear();
 
-    // prints the MIDI clock status
-    getMessage(MSG_CLOCK, line);
-    isMIDIClockOn ? getMessage(ON, line + strlen(line)) : getMessage(OFF, line + strlen(line));
+    // prints the MIDI clock status. The meter view takes its place when a potentiometer sends a CC value
+    line.appendText(getMessage(MSG_CLOCK));
+    line.appendText(getMessage(isMIDIClockOn ? ON : OFF));
 
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    _lcd.print(line.finish());
 
-    _lcd.print(line);
+    _meterView = METER_VIEW_HIDDEN;
 }
 
 /*
@@ -87,34 +103,28 @@ void ScreenManager::printDefault(uint8_t page, uint8_t numPages, uint16_t tempo,
 */
 void ScreenManager::printSelectComponentMessage()
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+    clearDefaultScreenFields();
 
     _lcd.noBlink();
     _lcd.setCursor(0, 0);
 
     // first line
-    getMessage(MSG_EDIT1, line);
-
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendText(getMessage(MSG_EDIT1));
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     // second line
     _lcd.setCursor(0, 1);
 
-    line[0] = '\0';
+    line.clear();
 
-    getMessage(MSG_EDIT2, line);
-
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendText(getMessage(MSG_EDIT2));
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 }
 
 /*
@@ -123,7 +133,11 @@ void ScreenManager::printSelectComponentMessage()
 */
 void ScreenManager::printEditGlobalConfig(GlobalConfig globalConf)
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+    clearDefaultScreenFields();
 
     // No MIDI component is assigned to the Screen Manager
     _displayedMIDIComponent = NULL;
@@ -132,64 +146,55 @@ void ScreenManager::printEditGlobalConfig(GlobalConfig globalConf)
     _lcd.setCursor(0, 0);
 
     // prints the musical mode
-    getMessage(MSG_MODE, line);
-    strcat(line + strlen(line), MIDIUtils::getModeName(globalConf.getMode()));
-
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendText(getMessage(MSG_MODE));
+    line.appendText(MIDIUtils::getModeName(globalConf.getMode()));
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     // prints the root note and the MIDI Channel data
     _lcd.setCursor(0, 1);
 
-    line[0] = '\0';
-
-    getMessage(MSG_KEY, line);
-    strcat(line + strlen(line), MIDIUtils::getNoteName(globalConf.getRootNote()));
-
-    for (int i = strlen(line); i < EDIT_GLOBAL_CHANNEL_POS; i++)
-    {
-        append(line, ' ');
-    }
-
-    getMessage(MSG_CHANNEL, line + strlen(line));
-    itoa(globalConf.getMIDIChannel(), line + strlen(line), 10);
+    line.clear();
 
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendText(getMessage(MSG_KEY));
+    line.appendText(MIDIUtils::getNoteName(globalConf.getRootNote()));
+    line.padTo(EDIT_GLOBAL_CHANNEL_POS);
+    line.appendText(getMessage(MSG_CHANNEL));
+    line.appendNumber(globalConf.getMIDIChannel());
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     _lcd.setCursor(EDIT_GLOBAL_MODE_POS, 0);
     _lcd.blink();
 }
 
 /*
-* Load a string of chars from the PROGMEM
-* msgIndex: text to Load
-* buffer: array of chars where the text will be loaded
+* Return a text stored into the PROGMEM
+* msgIndex: text to return
 */
-void ScreenManager::getMessage(uint8_t msgIndex, char *buffer)
+const __FlashStringHelper *ScreenManager::getMessage(uint8_t msgIndex)
 {
-    strcpy_P(buffer, (char *)pgm_read_word(&(messages[msgIndex])));
+    return (const __FlashStringHelper *)pgm_read_word(&(messages[msgIndex]));
 }
 
 /*
-* Append a char to a String
-* char * s: string destination
-* char c: the char to be appended
+* Return the number of chars of a text stored into the PROGMEM. Used to place the cursor after a label
+* msgIndex: the text
 */
-void ScreenManager::append(char *s, char c)
+uint8_t ScreenManager::getMessageLength(uint8_t msgIndex)
 {
+    return strlen_P((PGM_P)getMessage(msgIndex));
+}
 
-    uint8_t len = strlen(s);
-    s[len] = c;
-    s[len + 1] = '\0';
+/*
+* Append the name and the octave of a note to a line
+* line: the line
+* note: the MIDI note
+*/
+void ScreenManager::appendNote(LineBuilder &line, uint8_t note)
+{
+    line.appendText(MIDIUtils::getNoteName(note));
+    line.appendNumber(MIDIUtils::getOctave(note));
 }
 
 /*
@@ -229,7 +234,11 @@ uint8_t ScreenManager::getDisplayedMessageType()
 */
 void ScreenManager::displayComponentMIDIMessage(uint8_t msgIndex)
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+    clearDefaultScreenFields();
 
     if (_displayedMIDIComponent != NULL)
     {
@@ -239,47 +248,53 @@ void ScreenManager::displayComponentMIDIMessage(uint8_t msgIndex)
         _lcd.setCursor(0, 0);
 
         // display current message index and total messages of the component
-        itoa(msgIndex, line, DEC);
-        append(line, '/');
-        itoa(_displayedMIDIComponent->getNumMessages(), line + strlen(line), DEC);
-        append(line, ' ');
+        line.appendNumber(msgIndex);
+        line.append('/');
+        line.appendNumber(_displayedMIDIComponent->getNumMessages());
+        line.append(' ');
 
         // display the first MIDI message of the component
         switch ((_displayedMIDIComponent->getMessages()[msgIndex - 1]).getType())
         {
         case midi::NoteOn:
         case midi::NoteOff:
-            getMessage(MSG_NOTE_ON_OFF, line + strlen(line));
-            _lcd.print(line);
+            line.appendText(getMessage(MSG_NOTE_ON_OFF));
+            _lcd.print(line.finish());
             printNoteOnOffMIDIData(_displayedMIDIComponent->getMessages()[msgIndex - 1]);
             break;
 
         case midi::ControlChange:
-            getMessage(MSG_CTRL_CHANGE, line + strlen(line));
-            _lcd.print(line);
+            line.appendText(getMessage(MSG_CTRL_CHANGE));
+            _lcd.print(line.finish());
             printCCMIDIData(_displayedMIDIComponent->getMessages()[msgIndex - 1]);
             break;
 
         case midi::ProgramChange:
-            getMessage(MSG_PGRM_CHANGE, line + strlen(line));
-            _lcd.print(line);
+            line.appendText(getMessage(MSG_PGRM_CHANGE));
+            _lcd.print(line.finish());
             printPCMIDIData(_displayedMIDIComponent->getMessages()[msgIndex - 1]);
             break;
 
-        case midi::InvalidType:
-            getMessage(MSG_EMPTY_MIDI_TYPE, line + strlen(line));
-            _lcd.print(line);
+        case MIDIMessage::NRPN:
+            line.appendText(getMessage(MSG_NRPN));
+            _lcd.print(line.finish());
+            printParameterNumberMIDIData(_displayedMIDIComponent->getMessages()[msgIndex - 1]);
+            break;
 
-            line[0] = '\0';
+        case MIDIMessage::RPN:
+            line.appendText(getMessage(MSG_RPN));
+            _lcd.print(line.finish());
+            printParameterNumberMIDIData(_displayedMIDIComponent->getMessages()[msgIndex - 1]);
+            break;
 
-            _lcd.setCursor(0, 1);
+        case midi::InvalidType:
+            line.appendText(getMessage(MSG_EMPTY_MIDI_TYPE));
+            _lcd.print(line.finish());
 
-            for (int i = 0; i < COLUMNS; i++)
-            {
-                append(line + strlen(line), ' ');
-            }
+            line.clear();
 
-            _lcd.print(line);
+            _lcd.setCursor(0, 1);
+            _lcd.print(line.finish());
             break;
         }
 
@@ -295,28 +310,18 @@ void ScreenManager::displayComponentMIDIMessage(uint8_t msgIndex)
 */
 void ScreenManager::printNoteOnOffMIDIData(MIDIMessage message)
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS - NOTE_POS);
 
     _lcd.setCursor(NOTE_POS, 1);
 
     //print note + octave + velocity data
-    strcpy(line, MIDIUtils::getNoteName(message.getDataByte1()));
-    itoa(MIDIUtils::getOctave(message.getDataByte1()), line + strlen(line), DEC);
-
-    for (int i = strlen(line); i < VELOCITY_POS; i++)
-    {
-        append(line + strlen(line), ' ');
-    }
+    appendNote(line, message.getDataByte1());
+    line.padTo(VELOCITY_POS - NOTE_POS);
+    line.appendText(getMessage(MSG_VELOCITY));
+    line.appendNumber(message.getDataByte2());
 
-    getMessage(MSG_VELOCITY, line + strlen(line));
-    itoa(message.getDataByte2(), line + strlen(line), DEC);
-
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line + strlen(line), ' ');
-    }
-
-    _lcd.print(line);
+    _lcd.print(line.finish());
 }
 
 /*
@@ -325,19 +330,15 @@ void ScreenManager::printNoteOnOffMIDIData(MIDIMessage message)
 */
 void ScreenManager::printCCMIDIData(MIDIMessage message)
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS - CC_POS);
 
     //print CC Number
     _lcd.setCursor(CC_POS, 1);
-    getMessage(MSG_CC, line);
-    itoa(message.getDataByte1(), line + strlen(line), DEC);
+    line.appendText(getMessage(MSG_CC));
+    line.appendNumber(message.getDataByte1());
 
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line + strlen(line), ' ');
-    }
-
-    _lcd.print(line);
+    _lcd.print(line.finish());
 }
 
 /*
@@ -346,18 +347,32 @@ void ScreenManager::printCCMIDIData(MIDIMessage message)
 */
 void ScreenManager::printPCMIDIData(MIDIMessage message)
 {
-    char line[COLUMNS + 1];
-
-    line[0] = '\0';
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
 
     _lcd.setCursor(0, 1);
 
-    for (int i = 0; i < COLUMNS; i++)
-    {
-        append(line + strlen(line), ' ');
-    }
+    _lcd.print(line.finish());
+}
 
-    _lcd.print(line);    
+/*
+* Display the parameter number of a NRPN/RPN MIDI message
+* message: the MIDI message to display
+*/
+void ScreenManager::printParameterNumberMIDIData(MIDIMessage message)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS - PARAM_MSB_POS);
+
+    //print parameter number MSB + LSB
+    _lcd.setCursor(PARAM_MSB_POS, 1);
+    line.appendText(getMessage(MSG_PARAM_MSB));
+    line.appendNumber(message.getDataByte1());
+    line.padTo(PARAM_LSB_POS - PARAM_MSB_POS);
+    line.appendText(getMessage(MSG_PARAM_LSB));
+    line.appendNumber(message.getDataByte2());
+
+    _lcd.print(line.finish());
 }
 
 /*
@@ -406,35 +421,41 @@ void ScreenManager::setMIDIComponentToDisplay(IMIDIComponent *midiComponent)
 */
 void ScreenManager::refreshMIDIData()
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS - MESSAGE_TYPE_POS);
+
+    flushRefresh();
 
     switch (_displayedMIDIComponent->getMessages()[_currentMIDIMessageDisplayed - 1].getType())
     {
     case midi::NoteOn:
     case midi::NoteOff:
-        getMessage(MSG_NOTE_ON_OFF, line);
+        line.appendText(getMessage(MSG_NOTE_ON_OFF));
         break;
 
     case midi::ControlChange:
-        getMessage(MSG_CTRL_CHANGE, line);
+        line.appendText(getMessage(MSG_CTRL_CHANGE));
         break;
 
     case midi::ProgramChange:
-        getMessage(MSG_PGRM_CHANGE, line);
+        line.appendText(getMessage(MSG_PGRM_CHANGE));
         break;
 
-    case midi::InvalidType:
-        getMessage(MSG_EMPTY_MIDI_TYPE, line);
+    case MIDIMessage::NRPN:
+        line.appendText(getMessage(MSG_NRPN));
         break;
-    }
 
-    for (int i = (MESSAGE_TYPE_POS + strlen(line)); i < COLUMNS; i++)
-    {
-        append(line + strlen(line), ' ');
+    case MIDIMessage::RPN:
+        line.appendText(getMessage(MSG_RPN));
+        break;
+
+    case midi::InvalidType:
+        line.appendText(getMessage(MSG_EMPTY_MIDI_TYPE));
+        break;
     }
 
     // print hte MIDI message type name on screen
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     switch (_displayedMIDIComponent->getMessages()[_currentMIDIMessageDisplayed - 1].getType())
     {
@@ -454,18 +475,14 @@ void ScreenManager::refreshMIDIData()
         printPCMIDIData(_displayedMIDIComponent->getMessages()[_currentMIDIMessageDisplayed - 1]);
         break;
 
-    case midi::InvalidType:
-
-        line[0] = '\0';
-
-        _lcd.setCursor(0, 1);
+    case MIDIMessage::NRPN:
+    case MIDIMessage::RPN:
+        printParameterNumberMIDIData(_displayedMIDIComponent->getMessages()[_currentMIDIMessageDisplayed - 1]);
+        break;
 
-        for (int i = 0; i < COLUMNS; i++)
-        {
-            append(line + strlen(line), ' ');
-        }
+    case midi::InvalidType:
 
-        _lcd.print(line);
+        clearRangeOnCurentLine(1, 0, COLUMNS);
     }
 
     // set the cursor at the beginning of the MIDI message type name
@@ -477,32 +494,43 @@ void ScreenManager::refreshMIDIData()
 */
 void ScreenManager::printSavedMessage()
 {
-    char line[COLUMNS + 1];
+    printFullScreenMessage(MSG_SAVED);
+}
+
+/*
+* Display the message shown when a sequence does not fit into the EEPROM
+*/
+void ScreenManager::printMemoryFullMessage()
+{
+    printFullScreenMessage(MSG_MEMORY_FULL);
+}
+
+/*
+* Display a message on the first line of the screen and clean the second one
+* msgIndex: message to display
+*/
+void ScreenManager::printFullScreenMessage(uint8_t msgIndex)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+    clearDefaultScreenFields();
 
     _lcd.noBlink();
     _lcd.setCursor(0, 0);
 
     // print the message on the first line
-    getMessage(MSG_SAVED, line);
-
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line + strlen(line), ' ');
-    }
+    line.appendText(getMessage(msgIndex));
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     // second line is empty
-    line[0] = '\0';
+    line.clear();
 
     _lcd.setCursor(0, 1);
 
-    for (int i = 0; i < COLUMNS; i++)
-    {
-        append(line + strlen(line), ' ');
-    }
-
-    _lcd.print(line);
+    _lcd.print(line.finish());
 }
 
 /*
@@ -510,6 +538,8 @@ void ScreenManager::printSavedMessage()
 */
 void ScreenManager::moveCursorToMsgType()
 {
+    flushRefresh();
+
     _lcd.setCursor(MESSAGE_TYPE_POS, 0);
 }
 
@@ -518,6 +548,8 @@ void ScreenManager::moveCursorToMsgType()
 */
 void ScreenManager::moveCursorToNote()
 {
+    flushRefresh();
+
     _lcd.setCursor(NOTE_POS, 1);
 }
 
@@ -526,10 +558,9 @@ void ScreenManager::moveCursorToNote()
 */
 void ScreenManager::moveCursorToVelocity()
 {
-    char buffer[10];
+    flushRefresh();
 
-    getMessage(MSG_VELOCITY, buffer);
-    _lcd.setCursor(VELOCITY_POS + strlen(buffer), 1);
+    _lcd.setCursor(VELOCITY_POS + getMessageLength(MSG_VELOCITY), 1);
 }
 
 /*
@@ -537,10 +568,29 @@ void ScreenManager::moveCursorToVelocity()
 */
 void ScreenManager::moveCursorToCC()
 {
-    char buffer[10];
+    flushRefresh();
+
+    _lcd.setCursor(CC_POS + getMessageLength(MSG_CC), 1);
+}
+
+/*
+* Move the screen cursor to the start position of the NRPN/RPN parameter number MSB
+*/
+void ScreenManager::moveCursorToParameterMSB()
+{
+    flushRefresh();
+
+    _lcd.setCursor(PARAM_MSB_POS + getMessageLength(MSG_PARAM_MSB), 1);
+}
+
+/*
+* Move the screen cursor to the start position of the NRPN/RPN parameter number LSB
+*/
+void ScreenManager::moveCursorToParameterLSB()
+{
+    flushRefresh();
 
-    getMessage(MSG_CC, buffer);
-    _lcd.setCursor(strlen(buffer), 1);
+    _lcd.setCursor(PARAM_LSB_POS + getMessageLength(MSG_PARAM_LSB), 1);
 }
 
 /*
@@ -548,10 +598,9 @@ void ScreenManager::moveCursorToCC()
 */
 void ScreenManager::moveCursorToRootNote()
 {
-    char buffer[10];
+    flushRefresh();
 
-    getMessage(MSG_KEY, buffer);
-    _lcd.setCursor(strlen(buffer), 1);
+    _lcd.setCursor(getMessageLength(MSG_KEY), 1);
 }
 
 /*
@@ -559,10 +608,9 @@ void ScreenManager::moveCursorToRootNote()
 */
 void ScreenManager::moveCursorToMIDIChannel()
 {
-    char buffer[10];
+    flushRefresh();
 
-    getMessage(MSG_CHANNEL, buffer);
-    _lcd.setCursor(EDIT_GLOBAL_CHANNEL_POS + strlen(buffer), 1);
+    _lcd.setCursor(EDIT_GLOBAL_CHANNEL_POS + getMessageLength(MSG_CHANNEL), 1);
 }
 
 /*
@@ -570,76 +618,92 @@ void ScreenManager::moveCursorToMIDIChannel()
 */
 void ScreenManager::moveCursorToMode()
 {
+    flushRefresh();
+
     _lcd.setCursor(EDIT_GLOBAL_MODE_POS, 0);
 }
 
+/*
+* Mark the note name and octave as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* note: the new value
+*/
+void ScreenManager::refreshNoteValue(uint8_t note)
+{
+    deferRefresh(NOTE_FIELD, note);
+}
+
 /*
 * Display the new note name and octave without refreshing all the screen data
 * note: note value which name and octave will be displayed.
 */
-void ScreenManager::refreshNoteValue(uint8_t note)
+void ScreenManager::drawNoteValue(uint8_t note)
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, VELOCITY_POS - NOTE_POS);
 
     _lcd.noBlink();
 
-    strcpy(line, MIDIUtils::getNoteName(note));
-    itoa(MIDIUtils::getOctave(note), line + strlen(line), DEC);
-
-    for (int i = strlen(line); i < VELOCITY_POS; i++)
-    {
-        append(line + strlen(line), ' ');
-    }
+    appendNote(line, note);
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     moveCursorToNote();
 
     _lcd.blink();
 }
 
+/*
+* Mark the velocity value as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* velocity: the new value
+*/
+void ScreenManager::refreshVelocityValue(uint8_t velocity)
+{
+    deferRefresh(VELOCITY_FIELD, velocity);
+}
+
 /*
 * Display the new velocity value without refreshing all the screen data
 * velocity: velocity value that will be displayed.
 */
-void ScreenManager::refreshVelocityValue(uint8_t velocity)
+void ScreenManager::drawVelocityValue(uint8_t velocity)
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, MIDI_VALUE_DIGITS);
 
     _lcd.noBlink();
 
-    itoa(velocity, line, DEC);
-
-    for (int i = 0; i < 2; i++)
-    {
-        append(line + strlen(line), ' ');
-    }
+    line.appendNumber(velocity);
 
-    _lcd.write(line);
+    _lcd.print(line.finish());
 
     moveCursorToVelocity();
 
     _lcd.blink();
 }
 
+/*
+* Mark the CC value as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* cc: the new value
+*/
+void ScreenManager::refreshCCValue(uint8_t cc)
+{
+    deferRefresh(CC_FIELD, cc);
+}
+
 /*
 * Display the new CC value without refreshing all the screen data
 * cc: cc value that will be displayed.
 */
-void ScreenManager::refreshCCValue(uint8_t cc)
+void ScreenManager::drawCCValue(uint8_t cc)
 {
-    char line[4];
+    char buffer[MIDI_VALUE_DIGITS + 1];
+    LineBuilder line(buffer, MIDI_VALUE_DIGITS);
 
     _lcd.noBlink();
 
-    itoa(cc, line, DEC);
-
-    for (int i = 0; i < 2; i++)
-    {
-        append(line + strlen(line), ' ');
-    }
+    line.appendNumber(cc);
 
-    _lcd.write(line);
+    _lcd.print(line.finish());
 
     moveCursorToCC();
 
@@ -647,260 +711,770 @@ void ScreenManager::refreshCCValue(uint8_t cc)
 }
 
 /*
-* Display the new global configuration musical mode value without refreshing all the screen data
-* mode: musical mode value that will be displayed.
+* Mark the NRPN/RPN parameter number MSB as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* msb: the new value
 */
-void ScreenManager::refreshModeData(uint8_t mode)
+void ScreenManager::refreshParameterMSBValue(uint8_t msb)
+{
+    deferRefresh(PARAM_MSB_FIELD, msb);
+}
+
+/*
+* Display the new NRPN/RPN parameter number MSB without refreshing all the screen data
+* msb: parameter number MSB that will be displayed.
+*/
+void ScreenManager::drawParameterMSBValue(uint8_t msb)
 {
-    char line[COLUMNS + 1];
+    char buffer[MIDI_VALUE_DIGITS + 1];
+    LineBuilder line(buffer, MIDI_VALUE_DIGITS);
 
     _lcd.noBlink();
 
-    strcpy(line, MIDIUtils::getModeName(mode));
+    // the field is padded to three digits so the adjacent field is not overwritten
+    line.appendNumber(msb);
 
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    _lcd.print(line.finish());
 
-    _lcd.print(line);
-
-    moveCursorToMode();
+    moveCursorToParameterMSB();
 
     _lcd.blink();
 }
 
 /*
-* Display the new global configuration root note value without refreshing all the screen data
-* rootNote: root note value that will be displayed.
+* Mark the NRPN/RPN parameter number LSB as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* lsb: the new value
 */
-void ScreenManager::refreshRootNoteData(uint8_t rootNote)
+void ScreenManager::refreshParameterLSBValue(uint8_t lsb)
 {
-    char line[COLUMNS + 1];
+    deferRefresh(PARAM_LSB_FIELD, lsb);
+}
 
-    _lcd.noBlink();
+/*
+* Display the new NRPN/RPN parameter number LSB without refreshing all the screen data
+* lsb: parameter number LSB that will be displayed.
+*/
+void ScreenManager::drawParameterLSBValue(uint8_t lsb)
+{
+    char buffer[MIDI_VALUE_DIGITS + 1];
+    LineBuilder line(buffer, MIDI_VALUE_DIGITS);
 
-    strcpy(line, MIDIUtils::getNoteName(rootNote));
+    _lcd.noBlink();
 
-    for (int i = EDIT_GLOBAL_KEY_POS + strlen(line); i < EDIT_GLOBAL_CHANNEL_POS; i++)
-    {
-        append(line, ' ');
-    }
+    // the field is padded to three digits so the adjacent field is not overwritten
+    line.appendNumber(lsb);
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
-    moveCursorToRootNote();
+    moveCursorToParameterLSB();
 
     _lcd.blink();
 }
 
 /*
-* Display the new global configuration MIDI channel value without refreshing all the screen data
-* midiChannel: MIDI channel value that will be displayed.
+* Mark the global configuration musical mode as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* mode: the new value
 */
-void ScreenManager::refreshMIDIChannelData(uint8_t midiChannel)
+void ScreenManager::refreshModeData(uint8_t mode)
 {
-    char line[COLUMNS + 1];
+    deferRefresh(MODE_FIELD, mode);
+}
 
-    _lcd.noBlink();
+/*
+* Display the new global configuration musical mode value without refreshing all the screen data
+* mode: musical mode value that will be displayed.
+*/
+void ScreenManager::drawModeData(uint8_t mode)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS - EDIT_GLOBAL_MODE_POS);
 
-    itoa(midiChannel, line, 10);
+    _lcd.noBlink();
 
-    for (int i = 0; i < 1; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendText(MIDIUtils::getModeName(mode));
 
-    _lcd.write(line);
+    _lcd.print(line.finish());
 
-    moveCursorToMIDIChannel();
+    moveCursorToMode();
 
     _lcd.blink();
 }
 
 /*
-* Clean a range of characters from a row of the screen 
-* row: line where the chars will be deleted
-* from: initial position of the range that will be deleted
-* to: last position of the range that will be deleted
+* Mark the global configuration root note as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* rootNote: the new value
 */
-void ScreenManager::clearRangeOnCurentLine(uint8_t row, uint8_t from, uint8_t to)
+void ScreenManager::refreshRootNoteData(uint8_t rootNote)
 {
-    _lcd.setCursor(from, row);
-    for (int i = from; i < to; i++)
-    {
-        _lcd.print(F(" "));
-    }
+    deferRefresh(ROOT_NOTE_FIELD, rootNote);
 }
 
-/**************************************************/
-/* SEQUENCER METHODS                              */
-/**************************************************/
-
 /*
-* Prints the information of the sequencer
+* Display the new global configuration root note value without refreshing all the screen data
+* rootNote: root note value that will be displayed.
 */
-void ScreenManager::printDefaultSequencer(uint8_t currentSequence, uint8_t totalSequences, uint16_t tempo, uint8_t playBackOn)
+void ScreenManager::drawRootNoteData(uint8_t rootNote)
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, EDIT_GLOBAL_CHANNEL_POS - EDIT_GLOBAL_KEY_POS);
 
-    // set to the screen manager the position of the step being edited
-    _currentDisplayedStep = 1;
+    _lcd.noBlink();
 
-    //Set the cursor on the top left of the screen
-    _lcd.setCursor(0, 0);
+    line.appendText(MIDIUtils::getNoteName(rootNote));
 
-    // prints the sequence number and tempo information
-    getMessage(MSG_SEQ, line);
-    itoa(currentSequence, line + strlen(line), DEC);
-    append(line + strlen(line), '/');
-    itoa(totalSequences, line + strlen(line), DEC);
-    append(line + strlen(line), ' ');
-    itoa(tempo, line + strlen(line), 10);
-    append(line, ' ');
+    _lcd.print(line.finish());
 
-    getMessage(MSG_BPM, line + strlen(line));
+    moveCursorToRootNote();
 
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    _lcd.blink();
+}
+
+/*
+* Mark the global configuration MIDI channel as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* midiChannel: the new value
+*/
+void ScreenManager::refreshMIDIChannelData(uint8_t midiChannel)
+{
+    deferRefresh(MIDI_CHANNEL_FIELD, midiChannel);
+}
 
-    _lcd.print(line);
+/*
+* Display the new global configuration MIDI channel value without refreshing all the screen data
+* midiChannel: MIDI channel value that will be displayed.
+*/
+void ScreenManager::drawMIDIChannelData(uint8_t midiChannel)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, CHANNEL_DIGITS);
 
-    // prints playback status on/off
-    _lcd.setCursor(0, 1);
+    _lcd.noBlink();
 
-    line[0] = '\0';
+    line.appendNumber(midiChannel);
 
-    getMessage(MSG_PLAYBACK, line);
-    playBackOn ? getMessage(ON, line + strlen(line)) : getMessage(OFF, line + strlen(line));
+    _lcd.print(line.finish());
 
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    moveCursorToMIDIChannel();
 
-    _lcd.print(line);
+    _lcd.blink();
 }
 
 /*
-* Prints current step being played
+* Clean the whole screen. It does not wait for the screen to execute the command, 
+* so isReady() can be checked before the next print instead of waiting for it
 */
-void ScreenManager::updateDisplayedPlaybackStep(Step step, uint8_t sequenceLength, uint8_t currentStep)
+void ScreenManager::cleanScreen()
 {
-    char line[COLUMNS + 1];
+    flushRefresh();
+    clearDefaultScreenFields();
 
-    // prints the step number and note value (if active) and legato symbol (if is legato)
-    _lcd.setCursor(0, 1);
+    _lcd.clear();
+}
 
-    getMessage(MSG_STEP, line);
-    itoa(currentStep, line + strlen(line), DEC);
-    append(line + strlen(line), '/');
-    itoa(sequenceLength, line + strlen(line), DEC);
-    append(line + strlen(line), ' ');
-    strcat(line + strlen(line), getStepNoteValue(step));
+/*
+* Return 1 if the screen can take the next print without waiting, 0 otherwise
+*/
+uint8_t ScreenManager::isReady()
+{
+    return _lcd.isReady();
+}
 
-    for (int i = strlen(line); i < COLUMNS; i++)
+/*
+* Draw the field and the meters marked as dirty, if any, once SCREEN_REFRESH_MS have passed since the last refresh and the screen
+* can take it without waiting. It is called on every loop, so the values edited with the select value potentiometer
+* are drawn at most 30 times per second while the MIDI data is updated at full rate. The refresh waits for the next
+* loop when a memory transaction or the step grid have used the I2C bus on the current one
+*/
+void ScreenManager::refresh()
+{
+    if ((_dirtyField != NO_FIELD || _dirtyMeters) && (millis() - _lastRefreshTime) >= SCREEN_REFRESH_MS && _lcd.isReady() &&
+        I2CBus.acquire(I2CBusManager::SCREEN_CLIENT, I2CBusManager::REFRESH_PRIORITY))
     {
-        append(line, ' ');
-    }
+        flushRefresh();
+        flushMeters();
 
-    _lcd.print(line);
+        I2CBus.release();
+    }
 }
 
 /*
-* Prints step data in edit mode
+* Mark a field as dirty. When another field is already dirty it is drawn first, so the fields are drawn in the
+* same order they were changed
+* field: the field
+* value: the value that will be displayed
 */
-void ScreenManager::printEditStepData(Step step, uint8_t currentStep, uint8_t sequenceLength)
+void ScreenManager::deferRefresh(uint8_t field, uint16_t value)
 {
-    char line[COLUMNS + 1];
-
-    // set to the screen manager the position of the step being edited
-    _currentDisplayedStep = currentStep;
+    if (_dirtyField != field)
+    {
+        flushRefresh();
+    }
 
-    //Set the cursor on the top left of the screen
-    _lcd.setCursor(0, 0);
+    _dirtyField = field;
+    _dirtyValue = value;
+}
 
-    // prints the step number and note value
-    getMessage(MSG_STEP, line);
-    itoa(currentStep, line + strlen(line), DEC);
-    append(line + strlen(line), '/');
-    itoa(sequenceLength, line + strlen(line), DEC);
-    append(line + strlen(line), ' ');
+/*
+* Draw the field marked as dirty right now. It is called before anything else is printed, so the dirty field is
+* drawn on the screen it belongs to and the cursor is left where the printed data expects it
+*/
+void ScreenManager::flushRefresh()
+{
+    uint8_t field = _dirtyField;
 
-    for (int i = strlen(line); i < STEP_NOTE_POS; i++)
+    if (field == NO_FIELD)
     {
-        append(line, ' ');
+        return;
     }
 
-    strcat(line + strlen(line), MIDIUtils::getNoteName(step.getNote()));
-    itoa(MIDIUtils::getOctave(step.getNote()), line + strlen(line), DEC);
+    _dirtyField = NO_FIELD;
+    _lastRefreshTime = millis();
 
-    for (int i = strlen(line); i < COLUMNS; i++)
+    switch (field)
     {
-        append(line, ' ');
-    }
+    case TEMPO_FIELD:
+        drawTempo(_dirtyValue);
+        break;
 
-    _lcd.print(line);
+    case NOTE_FIELD:
+        drawNoteValue(_dirtyValue);
+        break;
 
-    // prints step's enabled and legato values
-    _lcd.setCursor(0, 1);
+    case VELOCITY_FIELD:
+        drawVelocityValue(_dirtyValue);
+        break;
 
-    line[0] = '\0';
+    case CC_FIELD:
+        drawCCValue(_dirtyValue);
+        break;
 
-    getMessage(MSG_STEP_LEGATO, line);
+    case PARAM_MSB_FIELD:
+        drawParameterMSBValue(_dirtyValue);
+        break;
 
-    step.isLegato() ? getMessage(YES, line + strlen(line)) : getMessage(NO, line + strlen(line));
+    case PARAM_LSB_FIELD:
+        drawParameterLSBValue(_dirtyValue);
+        break;
 
-    for (int i = strlen(line); i < STEP_ENABLED_POS; i++)
+    case MODE_FIELD:
+        drawModeData(_dirtyValue);
+        break;
+
+    case ROOT_NOTE_FIELD:
+        drawRootNoteData(_dirtyValue);
+        break;
+
+    case MIDI_CHANNEL_FIELD:
+        drawMIDIChannelData(_dirtyValue);
+        break;
+
+    case STEP_NOTE_FIELD:
+        drawStepNoteValue(_dirtyValue);
+        break;
+
+    case STEP_LEGATO_FIELD:
+        drawStepLegatoValue(_dirtyValue);
+        break;
+
+    case STEP_ENABLED_FIELD:
+        drawStepEnabledValue(_dirtyValue);
+        break;
+
+    case STEP_LENGTH_FIELD:
+        drawStepLengthValue(_dirtyValue);
+        break;
+
+    case STEP_VELOCITY_FIELD:
+        drawStepVelocityValue(_dirtyValue);
+        break;
+
+    case STEP_PROBABILITY_FIELD:
+        drawStepProbabilityValue(_dirtyValue);
+        break;
+
+    case STEP_RATCHETS_FIELD:
+        drawStepRatchetsValue(_dirtyValue);
+        break;
+
+    case SEND_CLOCK_FIELD:
+        drawSendClockWhilePlayback(_dirtyValue);
+        break;
+
+    case SEQUENCER_MIDI_CHANNEL_FIELD:
+        drawSequencerMidiChannel(_dirtyValue);
+        break;
+    }
+}
+
+/*
+* Mark a meter of the meter view as dirty. The meters display the last CC value sent by each MIDI potentiometer
+* on the second line of the controller default screen, and they are drawn on the next screen refresh
+* meter: the MIDI potentiometer
+* value: the CC value sent
+*/
+void ScreenManager::refreshMeter(uint8_t meter, uint8_t value)
+{
+    _meterValues[meter] = value;
+    bitSet(_dirtyMeters, meter);
+}
+
+/*
+* Draw the meters marked as dirty. The first time the whole meter view is printed over the MIDI clock status
+*/
+void ScreenManager::flushMeters()
+{
+    if (_dirtyMeters == 0)
     {
-        append(line, ' ');
+        return;
     }
 
-    getMessage(MSG_STEP_ENABLED, line + strlen(line));
+    if (_meterView == METER_VIEW_HIDDEN)
+    {
+        printMeters();
+    }
 
-    step.isEnabled() ? getMessage(YES, line + strlen(line)) : getMessage(NO, line + strlen(line));
+    else if (_meterView == METER_VIEW_SHOWN)
+    {
+        for (uint8_t meter = 0; meter < NUM_MIDI_POTS; meter++)
+        {
+            if (bitRead(_dirtyMeters, meter))
+            {
+                drawMeter(meter);
+            }
+        }
+    }
+
+    _dirtyMeters = 0;
+    _lastRefreshTime = millis();
+}
 
-    for (int i = strlen(line); i < COLUMNS; i++)
+/*
+* Prints all the meters on the second line of the screen
+*/
+void ScreenManager::printMeters()
+{
+    for (uint8_t cell = 0; cell < COLUMNS; cell++)
     {
-        append(line, ' ');
+        _glyphCells[cell] = ' ';
+    }
+
+    for (uint8_t meter = 0; meter < NUM_MIDI_POTS; meter++)
+    {
+        for (uint8_t cell = 0; cell < METER_CELLS; cell++)
+        {
+            _glyphCells[meter * (METER_CELLS + 1) + cell] = getMeterGlyph(meter, cell);
+        }
     }
 
-    _lcd.print(line);
+    _lcd.setCursor(0, 1);
+    _lcd.write(_glyphCells, COLUMNS);
 
-    // move cursor to step note value position
-    _lcd.setCursor(STEP_NOTE_POS, 0);
-    _lcd.blink();
+    _meterView = METER_VIEW_SHOWN;
 }
 
 /*
-* Return a char * value with the note value
+* Draw the new value of a meter. Only the cells where the edge of the bar moved are sent to the screen
+* meter: the meter
 */
-char *ScreenManager::getStepNoteValue(Step step)
+void ScreenManager::drawMeter(uint8_t meter)
 {
-    char line[COLUMNS + 1];
+    for (uint8_t cell = 0; cell < METER_CELLS; cell++)
+    {
+        writeGlyphCell(meter * (METER_CELLS + 1) + cell, getMeterGlyph(meter, cell));
+    }
+}
+
+/*
+* Returns the char of a cell of a meter: full, empty or one of the partial cells at the edge of the bar
+* meter: the meter
+* cell: cell of the meter
+*/
+uint8_t ScreenManager::getMeterGlyph(uint8_t meter, uint8_t cell)
+{
+    // pixel columns of the bar, from 0 to METER_CELLS * GLYPH_COLUMNS, for a CC value from 0 to 127
+    uint8_t columns = ((_meterValues[meter] + 1) * (uint16_t)(METER_CELLS * GLYPH_COLUMNS)) >> 7;
+    uint8_t cellStart = cell * GLYPH_COLUMNS;
 
-    line[0] = '\0';
+    if (columns <= cellStart)
+    {
+        return ' ';
+    }
 
-    if (!step.isEnabled())
+    if (columns >= cellStart + GLYPH_COLUMNS)
+    {
+        return FULL_CELL;
+    }
+
+    return METER_GLYPH + (columns - cellStart) - 1;
+}
+
+/*
+* Mark the tempo of the default screen as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* tempo: the new tempo in BPM
+*/
+void ScreenManager::refreshTempo(uint16_t tempo)
+{
+    deferRefresh(TEMPO_FIELD, tempo);
+}
+
+/*
+* Display the new tempo of the controller or sequencer default screen without refreshing all the screen data.
+* The tempo is a fixed-width field, so only its digits are sent to the screen
+* tempo: tempo in BPM
+*/
+void ScreenManager::drawTempo(uint16_t tempo)
+{
+    char buffer[BPM_DIGITS + 1];
+    LineBuilder line(buffer, BPM_DIGITS);
+
+    // the tempo is not displayed on the current screen
+    if (_tempoPosition == 0)
+    {
+        return;
+    }
+
+    line.appendNumber(tempo, BPM_DIGITS);
+
+    _lcd.setCursor(_tempoPosition, 0);
+    _lcd.print(line.finish());
+}
+
+/*
+* Clean a range of characters from a row of the screen 
+* row: line where the chars will be deleted
+* from: initial position of the range that will be deleted
+* to: last position of the range that will be deleted
+*/
+void ScreenManager::clearRangeOnCurentLine(uint8_t row, uint8_t from, uint8_t to)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, to - from);
+
+    _lcd.setCursor(from, row);
+    _lcd.print(line.finish());
+}
+
+/**************************************************/
+/* SEQUENCER METHODS                              */
+/**************************************************/
+
+/*
+* Prints the information of the sequencer
+* currentSequence: sequence of the track, or its song position in song mode
+* totalSequences: number of sequences, or number of entries of the song chain in song mode
+* tempo: tempo in BPM
+* playBackOn: 1 if playback is on, 0 otherwise
+* recording: 1 if the notes played are recorded into the track, 0 otherwise
+* track: track number
+* songMode: 1 if the track plays the song chain, 0 otherwise
+*/
+void ScreenManager::printDefaultSequencer(uint8_t currentSequence, uint8_t totalSequences, uint16_t tempo, uint8_t playBackOn, uint8_t recording, uint8_t track, uint8_t songMode)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+    clearDefaultScreenFields();
+
+    // set to the screen manager the position of the step being edited
+    _currentDisplayedStep = 1;
+
+    //Set the cursor on the top left of the screen
+    _lcd.setCursor(0, 0);
+
+    // prints the sequence number or song position and tempo information
+    line.appendText(getMessage(songMode ? MSG_SONG : MSG_SEQ));
+
+    // a track without sequence is off
+    if (currentSequence == 0)
     {
-        append(line, '-');
-        append(line + strlen(line), '-');
+        line.appendText(getMessage(OFF));
     }
 
     else
     {
-        strcpy(line, MIDIUtils::getNoteName(step.getNote()));
-        itoa(MIDIUtils::getOctave(step.getNote()), line + strlen(line), DEC);
+        line.appendNumber(currentSequence, PAGE_DIGITS);
+        line.append('/');
+        line.appendNumber(totalSequences);
+    }
+
+    line.append(' ');
+    _tempoPosition = line.getColumn();
+    line.appendNumber(tempo, BPM_DIGITS);
+    line.append(' ');
+    line.appendText(getMessage(MSG_BPM));
+
+    _lcd.print(line.finish());
+
+    // while the playback is on the second line shows the step grid, printed by printStepGrid()
+    if (playBackOn && !recording)
+    {
+        return;
+    }
+
+    // prints playback status on/off, labelled as record status when recording
+    _lcd.setCursor(0, 1);
+
+    line.clear();
+
+    line.appendText(getMessage(recording ? MSG_RECORD : MSG_PLAYBACK));
+    line.appendText(getMessage(playBackOn ? ON : OFF));
+    line.padTo(SEQUENCER_TRACK_POS);
+
+    // prints the selected track
+    line.appendText(getMessage(MSG_TRACK));
+    line.appendNumber(track);
+
+    _lcd.print(line.finish());
+}
+
+/*
+* Prints the transposition and scale lock status of the sequencer
+* transpose: semitones the sequencer notes are transposed
+* scaleLock: 1 if the sequencer notes are moved to the scale, 0 otherwise
+*/
+void ScreenManager::printTranspose(int8_t transpose, uint8_t scaleLock)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+    clearDefaultScreenFields();
+
+    _lcd.setCursor(0, 0);
+
+    line.appendText(getMessage(MSG_TRANSPOSE));
+
+    if (transpose > 0)
+    {
+        line.append('+');
+    }
+
+    line.appendNumber(transpose);
+
+    _lcd.print(line.finish());
+
+    _lcd.setCursor(0, 1);
+
+    line.clear();
 
-        if (step.isLegato())
+    line.appendText(getMessage(MSG_SCALE_LOCK));
+    line.appendText(getMessage(scaleLock ? ON : OFF));
+
+    _lcd.print(line.finish());
+}
+
+/*
+* Prints the step grid of a sequence on the second line of the screen: a cell for each step of the page of
+* COLUMNS steps that contains the current step, with a glyph for enabled, disabled and legato steps
+* steps: steps of the sequence
+* sequenceLength: number of steps of the sequence
+* currentStep: step being played, starting at 0
+*/
+void ScreenManager::printStepGrid(Step *steps, uint8_t sequenceLength, uint8_t currentStep)
+{
+    uint8_t firstStep = currentStep - (currentStep % COLUMNS);
+
+    flushRefresh();
+
+    _lcd.setCursor(0, 1);
+
+    for (uint8_t cell = 0; cell < COLUMNS; cell++)
+    {
+        uint8_t step = firstStep + cell;
+
+        if (step == currentStep && step < sequenceLength)
+        {
+            _glyphCells[cell] = CURRENT_STEP_GLYPH;
+        }
+
+        else
         {
-            append(line + strlen(line), '_');
+            _glyphCells[cell] = (step < sequenceLength) ? getStepGlyph(steps[step]) : ' ';
         }
     }
 
-    return line;
+    // the glyph codes start at 0, so the cells are sent with their size instead of as a string
+    _lcd.write(_glyphCells, COLUMNS);
+
+    _gridStep = currentStep;
+}
+
+/*
+* Move the current step of the step grid. Only the cells of the previous and the current step are sent to the
+* screen, unless the current step is on another page of the grid. The grid only holds fields drawn at fixed
+* positions, so there is no need to draw the dirty field first
+* steps: steps of the sequence
+* sequenceLength: number of steps of the sequence
+* currentStep: step being played, starting at 0
+*/
+void ScreenManager::updateDisplayedPlaybackStep(Step *steps, uint8_t sequenceLength, uint8_t currentStep)
+{
+    // the step grid is not displayed, or the step has not changed
+    if (_gridStep == NO_GRID_STEP || currentStep == _gridStep || currentStep >= sequenceLength)
+    {
+        return;
+    }
+
+    // the grid catches up with the playback on the next loop when a memory transaction holds the I2C bus
+    if (!I2CBus.acquire(I2CBusManager::SCREEN_CLIENT, I2CBusManager::PLAYBACK_PRIORITY))
+    {
+        return;
+    }
+
+    if (currentStep / COLUMNS != _gridStep / COLUMNS)
+    {
+        printStepGrid(steps, sequenceLength, currentStep);
+    }
+
+    else
+    {
+        // the previous step is drawn again with its own glyph, so the changes made while it was current are displayed
+        if (_gridStep < sequenceLength)
+        {
+            writeGlyphCell(_gridStep % COLUMNS, getStepGlyph(steps[_gridStep]));
+        }
+
+        writeGlyphCell(currentStep % COLUMNS, CURRENT_STEP_GLYPH);
+
+        _gridStep = currentStep;
+    }
+
+    I2CBus.release();
+}
+
+/*
+* Write a cell of the second line of the step grid or the meter view, only if it is not already displayed on the screen
+* cell: cell of the line
+* glyph: char to be displayed on the cell
+*/
+void ScreenManager::writeGlyphCell(uint8_t cell, uint8_t glyph)
+{
+    if (_glyphCells[cell] != glyph)
+    {
+        _lcd.setCursor(cell, 1);
+        _lcd.write(glyph);
+
+        _glyphCells[cell] = glyph;
+    }
+}
+
+/*
+* Returns the glyph of the step grid that displays a step
+* step: the step
+*/
+uint8_t ScreenManager::getStepGlyph(Step step)
+{
+    if (!step.isEnabled())
+    {
+        return STEP_DISABLED_GLYPH;
+    }
+
+    return step.isLegato() ? STEP_LEGATO_GLYPH : STEP_ENABLED_GLYPH;
+}
+
+/*
+* Forget the positions of the fields of the default screens, when another screen is printed over them
+*/
+void ScreenManager::clearDefaultScreenFields()
+{
+    _tempoPosition = 0;
+    _gridStep = NO_GRID_STEP;
+    _meterView = NO_METER_VIEW;
+    _dirtyMeters = 0;
+}
+
+/*
+* Prints step data in edit mode
+*/
+void ScreenManager::printEditStepData(Step step, uint8_t currentStep, uint8_t sequenceLength)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+    clearDefaultScreenFields();
+
+    // set to the screen manager the position of the step being edited
+    _currentDisplayedStep = currentStep;
+
+    //Set the cursor on the top left of the screen
+    _lcd.setCursor(0, 0);
+
+    // prints the step number and note value. The step number is a fixed-width field, so the sequence length is always on the same position
+    line.appendText(getMessage(MSG_STEP));
+    line.appendNumber(currentStep, STEP_DIGITS);
+    line.append('/');
+    line.appendNumber(sequenceLength);
+    line.padTo(STEP_NOTE_POS);
+    appendNote(line, step.getNote());
+
+    _lcd.print(line.finish());
+
+    // prints step's enabled and legato values
+    printStepFlags(step);
+
+    // move cursor to step note value position
+    _lcd.setCursor(STEP_NOTE_POS, 0);
+    _lcd.blink();
+}
+
+/*
+* Prints the legato and enabled values of a step on the second line of the step edit screen
+* step: the step
+*/
+void ScreenManager::printStepFlags(Step step)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+
+    _lcd.noBlink();
+    _lcd.setCursor(0, 1);
+
+    line.appendText(getMessage(MSG_STEP_LEGATO));
+    line.appendText(getMessage(step.isLegato() ? YES : NO));
+    line.padTo(STEP_ENABLED_POS);
+    line.appendText(getMessage(MSG_STEP_ENABLED));
+    line.appendText(getMessage(step.isEnabled() ? YES : NO));
+
+    _lcd.print(line.finish());
+    _lcd.blink();
+}
+
+/*
+* Prints the velocity, probability and ratchets values of a step on the second line of the step edit screen
+* step: the step
+*/
+void ScreenManager::printStepParameters(Step step)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+
+    _lcd.noBlink();
+    _lcd.setCursor(0, 1);
+
+    line.appendText(getMessage(MSG_VELOCITY));
+    line.appendNumber(step.getVelocity());
+    line.padTo(STEP_PROBABILITY_POS);
+    line.appendText(getMessage(MSG_PROBABILITY));
+    line.appendNumber(getProbabilityPercent(step.getProbability()));
+    line.padTo(STEP_RATCHETS_POS);
+    line.appendText(getMessage(MSG_RATCHETS));
+    line.appendNumber(step.getRatchets());
+
+    _lcd.print(line.finish());
+    _lcd.blink();
+}
+
+/*
+* Returns the percentage of times a step is played regarding its probability level
+* probability: the probability level, from 0 (1 out of 16) to 15 (always)
+*/
+uint8_t ScreenManager::getProbabilityPercent(uint8_t probability)
+{
+    return ((probability + 1) * 100) / 16;
 }
 
 /*
@@ -913,252 +1487,486 @@ uint8_t ScreenManager::getDisplayedStepNumber()
 
 void ScreenManager::moveCursorToStepNote()
 {
+    flushRefresh();
+
     _lcd.setCursor(STEP_NOTE_POS, 0);
 }
 
 void ScreenManager::moveCursorToStepLegato()
 {
-    char buffer[10];
+    flushRefresh();
 
     _lcd.setCursor(STEP_LEGATO_POS, 1);
 }
 
 void ScreenManager::moveCursorToStepEnabled()
 {
-    char buffer[10];
+    flushRefresh();
 
-    getMessage(MSG_STEP_ENABLED, buffer);
-    _lcd.setCursor(STEP_ENABLED_POS + strlen(buffer), 1);
+    _lcd.setCursor(STEP_ENABLED_POS + getMessageLength(MSG_STEP_ENABLED), 1);
 }
 
-void ScreenManager::refreshStepNoteValue(uint8_t note)
+/*
+* Move the screen cursor to the sequence length, after the displayed step number
+*/
+void ScreenManager::moveCursorToStepLength()
 {
-    char line[COLUMNS + 1];
+    flushRefresh();
+
+    _lcd.setCursor(STEP_LENGTH_POS, 0);
+}
+
+/*
+* Mark the length of the edited sequence as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* length: the new value
+*/
+void ScreenManager::refreshStepLengthValue(uint8_t length)
+{
+    deferRefresh(STEP_LENGTH_FIELD, length);
+}
+
+void ScreenManager::drawStepLengthValue(uint8_t length)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, STEP_NOTE_POS - STEP_LENGTH_POS);
 
     _lcd.noBlink();
 
-    strcpy(line, MIDIUtils::getNoteName(note));
-    itoa(MIDIUtils::getOctave(note), line + strlen(line), DEC);
+    line.appendNumber(length);
 
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    _lcd.print(line.finish());
 
-    _lcd.print(line);
+    moveCursorToStepLength();
+    _lcd.blink();
+}
+
+/*
+* Mark the note of the edited step as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* note: the new value
+*/
+void ScreenManager::refreshStepNoteValue(uint8_t note)
+{
+    deferRefresh(STEP_NOTE_FIELD, note);
+}
+
+void ScreenManager::drawStepNoteValue(uint8_t note)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS - STEP_NOTE_POS);
+
+    _lcd.noBlink();
+
+    appendNote(line, note);
+
+    _lcd.print(line.finish());
 
     moveCursorToStepNote();
     _lcd.blink();
 }
 
+/*
+* Mark the legato value of the edited step as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* legato: the new value
+*/
 void ScreenManager::refreshStepLegatoValue(uint8_t legato)
 {
-    char line[COLUMNS + 1];
-
-    _lcd.noBlink();
+    deferRefresh(STEP_LEGATO_FIELD, legato);
+}
 
-    if (legato == 0)
-    {
-        getMessage(NO, line);
-    }
+void ScreenManager::drawStepLegatoValue(uint8_t legato)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, STEP_ENABLED_POS - STEP_LEGATO_POS);
 
-    else
-    {
-        getMessage(YES, line);
-    }
+    _lcd.noBlink();
 
-    for (int i = STEP_LEGATO_POS + strlen(line); i < STEP_ENABLED_POS; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendText(getMessage(legato == 0 ? NO : YES));
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     moveCursorToStepLegato();
     _lcd.blink();
 }
 
+/*
+* Mark the enabled value of the edited step as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* enabled: the new value
+*/
 void ScreenManager::refreshStepEnabledValue(uint8_t enabled)
 {
-    char line[COLUMNS + 1];
+    deferRefresh(STEP_ENABLED_FIELD, enabled);
+}
+
+void ScreenManager::drawStepEnabledValue(uint8_t enabled)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS - STEP_ENABLED_POS - getMessageLength(MSG_STEP_ENABLED));
 
     _lcd.noBlink();
 
-    if (enabled == 0)
-    {
-        getMessage(NO, line);
-    }
+    line.appendText(getMessage(enabled == 0 ? NO : YES));
 
-    else
-    {
-        getMessage(YES, line);
-    }
+    _lcd.print(line.finish());
 
-    for (int i = STEP_ENABLED_POS + strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    moveCursorToStepEnabled();
+    _lcd.blink();
+}
 
-    _lcd.print(line);
+void ScreenManager::moveCursorToStepVelocity()
+{
+    flushRefresh();
 
-    moveCursorToStepEnabled();
+    _lcd.setCursor(STEP_VELOCITY_POS + getMessageLength(MSG_VELOCITY), 1);
+}
+
+void ScreenManager::moveCursorToStepProbability()
+{
+    flushRefresh();
+
+    _lcd.setCursor(STEP_PROBABILITY_POS + getMessageLength(MSG_PROBABILITY), 1);
+}
+
+void ScreenManager::moveCursorToStepRatchets()
+{
+    flushRefresh();
+
+    _lcd.setCursor(STEP_RATCHETS_POS + getMessageLength(MSG_RATCHETS), 1);
+}
+
+/*
+* Mark the velocity of the edited step as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* velocity: the new value
+*/
+void ScreenManager::refreshStepVelocityValue(uint8_t velocity)
+{
+    deferRefresh(STEP_VELOCITY_FIELD, velocity);
+}
+
+void ScreenManager::drawStepVelocityValue(uint8_t velocity)
+{
+    char buffer[MIDI_VALUE_DIGITS + 1];
+    LineBuilder line(buffer, MIDI_VALUE_DIGITS);
+
+    _lcd.noBlink();
+
+    line.appendNumber(velocity);
+
+    _lcd.print(line.finish());
+
+    moveCursorToStepVelocity();
+    _lcd.blink();
+}
+
+/*
+* Mark the probability level of the edited step as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* probability: the new value
+*/
+void ScreenManager::refreshStepProbabilityValue(uint8_t probability)
+{
+    deferRefresh(STEP_PROBABILITY_FIELD, probability);
+}
+
+void ScreenManager::drawStepProbabilityValue(uint8_t probability)
+{
+    char buffer[MIDI_VALUE_DIGITS + 1];
+    LineBuilder line(buffer, MIDI_VALUE_DIGITS);
+
+    _lcd.noBlink();
+
+    line.appendNumber(getProbabilityPercent(probability));
+
+    _lcd.print(line.finish());
+
+    moveCursorToStepProbability();
     _lcd.blink();
 }
 
-void ScreenManager::printEditSequencerConfig(char *playbackModeName, char *stepSizeName, uint8_t midiChannel, uint8_t sendClockWhilePlayback)
+/*
+* Mark the ratchets of the edited step as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* ratchets: the new value
+*/
+void ScreenManager::refreshStepRatchetsValue(uint8_t ratchets)
 {
-    char line[COLUMNS + 1];
+    deferRefresh(STEP_RATCHETS_FIELD, ratchets);
+}
+
+void ScreenManager::drawStepRatchetsValue(uint8_t ratchets)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS - STEP_RATCHETS_POS - getMessageLength(MSG_RATCHETS));
+
+    _lcd.noBlink();
+
+    line.appendNumber(ratchets);
+
+    _lcd.print(line.finish());
+
+    moveCursorToStepRatchets();
+    _lcd.blink();
+}
+
+void ScreenManager::printEditSequencerConfig(const __FlashStringHelper *playbackModeName, const __FlashStringHelper *stepSizeName, uint8_t midiChannel, uint8_t sendClockWhilePlayback)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+    clearDefaultScreenFields();
 
     //Set the cursor on the top left of the screen
     _lcd.setCursor(0, 0);
 
     // prints the sequencer playback mode
-    getMessage(MSG_PLAYBACK_MODE, line);
-    strcat(line + strlen(line), playbackModeName);
-
-    for (int i = strlen(line); i < SEQUENCER_EDIT_SEND_CLOCK_POS; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendText(getMessage(MSG_PLAYBACK_MODE));
+    line.appendText(playbackModeName);
+    line.padTo(SEQUENCER_EDIT_SEND_CLOCK_POS);
 
     // prints wether or not send MIDI clock when sequencer playback starts
-    getMessage(MSG_CLK, line + strlen(line));
-    sendClockWhilePlayback ? getMessage(YES, line + strlen(line)) : getMessage(NO, line + strlen(line));
-
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendText(getMessage(MSG_CLK));
+    line.appendText(getMessage(sendClockWhilePlayback ? YES : NO));
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     // prints the step size
     _lcd.setCursor(0, 1);
 
-    line[0] = '\0';
+    line.clear();
 
-    getMessage(MSG_STEP_SIZE, line);
-    strcat(line + strlen(line), stepSizeName);
-
-    for (int i = strlen(line); i < SEQUENCER_EDIT_MIDI_CHANNEL_POS; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendText(getMessage(MSG_STEP_SIZE));
+    line.appendText(stepSizeName);
+    line.padTo(SEQUENCER_EDIT_MIDI_CHANNEL_POS);
 
     // prints the MIDI Channel
-    getMessage(MSG_CHANNEL, line + strlen(line));
-    itoa(midiChannel, line + strlen(line), DEC);
+    line.appendText(getMessage(MSG_CHANNEL));
+    line.appendNumber(midiChannel);
 
-    for (int i = strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
-
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     _lcd.setCursor(SEQUENCER_EDIT_PLAYBACK_MODE_POS, 0);
     _lcd.blink();
 }
 
+/*
+* Prints the parameters of the euclidean pattern of the selected track on the second line of the sequencer configuration screen
+* hits: number of hits of the pattern
+* steps: number of steps of the pattern
+* rotation: steps the pattern is rotated to the right
+*/
+void ScreenManager::printEuclideanParameters(uint8_t hits, uint8_t steps, uint8_t rotation)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+
+    _lcd.noBlink();
+    _lcd.setCursor(0, 1);
+
+    line.appendText(getMessage(MSG_HITS));
+    line.appendNumber(hits);
+    line.padTo(SEQUENCER_EDIT_EUCLIDEAN_STEPS_POS);
+    line.appendText(getMessage(MSG_EUCLIDEAN_STEPS));
+    line.appendNumber(steps);
+    line.padTo(SEQUENCER_EDIT_EUCLIDEAN_ROTATION_POS);
+    line.appendText(getMessage(MSG_ROTATION));
+    line.appendNumber(rotation);
+
+    _lcd.print(line.finish());
+    _lcd.blink();
+}
+
+void ScreenManager::moveCursorToEuclideanHits()
+{
+    flushRefresh();
+
+    _lcd.setCursor(SEQUENCER_EDIT_EUCLIDEAN_HITS_POS + getMessageLength(MSG_HITS), 1);
+}
+
+void ScreenManager::moveCursorToEuclideanSteps()
+{
+    flushRefresh();
+
+    _lcd.setCursor(SEQUENCER_EDIT_EUCLIDEAN_STEPS_POS + getMessageLength(MSG_EUCLIDEAN_STEPS), 1);
+}
+
+void ScreenManager::moveCursorToEuclideanRotation()
+{
+    flushRefresh();
+
+    _lcd.setCursor(SEQUENCER_EDIT_EUCLIDEAN_ROTATION_POS + getMessageLength(MSG_ROTATION), 1);
+}
+
 void ScreenManager::moveCursorToPlayBackMode()
 {
+    flushRefresh();
+
     _lcd.setCursor(SEQUENCER_EDIT_PLAYBACK_MODE_POS, 0);
 }
 
 void ScreenManager::moveCursorToSendClockWhilePlayback()
 {
-    char buffer[10];
+    flushRefresh();
 
-    getMessage(MSG_CLK, buffer);
-    _lcd.setCursor(SEQUENCER_EDIT_SEND_CLOCK_POS + strlen(buffer), 0);
+    _lcd.setCursor(SEQUENCER_EDIT_SEND_CLOCK_POS + getMessageLength(MSG_CLK), 0);
 }
 
 void ScreenManager::moveCursorToStepSize()
 {
+    flushRefresh();
+
     _lcd.setCursor(SEQUENCER_EDIT_STEP_SIZE_POS, 1);
 }
 
 void ScreenManager::moveCursorToSequencerMIDIChannel()
 {
-    char buffer[10];
+    flushRefresh();
 
-    getMessage(MSG_CHANNEL, buffer);
-    _lcd.setCursor(SEQUENCER_EDIT_MIDI_CHANNEL_POS + strlen(buffer), 1);
+    _lcd.setCursor(SEQUENCER_EDIT_MIDI_CHANNEL_POS + getMessageLength(MSG_CHANNEL), 1);
 }
 
-void ScreenManager::refreshDisplayedPlayBackMode(char *playBackMode)
+void ScreenManager::refreshDisplayedPlayBackMode(const __FlashStringHelper *playBackMode)
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, SEQUENCER_EDIT_SEND_CLOCK_POS - SEQUENCER_EDIT_PLAYBACK_MODE_POS);
 
-    _lcd.noBlink();
+    flushRefresh();
 
-    strcpy(line, playBackMode);
+    _lcd.noBlink();
 
-    for (int i = SEQUENCER_EDIT_PLAYBACK_MODE_POS + strlen(line); i < SEQUENCER_EDIT_SEND_CLOCK_POS; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendText(playBackMode);
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     moveCursorToPlayBackMode();
     _lcd.blink();
 }
 
+/*
+* Mark the send clock while playback value as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* sendClockWhilePlayback: the new value
+*/
 void ScreenManager::refreshDisplayedSendClockWhilePlayback(uint8_t sendClockWhilePlayback)
 {
-    char line[COLUMNS + 1];
+    deferRefresh(SEND_CLOCK_FIELD, sendClockWhilePlayback);
+}
 
-    _lcd.noBlink();
+void ScreenManager::drawSendClockWhilePlayback(uint8_t sendClockWhilePlayback)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS - SEQUENCER_EDIT_SEND_CLOCK_POS - getMessageLength(MSG_CLK));
 
-    sendClockWhilePlayback ? getMessage(YES, line) : getMessage(NO, line);
+    _lcd.noBlink();
 
-    for (int i = SEQUENCER_EDIT_SEND_CLOCK_POS + strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendText(getMessage(sendClockWhilePlayback ? YES : NO));
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     moveCursorToSendClockWhilePlayback();
     _lcd.blink();
 
 }
 
-void ScreenManager::refreshDisplayedStepSizeValue(char *stepSize)
+void ScreenManager::refreshDisplayedStepSizeValue(const __FlashStringHelper *stepSize)
 {
-    char line[COLUMNS + 1];
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, SEQUENCER_EDIT_MIDI_CHANNEL_POS - SEQUENCER_EDIT_STEP_SIZE_POS);
+
+    flushRefresh();
 
     _lcd.noBlink();
 
-    strcpy(line, stepSize);
+    line.appendText(stepSize);
 
-    for (int i = SEQUENCER_EDIT_STEP_SIZE_POS + strlen(line); i < SEQUENCER_EDIT_MIDI_CHANNEL_POS; i++)
-    {
-        append(line, ' ');
-    }
-
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     moveCursorToStepSize();
     _lcd.blink();
 }
 
+/*
+* Mark the sequencer MIDI channel as dirty. It is drawn on the next screen refresh, so consecutive changes are drawn once
+* midiChannel: the new value
+*/
 void ScreenManager::refreshDisplayedSequencerMidiChannel(uint8_t midiChannel)
 {
-    char line[COLUMNS + 1];
+    deferRefresh(SEQUENCER_MIDI_CHANNEL_FIELD, midiChannel);
+}
 
-    _lcd.noBlink();
+void ScreenManager::drawSequencerMidiChannel(uint8_t midiChannel)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS - SEQUENCER_EDIT_MIDI_CHANNEL_POS - getMessageLength(MSG_CHANNEL));
 
-    itoa(midiChannel, line, DEC);
+    _lcd.noBlink();
 
-    for (int i = SEQUENCER_EDIT_MIDI_CHANNEL_POS + strlen(line); i < COLUMNS; i++)
-    {
-        append(line, ' ');
-    }
+    line.appendNumber(midiChannel);
 
-    _lcd.print(line);
+    _lcd.print(line.finish());
 
     moveCursorToSequencerMIDIChannel();
     _lcd.blink();
-}
\ No newline at end of file
+}
+
+/**************************************************/
+/* ARPEGGIATOR METHODS                            */
+/**************************************************/
+
+/*
+* Prints the arpeggiator parameters
+* mode: name of the playback order
+* octaves: number of octaves the held notes are played over
+* rate: notes played within a quarter note
+*/
+void ScreenManager::printArpeggiator(const __FlashStringHelper *mode, uint8_t octaves, uint8_t rate)
+{
+    char buffer[COLUMNS + 1];
+    LineBuilder line(buffer, COLUMNS);
+
+    flushRefresh();
+    clearDefaultScreenFields();
+
+    _lcd.noBlink();
+    _lcd.setCursor(0, 0);
+
+    line.appendText(getMessage(MSG_ARPEGGIATOR));
+    line.appendText(mode);
+    line.padTo(ARPEGGIATOR_OCTAVES_POS);
+    line.appendText(getMessage(MSG_OCTAVES));
+    line.appendNumber(octaves);
+
+    _lcd.print(line.finish());
+
+    // the rate is displayed as the note length of each arpeggio note
+    _lcd.setCursor(0, 1);
+
+    line.clear();
+
+    line.appendText(getMessage(MSG_RATE));
+    line.append('1');
+    line.append('/');
+    line.appendNumber(rate * 4);
+
+    _lcd.print(line.finish());
+    _lcd.blink();
+}
+
+void ScreenManager::moveCursorToArpeggiatorMode()
+{
+    flushRefresh();
+
+    _lcd.setCursor(ARPEGGIATOR_MODE_POS + getMessageLength(MSG_ARPEGGIATOR), 0);
+}
+
+void ScreenManager::moveCursorToArpeggiatorOctaves()
+{
+    flushRefresh();
+
+    _lcd.setCursor(ARPEGGIATOR_OCTAVES_POS + getMessageLength(MSG_OCTAVES), 0);
+}
+
+void ScreenManager::moveCursorToArpeggiatorRate()
+{
+    flushRefresh();
+
+    _lcd.setCursor(ARPEGGIATOR_RATE_POS + getMessageLength(MSG_RATE), 1);
+}
@@ -31,6 +31,8 @@
 #include <GlobalConfig.h>
 #include <Step.h>
 #include <ControllerConfig.h>
+#include <LineBuilder.h>
+#include <I2CBusManager.h>
 #include <stdlib.h>
 
 #define MSG_PAGE 0
@@ -62,6 +64,24 @@
 #define OFF 26
 #define MSG_PLAYBACK 27
 #define MSG_CLK 28
+#define MSG_NRPN 29
+#define MSG_RPN 30
+#define MSG_PARAM_MSB 31
+#define MSG_PARAM_LSB 32
+#define MSG_TRACK 33
+#define MSG_MEMORY_FULL 34
+#define MSG_PROBABILITY 35
+#define MSG_RATCHETS 36
+#define MSG_HITS 37
+#define MSG_EUCLIDEAN_STEPS 38
+#define MSG_ROTATION 39
+#define MSG_SONG 40
+#define MSG_RECORD 41
+#define MSG_ARPEGGIATOR 42
+#define MSG_OCTAVES 43
+#define MSG_RATE 44
+#define MSG_TRANSPOSE 45
+#define MSG_SCALE_LOCK 46
 
 // Messages that will be displayed on the screen that are stored into the PROGMEM
 const char msg_Page[] PROGMEM = "Pg:";
@@ -93,11 +113,41 @@ const char msg_On[] PROGMEM = "On";
 const char msg_Off[] PROGMEM = "Off";
 const char msg_Playback[] PROGMEM = "Playback:";
 const char msg_Clk[] PROGMEM = "Clk:";
+const char msg_Nrpn[] PROGMEM = "NRPN";
+const char msg_Rpn[] PROGMEM = "RPN";
+const char msg_ParamMsb[] PROGMEM = "Msb:";
+const char msg_ParamLsb[] PROGMEM = "Lsb:";
+const char msg_Track[] PROGMEM = "T:";
+const char msg_MemoryFull[] PROGMEM = "MEMORY FULL!";
+const char msg_Probability[] PROGMEM = "P:";
+const char msg_Ratchets[] PROGMEM = "R:";
+const char msg_Hits[] PROGMEM = "H:";
+const char msg_EuclideanSteps[] PROGMEM = "S:";
+const char msg_Rotation[] PROGMEM = "Rot:";
+const char msg_Song[] PROGMEM = "Sng:";
+const char msg_Record[] PROGMEM = "Record:";
+const char msg_Arpeggiator[] PROGMEM = "Arp:";
+const char msg_Octaves[] PROGMEM = "Oct:";
+const char msg_Rate[] PROGMEM = "Rate:";
+const char msg_Transpose[] PROGMEM = "Transpose:";
+const char msg_ScaleLock[] PROGMEM = "Scale lock:";
 
 const char *const messages[] PROGMEM = {msg_Page, msg_Tempo, msg_Bpm, msg_Edit1, msg_Edit2, msg_MsgChannel, msg_NoteOnOff, msg_CtrlChange,
                                         msg_CC, msg_PgrmChange, msg_PGM, msg_Velocity, msg_saved, msg_empty_midi_type, msg_mode, msg_key, msg_seq, 
                                         msg_step, msg_step_legato, msg_step_enabled, msg_playback_mode, msg_step_size, msg_Yes, msg_No, msg_Clock, 
-                                        msg_On, msg_Off, msg_Playback, msg_Clk};
+                                        msg_On, msg_Off, msg_Playback, msg_Clk, msg_Nrpn, msg_Rpn, msg_ParamMsb, msg_ParamLsb, msg_Track, msg_MemoryFull, msg_Probability, msg_Ratchets,
+                                        msg_Hits, msg_EuclideanSteps, msg_Rotation, msg_Song, msg_Record,
+                                        msg_Arpeggiator, msg_Octaves, msg_Rate, msg_Transpose, msg_ScaleLock};
+
+// Glyphs of the step grid and the CC meters, loaded into the CGRAM of the screen
+const uint8_t glyphs[][8] PROGMEM = {{0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x00, 0x00},  // enabled step
+                                     {0x00, 0x00, 0x1F, 0x11, 0x11, 0x1F, 0x00, 0x00},  // disabled step
+                                     {0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x00, 0x1F},  // legato step
+                                     {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},  // current step
+                                     {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10},  // meter cell with 1 column
+                                     {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // meter cell with 2 columns
+                                     {0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C},  // meter cell with 3 columns
+                                     {0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E}}; // meter cell with 4 columns
 
 class ScreenManager
 {
@@ -107,7 +157,12 @@ public:
   void printSelectComponentMessage();
   void printEditGlobalConfig(GlobalConfig globalConf);
   void printSavedMessage();
+  void printMemoryFullMessage();
   void cleanScreen();
+  uint8_t isReady();
+  void refresh();
+  void refreshTempo(uint16_t tempo);
+  void refreshMeter(uint8_t meter, uint8_t value);
   uint8_t isComponentDisplayed();
   void displayPreviousMIDIMsg();
   void displayNextMIDIMsg();
@@ -127,6 +182,10 @@ public:
   void moveCursorToMode();
   void refreshVelocityValue(uint8_t velocity);
   void refreshCCValue(uint8_t cc);
+  void moveCursorToParameterMSB();
+  void moveCursorToParameterLSB();
+  void refreshParameterMSBValue(uint8_t msb);
+  void refreshParameterLSBValue(uint8_t lsb);
   void refreshChannelValue(uint8_t channel);
   void moveCursorToVelocity();
   void refreshModeData(uint8_t mode);
@@ -134,41 +193,151 @@ public:
   void refreshMIDIChannelData(uint8_t midiChannel);
 
   // SEQUENCER METHODS
-  void printDefaultSequencer(uint8_t currentSequence, uint8_t totalSequences, uint16_t tempo, uint8_t playBackOn);
-  void printEditSequencerConfig(char *playbackModeName, char *stepSizeName, uint8_t midiChannel, uint8_t sendClockWhilePlayback);
-  void updateDisplayedPlaybackStep(Step step, uint8_t sequenceLength, uint8_t currentStep);
+  void printTranspose(int8_t transpose, uint8_t scaleLock);
+  void printDefaultSequencer(uint8_t currentSequence, uint8_t totalSequences, uint16_t tempo, uint8_t playBackOn, uint8_t recording, uint8_t track, uint8_t songMode);
+  void printEditSequencerConfig(const __FlashStringHelper *playbackModeName, const __FlashStringHelper *stepSizeName, uint8_t midiChannel, uint8_t sendClockWhilePlayback);
+  void printStepGrid(Step *steps, uint8_t sequenceLength, uint8_t currentStep);
+  void updateDisplayedPlaybackStep(Step *steps, uint8_t sequenceLength, uint8_t currentStep);
   void printEditStepData(Step step, uint8_t currentStep, uint8_t sequenceLength);
+  void printStepFlags(Step step);
+  void printStepParameters(Step step);
   void moveCursorToStepNote();
   void moveCursorToStepLegato();
   void moveCursorToStepEnabled();
+  void moveCursorToStepLength();
+  void moveCursorToStepVelocity();
+  void moveCursorToStepProbability();
+  void moveCursorToStepRatchets();
   void moveCursorToPlayBackMode();
   void moveCursorToSendClockWhilePlayback();
   void moveCursorToStepSize();
   void moveCursorToSequencerMIDIChannel();
+  void printEuclideanParameters(uint8_t hits, uint8_t steps, uint8_t rotation);
+  void moveCursorToEuclideanHits();
+  void moveCursorToEuclideanSteps();
+  void moveCursorToEuclideanRotation();
+  void printArpeggiator(const __FlashStringHelper *mode, uint8_t octaves, uint8_t rate);
+  void moveCursorToArpeggiatorMode();
+  void moveCursorToArpeggiatorOctaves();
+  void moveCursorToArpeggiatorRate();
   void refreshStepNoteValue(uint8_t note);
   void refreshStepLegatoValue(uint8_t legato);
   void refreshStepEnabledValue(uint8_t enabled);
-  void refreshDisplayedPlayBackMode(char *playBackMode);
+  void refreshStepLengthValue(uint8_t length);
+  void refreshStepVelocityValue(uint8_t velocity);
+  void refreshStepProbabilityValue(uint8_t probability);
+  void refreshStepRatchetsValue(uint8_t ratchets);
+  void refreshDisplayedPlayBackMode(const __FlashStringHelper *playBackMode);
   void refreshDisplayedSendClockWhilePlayback(uint8_t sendClockWhilePlayback);
-  void refreshDisplayedStepSizeValue(char *stepSize);
+  void refreshDisplayedStepSizeValue(const __FlashStringHelper *stepSize);
   void refreshDisplayedSequencerMidiChannel(uint8_t midiChannel);
 
   uint8_t getDisplayedStepNumber();
 
 private:
-  void getMessage(uint8_t msgIndex, char *buffer);
-  void append(char *s, char c);
+  const __FlashStringHelper *getMessage(uint8_t msgIndex);
+  uint8_t getMessageLength(uint8_t msgIndex);
+  void printFullScreenMessage(uint8_t msgIndex);
+  uint8_t getProbabilityPercent(uint8_t probability);
   void printNoteOnOffMIDIData(MIDIMessage message);
   void printCCMIDIData(MIDIMessage message);
   void printPCMIDIData(MIDIMessage message);
+  void printParameterNumberMIDIData(MIDIMessage message);
   void clearRangeOnCurentLine(uint8_t row, uint8_t from, uint8_t to);
-  char *getStepNoteValue(Step step);
+  void deferRefresh(uint8_t field, uint16_t value);
+  void flushRefresh();
+  void drawTempo(uint16_t tempo);
+  void drawNoteValue(uint8_t note);
+  void drawVelocityValue(uint8_t velocity);
+  void drawCCValue(uint8_t cc);
+  void drawParameterMSBValue(uint8_t msb);
+  void drawParameterLSBValue(uint8_t lsb);
+  void drawModeData(uint8_t mode);
+  void drawRootNoteData(uint8_t rootNote);
+  void drawMIDIChannelData(uint8_t midiChannel);
+  void drawStepNoteValue(uint8_t note);
+  void drawStepLegatoValue(uint8_t legato);
+  void drawStepEnabledValue(uint8_t enabled);
+  void drawStepLengthValue(uint8_t length);
+  void drawStepVelocityValue(uint8_t velocity);
+  void drawStepProbabilityValue(uint8_t probability);
+  void drawStepRatchetsValue(uint8_t ratchets);
+  void drawSendClockWhilePlayback(uint8_t sendClockWhilePlayback);
+  void drawSequencerMidiChannel(uint8_t midiChannel);
+  void appendNote(LineBuilder &line, uint8_t note);
+  void writeGlyphCell(uint8_t cell, uint8_t glyph);
+  uint8_t getStepGlyph(Step step);
+  void flushMeters();
+  void printMeters();
+  void drawMeter(uint8_t meter);
+  uint8_t getMeterGlyph(uint8_t meter, uint8_t cell);
+  void clearDefaultScreenFields();
 
   hd44780_I2Cexp _lcd;
 
   IMIDIComponent *_displayedMIDIComponent; // MIDI component currently assigned to the screen
   uint8_t _currentMIDIMessageDisplayed;    // MIDI message currently displayed on the screen
   uint8_t _currentDisplayedStep;           // Step currently displayed on the screen
+  uint8_t _dirtyField;                     // field waiting to be drawn on the next screen refresh
+  uint16_t _dirtyValue;                    // value of the field waiting to be drawn
+  uint32_t _lastRefreshTime;               // time (ms) of the last refresh of a dirty field
+  uint8_t _tempoPosition;                  // screen position of the tempo on the displayed default screen, 0 if another screen is displayed
+  uint8_t _gridStep;                       // current step of the displayed step grid, NO_GRID_STEP if the grid is not displayed
+  uint8_t _glyphCells[COLUMNS];            // chars displayed on the second line by the step grid or the meter view
+  uint8_t _meterValues[NUM_MIDI_POTS];     // last CC value sent by each MIDI potentiometer
+  uint8_t _dirtyMeters;                    // meters (one bit each) waiting to be drawn on the next screen refresh
+  uint8_t _meterView;                      // status of the meter view on the second line of the controller default screen
+
+  enum
+  {
+    NO_FIELD,
+    TEMPO_FIELD,
+    NOTE_FIELD,
+    VELOCITY_FIELD,
+    CC_FIELD,
+    PARAM_MSB_FIELD,
+    PARAM_LSB_FIELD,
+    MODE_FIELD,
+    ROOT_NOTE_FIELD,
+    MIDI_CHANNEL_FIELD,
+    STEP_NOTE_FIELD,
+    STEP_LEGATO_FIELD,
+    STEP_ENABLED_FIELD,
+    STEP_LENGTH_FIELD,
+    STEP_VELOCITY_FIELD,
+    STEP_PROBABILITY_FIELD,
+    STEP_RATCHETS_FIELD,
+    SEND_CLOCK_FIELD,
+    SEQUENCER_MIDI_CHANNEL_FIELD
+  }; // Fields that are drawn on the screen refresh, after being changed with the select value potentiometer
+  enum
+  {
+    STEP_ENABLED_GLYPH,
+    STEP_DISABLED_GLYPH,
+    STEP_LEGATO_GLYPH,
+    CURRENT_STEP_GLYPH,
+    METER_GLYPH,
+    GLYPHS = 8
+  }; // CGRAM chars of the glyphs. METER_GLYPH is the first of the partial meter cells, from 1 to GLYPH_COLUMNS - 1 columns
+  enum
+  {
+    GLYPH_COLUMNS = 5,
+    FULL_CELL = 0xFF
+  }; // pixel columns of a char, and the char of the screen ROM with all its pixels on
+  enum
+  {
+    METER_CELLS = (COLUMNS - NUM_MIDI_POTS + 1) / NUM_MIDI_POTS
+  }; // cells of each meter of the meter view, with a blank cell between two meters
+  enum
+  {
+    NO_METER_VIEW,
+    METER_VIEW_HIDDEN,
+    METER_VIEW_SHOWN
+  }; // meter view status: the controller default screen is not displayed, it displays the MIDI clock status or the meters
+  enum
+  {
+    NO_GRID_STEP = 0xFF
+  }; // current step of the step grid when it is not displayed
 
   enum
   {
@@ -188,6 +357,11 @@ private:
     PROGRAM_CHANNEL_POS = 0
   }; // Screen start position of the Program Change message parameters
   enum
+  {
+    PARAM_MSB_POS = 0,
+    PARAM_LSB_POS = 8
+  }; // Screen start position of the NRPN/RPN parameter number
+  enum
   {
     EDIT_GLOBAL_MODE_POS = 5,
     EDIT_GLOBAL_KEY_POS = 4,
@@ -196,16 +370,41 @@ private:
   enum
   {
     STEP_NUM_POS = 5,
+    STEP_LENGTH_POS = 8,
     STEP_NOTE_POS = 11,
     STEP_ENABLED_POS = 9,
-    STEP_LEGATO_POS = 4
+    STEP_LEGATO_POS = 4,
+    STEP_VELOCITY_POS = 0,
+    STEP_PROBABILITY_POS = 6,
+    STEP_RATCHETS_POS = 12
   }; // Sequencer screen start position of the sequence step values
   enum
   {
     SEQUENCER_EDIT_PLAYBACK_MODE_POS = 5,
     SEQUENCER_EDIT_SEND_CLOCK_POS = 9,
     SEQUENCER_EDIT_STEP_SIZE_POS = 5,
-    SEQUENCER_EDIT_MIDI_CHANNEL_POS = 10
+    SEQUENCER_EDIT_MIDI_CHANNEL_POS = 10,
+    SEQUENCER_EDIT_EUCLIDEAN_HITS_POS = 0,
+    SEQUENCER_EDIT_EUCLIDEAN_STEPS_POS = 5,
+    SEQUENCER_EDIT_EUCLIDEAN_ROTATION_POS = 10
   }; // Screen start position of the Sequencer Config parameters
+  enum
+  {
+    SEQUENCER_TRACK_POS = 13
+  }; // Screen start position of the selected track on the sequencer default screen
+  enum
+  {
+    ARPEGGIATOR_MODE_POS = 0,
+    ARPEGGIATOR_OCTAVES_POS = 9,
+    ARPEGGIATOR_RATE_POS = 0
+  }; // Screen start position of the Arpeggiator parameters
+  enum
+  {
+    PAGE_DIGITS = 2,
+    BPM_DIGITS = 3,
+    STEP_DIGITS = 2,
+    CHANNEL_DIGITS = 2,
+    MIDI_VALUE_DIGITS = 3
+  }; // Columns of the fixed-width number fields
 };
 #endif
\ No newline at end of file
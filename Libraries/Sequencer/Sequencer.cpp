@@ -1,7 +1,8 @@
 /*
  * Sequencer.h
  *
- * Step sequencer implementation allowing three different playback modes (Forward, Backward and Random) and different step sizes (1/4, 1/8, 1/16 and 1/32) 
+ * Step sequencer implementation allowing six different playback modes (Forward, Backward, Random, Ping-Pong, Random Walk and Shuffle) and different step sizes (1/4, 1/8, 1/16 and 1/32) 
+ * The sequencer plays up to four tracks at the same time, each one with its own sequence, MIDI channel, playback mode and step size
  *
  * Copyright 2018 3K MEDIALAB
  *   
@@ -19,27 +20,81 @@
  */
 #include "Sequencer.h"
 
+// advance functions of the playback modes, in the same order as the modes
+const Sequencer::AdvanceFunction Sequencer::advanceFunctions[PLAYBACK_MODE_TYPES] PROGMEM = {
+    &Sequencer::advanceForward,
+    &Sequencer::advanceBackward,
+    &Sequencer::advanceRandom,
+    &Sequencer::advancePingPong,
+    &Sequencer::advanceRandomWalk,
+    &Sequencer::advanceShuffle};
+
 Sequencer::Sequencer(uint8_t mode, uint8_t stepSize, MemoryManager *memoryManager, ScreenManager *screenManager)
 {
     _playBackOn = 0;
-    _stepSize = stepSize;
-    _playBackMode = mode;
-    _currentSequence = 1;
-    _stopCurrentPlayedNote = 0;
-    _loadNewSequence = 0;
-
-    switch (_playBackMode)
+    _selectedTrack = 0;
+    _coveredTracks = 0;
+    _loadTracks = 0;
+    _loadingTrack = NO_TRACK;
+    _loadingStep = 0;
+    _renderedTracks = 0;
+    _renderedLegato = 0;
+    _randomState = 1;
+    _recording = 0;
+    _transpose = 0;
+    _scaleLock = 0;
+    _scaleRootNote = MIDIUtils::C;
+    _scaleMode = MIDIUtils::Chromatic;
+    _clockTicks = 0;
+    _recordHead = 0;
+    _recordTail = 0;
+    _barTicks = 0;
+    _euclideanTrack = NO_TRACK;
+    _songMode = 0;
+    _chainLength = 0;
+    _songPosition = 0;
+    _songSteps = 0;
+    _songPositionChanged = 0;
+    _preloadStatus = NO_PRELOAD;
+    _preloadLength = 0;
+    _preloadStep = 0;
+
+    // only the first track plays a sequence by default. Each track sends on its own channel
+    for (uint8_t track = 0; track < TRACKS; track++)
     {
-    case FORWARD:
-    case RANDOM:
-        _playBackStep = 0;
-        break;
+        _trackSequence[track] = NO_SEQUENCE;
+        _trackLength[track] = LENGTH;
+        _trackShufflePosition[track] = 0;
+        _trackShuffleStride[track] = 1;
+        _trackEuclideanHits[track] = 4;
+        _trackEuclideanSteps[track] = LENGTH;
+        _trackEuclideanRotation[track] = 0;
+        _trackMIDIChannel[track] = track + 1;
+        _trackPlayBackMode[track] = mode;
+        _trackStepSize[track] = stepSize;
+        _renderLength[track] = 0;
+        _trackPlayedStep[track] = 0;
+        _trackPlayedTick[track] = 0;
+        _renderedStep[track] = 0;
+        _renderedNote[track] = NO_NOTE;
+        _renderedGate[track] = 0;
+        _renderedRatchets[track] = 1;
+        _renderedRatchetTicks[track] = 0;
+        _legatoEvent[track] = EventScheduler::NO_EVENT;
+
+        resetTrack(track);
+    }
 
-    case BACKWARD:
-        _playBackStep = LENGTH - 1;
-        break;
+    // every note is within the chromatic scale
+    _scaleMask = 0xFFF;
+
+    for (uint8_t note = 0; note < 12; note++)
+    {
+        _scaleOffsets[note] = 0;
     }
 
+    _trackSequence[0] = 1;
+
     _memoryManager = memoryManager;
     _screenManager = screenManager;
 }
@@ -48,44 +103,58 @@ Sequencer::Sequencer(uint8_t mode, uint8_t stepSize, MemoryManager *memoryManage
 * SETTER METHODS
 */
 
-void Sequencer::setPlayBackStep(int8_t currentStep)
-{
-    _playBackStep = currentStep;
-}
-
 void Sequencer::setMIDIChannel(uint8_t channel)
 {
-    _midiChannel = channel;
+    _trackMIDIChannel[_selectedTrack] = channel;
 }
 
 void Sequencer::setPlayBackMode(uint8_t mode)
 {
-    _playBackMode = mode;
+    _trackPlayBackMode[_selectedTrack] = mode;
 
     if (!_playBackOn)
     {
-        switch (_playBackMode)
-        {
-        case FORWARD:
-        case RANDOM:
-            _playBackStep = 0;
-            break;
-
-        case BACKWARD:
-            _playBackStep = LENGTH - 1;
-            break;
-        }
+        resetTrack(_selectedTrack);
     }
 }
 
 void Sequencer::setStepSize(uint8_t size)
 {
-    _stepSize = size;
+    _trackStepSize[_selectedTrack] = size;
 }
 
+/*
+* Assign a sequence to the selected track. A track whose steps region is taken by a longer sequence of a previous track stays off.
+* The first track plays the song chain when SONG is assigned to it
+* numSequence: the sequence number
+*/
 void Sequencer::setCurrentSequence(uint8_t numSequence)
 {
-    _currentSequence = numSequence;
+    if (bitRead(_coveredTracks, _selectedTrack))
+    {
+        return;
+    }
+
+    if (_selectedTrack == 0)
+    {
+        _songMode = (numSequence == SONG) ? 1 : 0;
+        _preloadStatus = NO_PRELOAD;
+
+        if (_songMode)
+        {
+            startSong();
+            return;
+        }
+    }
+
+    _trackSequence[_selectedTrack] = numSequence;
+
+    updateCoveredTracks();
+}
+
+void Sequencer::setSelectedTrack(uint8_t track)
+{
+    _selectedTrack = track;
 }
 
 void Sequencer::setMidiWorker(MidiWorker *midiWorker)
@@ -93,9 +162,61 @@ void Sequencer::setMidiWorker(MidiWorker *midiWorker)
     _midiWorker = midiWorker;
 }
 
+void Sequencer::setRecording(uint8_t recording)
+{
+    _recording = recording;
+}
+
+void Sequencer::setTranspose(int8_t transpose)
+{
+    _transpose = transpose;
+}
+
+void Sequencer::setScaleLock(uint8_t scaleLock)
+{
+    _scaleLock = scaleLock;
+}
+
+/*
+* Set the scale the rendered notes are moved to when the scale lock is on. The scale repeats every octave, so the table
+* with the distance to the nearest note within the scale only covers the notes of an octave. It is rebuilt only if the scale changes
+* rootNote: root note of the scale
+* mode: musical mode of the scale
+*/
+void Sequencer::setScale(uint8_t rootNote, uint8_t mode)
+{
+    if (rootNote == _scaleRootNote && mode == _scaleMode)
+    {
+        return;
+    }
+
+    _scaleRootNote = rootNote;
+    _scaleMode = mode;
+    _scaleMask = MIDIUtils::getScaleMask(rootNote, mode);
+
+    // the nearest note is searched in both directions. The lower one wins when both are at the same distance
+    for (uint8_t note = 0; note < 12; note++)
+    {
+        for (uint8_t distance = 0; distance < 12; distance++)
+        {
+            if (bitRead(_scaleMask, (note + 12 - distance) % 12))
+            {
+                _scaleOffsets[note] = -distance;
+                break;
+            }
+
+            if (bitRead(_scaleMask, (note + distance) % 12))
+            {
+                _scaleOffsets[note] = distance;
+                break;
+            }
+        }
+    }
+}
+
 void Sequencer::setDisplayedStepNote(uint8_t note)
 {
-    _steps[_screenManager->getDisplayedStepNumber() - 1].setNote(note);
+    getSequence()[_screenManager->getDisplayedStepNumber() - 1].setNote(note);
 
     // refresh note value on screen
     _screenManager->refreshStepNoteValue(note);
@@ -103,7 +224,7 @@ void Sequencer::setDisplayedStepNote(uint8_t note)
 
 void Sequencer::setDisplayedStepLegato(uint8_t legato)
 {
-    _steps[_screenManager->getDisplayedStepNumber() - 1].setLegato(legato);
+    getSequence()[_screenManager->getDisplayedStepNumber() - 1].setLegato(legato);
 
     // refresh legato value on screen
     _screenManager->refreshStepLegatoValue(legato);
@@ -111,26 +232,184 @@ void Sequencer::setDisplayedStepLegato(uint8_t legato)
 
 void Sequencer::setDisplayedStepEnabled(uint8_t enabled)
 {
-    _steps[_screenManager->getDisplayedStepNumber() - 1].setEnabled(enabled);
+    getSequence()[_screenManager->getDisplayedStepNumber() - 1].setEnabled(enabled);
 
     // refresh enabled value on screen
     _screenManager->refreshStepEnabledValue(enabled);
 }
 
+void Sequencer::setDisplayedStepVelocity(uint8_t velocity)
+{
+    getSequence()[_screenManager->getDisplayedStepNumber() - 1].setVelocity(velocity);
+
+    // refresh velocity value on screen
+    _screenManager->refreshStepVelocityValue(velocity);
+}
+
+void Sequencer::setDisplayedStepProbability(uint8_t probability)
+{
+    getSequence()[_screenManager->getDisplayedStepNumber() - 1].setProbability(probability);
+
+    // refresh probability value on screen
+    _screenManager->refreshStepProbabilityValue(probability);
+}
+
+void Sequencer::setDisplayedStepRatchets(uint8_t ratchets)
+{
+    getSequence()[_screenManager->getDisplayedStepNumber() - 1].setRatchets(ratchets);
+
+    // refresh ratchets value on screen
+    _screenManager->refreshStepRatchetsValue(ratchets);
+}
+
 /*
-* GETTER METHODS
+* Change the number of steps of the sequence of the selected track. Steps added at the end of the sequence start disabled
+* length: the new number of steps
 */
+void Sequencer::setDisplayedSequenceLength(uint8_t length)
+{
+    Step *steps = getSequence();
+
+    for (uint8_t step = _trackLength[_selectedTrack]; step < length; step++)
+    {
+        steps[step] = Step(Step::DEFAULT_NOTE, 0, 0);
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        setTrackLength(_selectedTrack, length);
+    }
 
-int8_t Sequencer::getPlayBackStep()
+    // the displayed step is out of the sequence, so the last one is displayed instead
+    if (_screenManager->getDisplayedStepNumber() > length)
+    {
+        _screenManager->printEditStepData(steps[length - 1], length, length);
+        _screenManager->moveCursorToStepLength();
+    }
+
+    // the length is drawn on the next screen refresh, which leaves the cursor on it
+    else
+    {
+        _screenManager->refreshStepLengthValue(length);
+    }
+}
+
+/*
+* Change the hits of the euclidean pattern of the selected track and generate it
+* hits: the number of hits
+*/
+void Sequencer::setEuclideanHits(uint8_t hits)
 {
-    return _playBackStep;
+    _trackEuclideanHits[_selectedTrack] = min(hits, _trackEuclideanSteps[_selectedTrack]);
+
+    startEuclideanPattern();
+
+    _screenManager->printEuclideanParameters(getEuclideanHits(), getEuclideanSteps(), getEuclideanRotation());
+    _screenManager->moveCursorToEuclideanHits();
+}
+
+/*
+* Change the steps of the euclidean pattern of the selected track and generate it. Hits and rotation are limited to the new steps
+* steps: the number of steps
+*/
+void Sequencer::setEuclideanSteps(uint8_t steps)
+{
+    _trackEuclideanSteps[_selectedTrack] = constrain(steps, 1, EuclideanGenerator::MAX_STEPS);
+    _trackEuclideanHits[_selectedTrack] = min(_trackEuclideanHits[_selectedTrack], _trackEuclideanSteps[_selectedTrack]);
+    _trackEuclideanRotation[_selectedTrack] = min(_trackEuclideanRotation[_selectedTrack], _trackEuclideanSteps[_selectedTrack] - 1);
+
+    startEuclideanPattern();
+
+    _screenManager->printEuclideanParameters(getEuclideanHits(), getEuclideanSteps(), getEuclideanRotation());
+    _screenManager->moveCursorToEuclideanSteps();
+}
+
+/*
+* Change the rotation of the euclidean pattern of the selected track and generate it
+* rotation: steps the pattern is rotated to the right
+*/
+void Sequencer::setEuclideanRotation(uint8_t rotation)
+{
+    _trackEuclideanRotation[_selectedTrack] = rotation % _trackEuclideanSteps[_selectedTrack];
+
+    startEuclideanPattern();
+
+    _screenManager->printEuclideanParameters(getEuclideanHits(), getEuclideanSteps(), getEuclideanRotation());
+    _screenManager->moveCursorToEuclideanRotation();
+}
+
+/*
+* Start the generation of the euclidean pattern of the selected track. While playback is on, the pattern is generated
+* from the main loop and replaces the enabled steps of the track when its next bar starts. Otherwise it is applied right now
+*/
+void Sequencer::startEuclideanPattern()
+{
+    _euclideanGenerator.start(_trackEuclideanHits[_selectedTrack], _trackEuclideanSteps[_selectedTrack], _trackEuclideanRotation[_selectedTrack], _trackLength[_selectedTrack]);
+    _euclideanTrack = _selectedTrack;
+
+    if (!_playBackOn)
+    {
+        completeEuclideanPattern();
+    }
+}
+
+/*
+* Generate right now the pending euclidean pattern, if any, and apply it
+*/
+void Sequencer::completeEuclideanPattern()
+{
+    if (_euclideanTrack == NO_TRACK)
+    {
+        return;
+    }
+
+    while (!_euclideanGenerator.generate(EuclideanGenerator::MAX_STEPS))
+        ;
+
+    applyEuclideanPattern(_euclideanTrack);
+}
+
+/*
+* Replace the enabled flags of the steps of a track with the generated euclidean pattern
+* track: the track
+*/
+void Sequencer::applyEuclideanPattern(uint8_t track)
+{
+    Step *steps = getTrackSteps(track);
+
+    for (uint8_t step = 0; step < _trackLength[track]; step++)
+    {
+        steps[step].setEnabled(_euclideanGenerator.isHit(step));
+    }
+
+    _euclideanGenerator.reset();
+    _euclideanTrack = NO_TRACK;
 }
 
+/*
+* GETTER METHODS
+*/
+
 uint8_t Sequencer::isPlayBackOn()
 {
     return _playBackOn;
 }
 
+uint8_t Sequencer::isRecording()
+{
+    return _recording;
+}
+
+int8_t Sequencer::getTranspose()
+{
+    return _transpose;
+}
+
+uint8_t Sequencer::isScaleLockOn()
+{
+    return _scaleLock;
+}
+
 uint8_t Sequencer::isStepSizeValueValid(uint8_t stepSizeValue)
 {
     switch (stepSizeValue)
@@ -147,7 +426,7 @@ uint8_t Sequencer::isStepSizeValueValid(uint8_t stepSizeValue)
 
 uint8_t Sequencer::getPlayBackMode()
 {
-    return _playBackMode;
+    return _trackPlayBackMode[_selectedTrack];
 }
 
 uint8_t Sequencer::getPlayBackModeTypesNumber()
@@ -157,396 +436,984 @@ uint8_t Sequencer::getPlayBackModeTypesNumber()
 
 uint8_t Sequencer::getMIDIChannel()
 {
-    return _midiChannel;
+    return _trackMIDIChannel[_selectedTrack];
 }
 
 uint8_t Sequencer::getSequenceLength()
 {
-    return LENGTH;
+    return _trackLength[_selectedTrack];
 }
 
-Step *Sequencer::getSequence()
+/*
+* Returns the maximum number of steps of a sequence of the selected track: its steps region and the regions of the following tracks
+*/
+uint8_t Sequencer::getMaxSequenceLength()
 {
-    return _steps;
+    return (TRACKS - _selectedTrack) * LENGTH;
 }
 
-Step Sequencer::getSequenceStep(uint8_t pos)
+Step *Sequencer::getSequence()
 {
-    return _steps[pos];
+    return getTrackSteps(_selectedTrack);
 }
 
 uint8_t Sequencer::getStepSize()
 {
-    return _stepSize;
+    return _trackStepSize[_selectedTrack];
+}
+
+uint8_t Sequencer::getEuclideanHits()
+{
+    return _trackEuclideanHits[_selectedTrack];
+}
+
+uint8_t Sequencer::getEuclideanSteps()
+{
+    return _trackEuclideanSteps[_selectedTrack];
+}
+
+uint8_t Sequencer::getEuclideanRotation()
+{
+    return _trackEuclideanRotation[_selectedTrack];
 }
 
 uint8_t Sequencer::getCurrentSequence()
 {
-    return _currentSequence;
+    return (_selectedTrack == 0 && _songMode) ? SONG : _trackSequence[_selectedTrack];
+}
+
+/*
+* Returns the lowest sequence number that can be assigned to the selected track.
+* Every track but the first one can be switched off with NO_SEQUENCE. The first one can play the song chain if it has entries
+*/
+uint8_t Sequencer::getFirstSequence()
+{
+    if (_selectedTrack == 0)
+    {
+        return _chainLength ? SONG : 1;
+    }
+
+    return NO_SEQUENCE;
+}
+
+/*
+* Returns 1 if the song has moved to another entry since the last call, 0 otherwise
+*/
+uint8_t Sequencer::wasSongPositionChanged()
+{
+    uint8_t changed = _songPositionChanged;
+
+    _songPositionChanged = 0;
+
+    return changed;
+}
+
+uint8_t Sequencer::getSelectedTrack()
+{
+    return _selectedTrack;
+}
+
+uint8_t Sequencer::getTracksNumber()
+{
+    return TRACKS;
 }
 
 /*
-* Load a new sequence from EEPROM into the sequencer
+* Returns the steps of a track within the steps array
+* track: the track
+*/
+Step *Sequencer::getTrackSteps(uint8_t track)
+{
+    return &_steps[track * LENGTH];
+}
+
+/*
+* Load the song chain from EEPROM
+*/
+void Sequencer::loadChain()
+{
+    _chainLength = _memoryManager->loadChain(_chainSequences, _chainRepeats);
+}
+
+/*
+* Load a new sequence from EEPROM into the selected track
 */
 void Sequencer::loadCurrentSequence()
 {
-    // new sequence is loaded in sync when playback mode is on
-    if (isPlayBackOn())
+    if (_trackSequence[_selectedTrack] == NO_SEQUENCE)
+    {
+        return;
+    }
+
+    // a load of the previous sequence of the track is discarded
+    if (_loadingTrack == _selectedTrack)
+    {
+        _loadingTrack = NO_TRACK;
+    }
+
+    bitSet(_loadTracks, _selectedTrack);
+
+    // new sequence is decoded from the main loop when playback mode is on
+    if (!isPlayBackOn())
+    {
+        completeTrackLoads();
+    }
+}
+
+/*
+* Stores the sequence of the selected track into EEPROM
+* Return: 0 if the sequence does not fit into the EEPROM, 1 otherwise
+*/
+uint8_t Sequencer::saveCurrentSequence()
+{
+    if (_trackSequence[_selectedTrack] == NO_SEQUENCE)
     {
-        _loadNewSequence = 1;
+        return 1;
+    }
+
+    // the stored records may be moved, so the preloaded steps could be wrong
+    _preloadStatus = NO_PRELOAD;
+
+    return _memoryManager->saveSequence(_trackSequence[_selectedTrack], getSequence(), _trackLength[_selectedTrack]);
+}
+
+/*
+* Decode the steps of the sequences waiting to be loaded, one track after the other
+* numSteps: maximum number of steps to decode
+*/
+void Sequencer::loadTracks(uint8_t numSteps)
+{
+    if (_loadingTrack == NO_TRACK)
+    {
+        // the EEPROM decoder is kept by the preload of the song until the preloaded sequence is swapped in
+        if (_loadTracks == 0 || _preloadStatus != NO_PRELOAD)
+        {
+            return;
+        }
+
+        uint8_t track = __builtin_ctz(_loadTracks);
+
+        bitClear(_loadTracks, track);
+
+        // the track has been switched off after the load was requested
+        if (_trackSequence[track] == NO_SEQUENCE)
+        {
+            return;
+        }
+
+        uint8_t length = _memoryManager->beginSequenceLoad(_trackSequence[track], (TRACKS - track) * LENGTH);
+
+        // the track is muted from now on, so its steps can be overwritten while the interrupt keeps it in time
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            _loadingTrack = track;
+            _loadingStep = 0;
+            setTrackLength(track, length);
+        }
+    }
+
+    if (_loadingStep < _trackLength[_loadingTrack])
+    {
+        numSteps = min(numSteps, _trackLength[_loadingTrack] - _loadingStep);
+
+        _memoryManager->loadSequenceSteps(getTrackSteps(_loadingTrack) + _loadingStep, numSteps);
+        _loadingStep += numSteps;
+    }
+
+    if (_loadingStep >= _trackLength[_loadingTrack])
+    {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            _loadingTrack = NO_TRACK;
+        }
+    }
+}
+
+/*
+* Decode right now all the sequences waiting to be loaded
+*/
+void Sequencer::completeTrackLoads()
+{
+    // a preload of the song holds the EEPROM decoder, so it is discarded
+    _preloadStatus = NO_PRELOAD;
+
+    while (_loadingTrack != NO_TRACK || _loadTracks != 0)
+    {
+        loadTracks(TRACKS * LENGTH);
+    }
+}
+
+/*
+* Move the song chain to its first entry, whose sequence is loaded into the first track
+*/
+void Sequencer::startSong()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        _songPosition = 0;
+        _songSteps = 0;
+        _songPositionChanged = 1;
+        _preloadStatus = NO_PRELOAD;
+        _trackSequence[0] = _chainSequences[0];
+    }
+
+    // a load of the previous sequence of the track is discarded
+    if (_loadingTrack == 0)
+    {
+        _loadingTrack = NO_TRACK;
+    }
+
+    updateCoveredTracks();
+    bitSet(_loadTracks, 0);
+}
+
+/*
+* Move the song chain to its following entry and swap the preloaded steps into the first track, so the clock path
+* does not access the EEPROM. A sequence that could not be preloaded in time is loaded while it plays.
+* It has to be called with interrupts disabled while playback is on
+*/
+void Sequencer::advanceSong()
+{
+    _songPosition = getNextSongPosition();
+    _songSteps = 0;
+    _songPositionChanged = 1;
+    _trackSequence[0] = _chainSequences[_songPosition];
+
+    if (_preloadStatus == PRELOAD_READY)
+    {
+        memcpy(getTrackSteps(0), _preloadSteps, min(_preloadLength, LENGTH) * sizeof(Step));
+        setTrackLength(0, _preloadLength);
+
+        // the steps beyond the first region are decoded while the preloaded ones are played
+        if (_preloadLength > LENGTH)
+        {
+            _loadingTrack = 0;
+            _loadingStep = LENGTH;
+        }
     }
 
     else
     {
-        _memoryManager->loadSequence(_currentSequence, _steps, LENGTH);
+        bitSet(_loadTracks, 0);
+    }
+
+    _preloadStatus = NO_PRELOAD;
+    resetTrack(0);
+}
+
+/*
+* Decode a few steps of the next sequence of the song chain. The preload starts when the first track plays the last bar
+* of the current entry and only the first region of steps is decoded, so it is ready before the entry ends
+*/
+void Sequencer::preloadNextSequence()
+{
+    uint8_t nextPosition = 0;
+
+    if (!_songMode || _preloadStatus == PRELOAD_READY)
+    {
+        return;
+    }
+
+    if (_preloadStatus == NO_PRELOAD)
+    {
+        // the EEPROM decoder is shared with the loads of the tracks, which go first
+        if (_loadingTrack != NO_TRACK || _loadTracks != 0)
+        {
+            return;
+        }
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            if (_songSteps + (BAR_LENGTH * _trackStepSize[0]) >= (uint16_t)_trackLength[0] * _chainRepeats[_songPosition])
+            {
+                _preloadStatus = PRELOAD_LOADING;
+                nextPosition = getNextSongPosition();
+            }
+        }
+
+        if (_preloadStatus == NO_PRELOAD)
+        {
+            return;
+        }
+
+        _preloadLength = _memoryManager->beginSequenceLoad(_chainSequences[nextPosition], TRACKS * LENGTH);
+        _preloadStep = 0;
+    }
+
+    uint8_t numSteps = min(LOAD_STEPS_PER_PASS, min(_preloadLength, LENGTH) - _preloadStep);
+
+    _memoryManager->loadSequenceSteps(_preloadSteps + _preloadStep, numSteps);
+    _preloadStep += numSteps;
+
+    // the song may have moved to another entry while the steps were decoded, which discards the preload
+    if (_preloadStep >= min(_preloadLength, LENGTH))
+    {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            if (_preloadStatus == PRELOAD_LOADING)
+            {
+                _preloadStatus = PRELOAD_READY;
+            }
+        }
+    }
+}
+
+/*
+* Returns the entry of the song chain that follows the one being played
+*/
+uint8_t Sequencer::getNextSongPosition()
+{
+    return (_songPosition + 1 < _chainLength) ? _songPosition + 1 : 0;
+}
+
+/*
+* Change the number of steps of a track, keeping its next step within the sequence.
+* It has to be called with interrupts disabled while playback is on
+* track: the track
+* length: the new number of steps
+*/
+void Sequencer::setTrackLength(uint8_t track, uint8_t length)
+{
+    _trackLength[track] = length;
+
+    // the shuffle starts a new cycle with the steps of the new length
+    _trackShufflePosition[track] = 0;
+
+    if (_trackStep[track] >= length || _trackPlayBackMode[track] == SHUFFLE)
+    {
+        resetTrack(track);
     }
+
+    updateCoveredTracks();
 }
 
 /*
-* Stores current sequence into EEPROM
+* Switch off the tracks whose steps region is taken by a sequence longer than LENGTH of a previous track
 */
-void Sequencer::saveCurrentSequence()
+void Sequencer::updateCoveredTracks()
 {
-    _memoryManager->saveSequence(_currentSequence, _steps, LENGTH);
+    _coveredTracks = 0;
+
+    for (uint8_t track = 0; track < TRACKS; track++)
+    {
+        if (bitRead(_coveredTracks, track) || _trackSequence[track] == NO_SEQUENCE)
+        {
+            continue;
+        }
+
+        for (uint8_t covered = track + 1; covered * LENGTH < track * LENGTH + _trackLength[track]; covered++)
+        {
+            bitSet(_coveredTracks, covered);
+            bitClear(_loadTracks, covered);
+            _trackSequence[covered] = NO_SEQUENCE;
+
+            if (_loadingTrack == covered)
+            {
+                _loadingTrack = NO_TRACK;
+            }
+        }
+    }
 }
 
 /*
-* Start sequencer playback
+* Start sequencer playback. Every track plays its first step on the next MIDI clock tick
 */
 void Sequencer::startPlayBack()
 {
+    _renderedTracks = 0;
+    _barTicks = 0;
+    _clockTicks = 0;
+
+    // the interrupt does not write recorded notes while playback is off, so the queue can be emptied here
+    _recordTail = _recordHead;
+
+    // the moment playback starts seeds the random number generator, which cannot be zero
+    _randomState = (uint16_t)micros() | 1;
+
+    for (uint8_t track = 0; track < TRACKS; track++)
+    {
+        _trackTicks[track] = 0;
+    }
+
     _playBackOn = 1;
 }
 
 /*
-* Stop playback and reset first step to be played
+* Stop playback and reset first step to be played
+*/
+void Sequencer::stopPlayBack()
+{
+    // stop the interrupt first so the pending rendered steps are discarded
+    _playBackOn = 0;
+    _renderedTracks = 0;
+
+    // the song starts again from its first entry
+    if (_songMode)
+    {
+        startSong();
+    }
+
+    // the sequences waiting to be loaded and the euclidean pattern are not generated from the main loop anymore
+    completeTrackLoads();
+    completeEuclideanPattern();
+
+    // send the pending note offs right now
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        _eventScheduler.flush(_midiWorker);
+    }
+
+    for (uint8_t track = 0; track < TRACKS; track++)
+    {
+        _legatoEvent[track] = EventScheduler::NO_EVENT;
+        resetTrack(track);
+    }
+}
+
+/*
+* Set the first step to be played of a track regarding its playback mode
+* track: the track
 */
-void Sequencer::stopPlayBack()
+void Sequencer::resetTrack(uint8_t track)
 {
-    stopCurrentNotePlayed();
+    _trackDirection[track] = 1;
 
-    switch (_playBackMode)
+    switch (_trackPlayBackMode[track])
     {
-    case FORWARD:
-    case RANDOM:
-        _playBackStep = 0;
+    case BACKWARD:
+        _trackStep[track] = _trackLength[track] - 1;
         break;
 
-    case BACKWARD:
-        _playBackStep = LENGTH - 1;
+    case SHUFFLE:
+        _trackShufflePosition[track] = 0;
+        _trackStep[track] = advanceShuffle(track);
         break;
-    }
 
-    _playBackOn = 0;
+    default:
+        _trackStep[track] = 0;
+    }
 }
 
-void Sequencer::stopNote()
+/*
+* Clock dispatch of the sequencer. This method is called from the Timer1 interrupt on every MIDI clock tick.
+* It sends the note offs scheduled for the tick and plays the step of every track whose step size ends on it.
+*/
+void Sequencer::tick()
 {
-    _stopCurrentPlayedNote = 1;
+    // send the note offs whose gate ends on this tick
+    _eventScheduler.tick(_midiWorker);
+
+    if (_playBackOn)
+    {
+        // the notes recorded since the previous tick are written before any track moves to its next step
+        writeRecordedNotes();
+
+        for (uint8_t track = 0; track < TRACKS; track++)
+        {
+            if (_trackTicks[track] == 0)
+            {
+                playTrackStep(track);
+                _trackTicks[track] = getStepTicks(track);
+            }
+
+            _trackTicks[track]--;
+        }
+
+        _barTicks = (_barTicks + 1 < BAR_LENGTH * TICKS_PER_QUARTER) ? _barTicks + 1 : 0;
+        _clockTicks++;
+    }
 }
 
 /*
-* Plays next step within a sequence regarding the selected playback mode
+* Send the MIDI messages of the next step of a track. The step is rendered in advance by renderNextStep(),
+* so here its bytes are only copied to the MIDI output and its note off is scheduled regarding its gate length.
+* track: the track to play
 */
-uint8_t Sequencer::playBackSequence()
+void Sequencer::playTrackStep(uint8_t track)
 {
-    if (_playBackOn)
+    // the main loop was busy and could not render the step in time
+    if (!bitRead(_renderedTracks, track))
+    {
+        renderStep(track);
+    }
+
+    uint8_t noteOff[3] = {(uint8_t)(midi::NoteOff | ((_trackMIDIChannel[track] - 1) & 0x0F)), _renderedNote[track], 0};
+
+    // a legato step followed by the same note is tied: the pending note off is cancelled and the note is not played again
+    if (_renderedNote[track] == NO_NOTE || !_eventScheduler.cancel(_legatoEvent[track], noteOff[0], noteOff[1]))
+    {
+        _midiWorker->sendChannelMessages(_renderBuffer[track], _renderLength[track]);
+    }
+
+    _legatoEvent[track] = EventScheduler::NO_EVENT;
+    _trackPlayedStep[track] = _renderedStep[track];
+    _trackPlayedTick[track] = _clockTicks;
+
+    if (_renderedNote[track] != NO_NOTE)
     {
-        // when playback mode has changed, it's necessary to stop current played note before play next step
-        if (_stopCurrentPlayedNote)
+        uint8_t event = _eventScheduler.schedule(_renderedGate[track], noteOff[0], noteOff[1], noteOff[2]);
+
+        // without free events the note cannot be sustained, so it is released right away
+        if (event == EventScheduler::NO_EVENT)
         {
-            stopCurrentNotePlayed();
+            _midiWorker->sendChannelMessages(noteOff, 3);
         }
 
-        // if sequencer has to load a new sequence while playback is on
-        if (_loadNewSequence)
+        else if (bitRead(_renderedLegato, track))
         {
-            stopCurrentNotePlayed();
-            _memoryManager->loadSequence(_currentSequence, _steps, LENGTH);
-            _loadNewSequence = 0;
+            _legatoEvent[track] = event;
         }
 
-        // plays next step
-        switch (_playBackMode)
-        {
-        case FORWARD:
-            playBackForward();
-            break;
+        // the ratchets are scheduled with the tick offsets calculated when the step was rendered.
+        // A ratchet is only played if its note off can be scheduled too
+        uint8_t ticks = 0;
 
-        case BACKWARD:
-            playBackBackward();
-            break;
+        for (uint8_t ratchet = 1; ratchet < _renderedRatchets[track]; ratchet++)
+        {
+            ticks += _renderedRatchetTicks[track];
 
-        case RANDOM:
-            playBackRandom();
-            break;
+            if (_eventScheduler.schedule(ticks + _renderedGate[track], noteOff[0], noteOff[1], noteOff[2]) != EventScheduler::NO_EVENT)
+            {
+                _eventScheduler.schedule(ticks, _renderBuffer[track][0], _renderBuffer[track][1], _renderBuffer[track][2]);
+            }
         }
-
-        return 1; // play next step is true
     }
 
-    return 0;
+    _renderedTracks &= ~(1 << track);
 }
 
 /*
-* Calculate and play next step when Forward mode is selected
+* Prepare the MIDI messages of the next step to be played of every track. It is called from the main loop,
+* so the EEPROM access of a sequence change and the step calculations are kept out of the Timer1 interrupt.
 */
-void Sequencer::playBackForward()
+void Sequencer::renderNextStep()
 {
-    MIDIMessage msgNoteOff;
-    MIDIMessage msgNoteOn;
-    uint8_t isStepLegato;
-
-    // stop last played step
-    msgNoteOff.setType(midi::NoteOff);
-
-    // last step within a sequence
-    if (_playBackStep == 0)
+    if (!_playBackOn)
     {
-        msgNoteOff.setDataByte1(_steps[LENGTH - 1].getNote());
-        isStepLegato = _steps[LENGTH - 1].isLegato();
+        return;
     }
 
-    else
-    {
-        msgNoteOff.setDataByte1(_steps[_playBackStep - 1].getNote());
-        isStepLegato = _steps[_playBackStep - 1].isLegato();
-    }
+    // decode a few steps of the sequences to be loaded. Notes already played keep their scheduled note offs
+    loadTracks(LOAD_STEPS_PER_PASS);
 
-    // send note off message if legato is off
-    if (!isStepLegato)
+    // decode a few steps of the next sequence of the song during the last bar of the current one
+    preloadNextSequence();
+
+    // generate a few steps of the euclidean pattern
+    if (_euclideanTrack != NO_TRACK)
     {
-        _midiWorker->sendMIDIMessage(&msgNoteOff, _midiChannel);
+        _euclideanGenerator.generate(LOAD_STEPS_PER_PASS);
     }
 
-    // Play current step if enabled
-    if (_steps[_playBackStep].isEnabled())
+    for (uint8_t track = 0; track < TRACKS; track++)
     {
-        // set current note being played
-        _currentNotePlayed = _steps[_playBackStep].getNote();
+        if (bitRead(_renderedTracks, track))
+        {
+            continue;
+        }
 
-        msgNoteOn.setType(midi::NoteOn);
-        msgNoteOn.setDataByte1(_steps[_playBackStep].getNote());
-        msgNoteOn.setDataByte2(127);
-        _midiWorker->sendMIDIMessage(&msgNoteOn, _midiChannel);
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            if (_playBackOn && !bitRead(_renderedTracks, track))
+            {
+                // a generated euclidean pattern replaces the enabled steps when the step to render starts a bar
+                if (track == _euclideanTrack && _euclideanGenerator.isReady() && isBarStart(track))
+                {
+                    applyEuclideanPattern(track);
+                }
+
+                renderStep(track);
+            }
+        }
     }
+}
 
-    // send note off message if legato is on
-    if (isStepLegato)
+/*
+* Record a note played while playback is on into the selected track. The note is timestamped with the current MIDI clock tick
+* and queued, so it is quantized and written into the steps by the Timer1 interrupt
+* note: the note played
+* velocity: velocity of the note
+*/
+void Sequencer::recordNote(uint8_t note, uint8_t velocity)
+{
+    uint8_t head = _recordHead;
+    uint8_t next = (head + 1) & (RECORD_QUEUE_SIZE - 1);
+
+    // the note is lost when the queue is full
+    if (!_recording || !_playBackOn || next == _recordTail)
     {
-        _midiWorker->sendMIDIMessage(&msgNoteOff, _midiChannel);
+        return;
     }
 
-    // Move sequence to next step
-    _playBackStep++;
+    _recordQueue[head].note = note;
+    _recordQueue[head].velocity = velocity;
+    _recordQueue[head].tick = _clockTicks;
+    _recordQueue[head].track = _selectedTrack;
 
-    if (_playBackStep >= LENGTH)
-    {
-        _playBackStep = 0;
-    }
+    // the note is handed to the interrupt once it is complete. The barrier keeps the compiler from moving the writes after it
+    __asm__ __volatile__("" ::: "memory");
+    _recordHead = next;
 }
 
 /*
-* Calculate and play next step when Backward mode is selected
+* Write the recorded notes into the steps of their tracks, quantized to the nearest step. It is called from the Timer1
+* interrupt, so the steps are never written while the main loop renders them. The note overwrites the note and velocity of
+* the step and enables it. Steps not decoded from EEPROM yet are not recorded.
 */
-void Sequencer::playBackBackward()
+void Sequencer::writeRecordedNotes()
 {
-    MIDIMessage msgNoteOff;
-    MIDIMessage msgNoteOn;
-    uint8_t isStepLegato;
+    while (_recordTail != _recordHead)
+    {
+        RecordedNote *recorded = &_recordQueue[_recordTail];
+        uint8_t track = recorded->track;
+        uint8_t step = _trackPlayedStep[track];
+        int8_t offset = recorded->tick - _trackPlayedTick[track];
 
-    // stop last played step
-    msgNoteOff.setType(midi::NoteOff);
+        // a note played within the second half of a step belongs to the following one
+        if (offset > 0 && 2 * offset > getStepTicks(track))
+        {
+            step = bitRead(_renderedTracks, track) ? _renderedStep[track] : _trackStep[track];
+        }
 
-    // last step of the sequence
-    if (_playBackStep == LENGTH - 1)
-    {
-        msgNoteOff.setDataByte1(_steps[0].getNote());
-        isStepLegato = _steps[0].isLegato();
-    }
+        if (_trackSequence[track] != NO_SEQUENCE && step < _trackLength[track] && !(track == _loadingTrack && step >= _loadingStep))
+        {
+            Step *recordedStep = &getTrackSteps(track)[step];
 
-    else
-    {
-        msgNoteOff.setDataByte1(_steps[_playBackStep + 1].getNote());
-        isStepLegato = _steps[_playBackStep + 1].isLegato();
-    }
+            recordedStep->setNote(recorded->note);
+            recordedStep->setVelocity(recorded->velocity);
+            recordedStep->setEnabled(1);
+        }
 
-    // send note off message if legato is off
-    if (!isStepLegato)
-    {
-        _midiWorker->sendMIDIMessage(&msgNoteOff, _midiChannel);
+        _recordTail = (_recordTail + 1) & (RECORD_QUEUE_SIZE - 1);
     }
+}
 
-    // Play current step if enabled
-    if (_steps[_playBackStep].isEnabled())
-    {
-        // set current note being played
-        _currentNotePlayed = _steps[_playBackStep].getNote();
+/*
+* Render next step of a track and move the track to the following step regarding its playback mode
+* track: the track to render
+*/
+void Sequencer::renderStep(uint8_t track)
+{
+    AdvanceFunction advance;
 
-        msgNoteOn.setType(midi::NoteOn);
-        msgNoteOn.setDataByte1(_steps[_playBackStep].getNote());
-        msgNoteOn.setDataByte2(127);
-        _midiWorker->sendMIDIMessage(&msgNoteOn, _midiChannel);
-    }
+    _renderLength[track] = 0;
+    _renderedNote[track] = NO_NOTE;
+    _renderedRatchets[track] = 1;
+    _renderedLegato &= ~(1 << track);
 
-    // send note off message if legato is on
-    if (isStepLegato)
+    // the song moves to its following entry when the first track has played all the repeats of the current one
+    if (track == 0 && _songMode)
     {
-        _midiWorker->sendMIDIMessage(&msgNoteOff, _midiChannel);
+        if (_songSteps >= (uint16_t)_trackLength[0] * _chainRepeats[_songPosition])
+        {
+            advanceSong();
+        }
+
+        _songSteps++;
     }
 
-    // Move sequence to next step
-    _playBackStep--;
+    _renderedStep[track] = _trackStep[track];
+    renderStepNote(track, _trackStep[track]);
 
-    if (_playBackStep < 0)
-    {
-        _playBackStep = LENGTH - 1;
-    }
+    // moves the track to its following step
+    memcpy_P(&advance, &advanceFunctions[_trackPlayBackMode[track]], sizeof(AdvanceFunction));
+    _trackStep[track] = (this->*advance)(track);
+
+    _renderedTracks |= (1 << track);
 }
 
 /*
-* Calculate and play next step when Random mode is selected
+* Add a MIDI message to the rendered step of a track
+* track: the track
+* type: MIDI message type
+* note: note of the message
+* velocity: velocity of the message
 */
-void Sequencer::playBackRandom()
+void Sequencer::renderMessage(uint8_t track, uint8_t type, uint8_t note, uint8_t velocity)
 {
-    MIDIMessage msgNoteOff;
-    MIDIMessage msgNoteOn;
-    uint8_t isStepLegato;
+    uint8_t *buffer = _renderBuffer[track];
 
-    // stop last played step
-    msgNoteOff.setType(midi::NoteOff);
-    msgNoteOff.setDataByte1(_steps[_playBackStep].getNote());
+    buffer[_renderLength[track]++] = type | ((_trackMIDIChannel[track] - 1) & 0x0F);
+    buffer[_renderLength[track]++] = note;
+    buffer[_renderLength[track]++] = velocity;
+}
 
-    isStepLegato = _steps[_playBackStep].isLegato();
+/*
+* Render the note on of a step if it is enabled and wins its probability, and calculate its gate length.
+* A legato step is released one tick after the following step starts, so both notes overlap. If the following step plays
+* the same note, the note is tied instead: playTrackStep() cancels the pending note off and does not play it again.
+* A step with ratchets plays its note several times within the step, each one with half of the ticks between them.
+* Ratchets need at least two ticks each, so steps of 1/32 are never repeated.
+* The note is transposed and moved to the scale when it is rendered, so the stored steps are kept as they were entered.
+* A track that is off or whose step has not been decoded from EEPROM yet keeps moving through its steps silently, so it stays in time.
+* track: the track
+* step: the step to render
+*/
+void Sequencer::renderStepNote(uint8_t track, uint8_t step)
+{
+    Step *steps = getTrackSteps(track);
 
-    // send note off message when legato is off
-    if (!isStepLegato)
+    if (_trackSequence[track] != NO_SEQUENCE && !(track == _loadingTrack && step >= _loadingStep) && steps[step].isEnabled())
     {
-        _midiWorker->sendMIDIMessage(&msgNoteOff, _midiChannel);
+        if ((getRandom() & 0x0F) > steps[step].getProbability())
+        {
+            return;
+        }
+
+        uint8_t stepTicks = getStepTicks(track);
+
+        _renderedNote[track] = mapNote(steps[step].getNote());
+        _renderedRatchets[track] = min(steps[step].getRatchets(), stepTicks / 2);
+
+        if (_renderedRatchets[track] > 1)
+        {
+            _renderedRatchetTicks[track] = stepTicks / _renderedRatchets[track];
+            _renderedGate[track] = _renderedRatchetTicks[track] / 2;
+        }
+
+        else
+        {
+            _renderedRatchets[track] = 1;
+            _renderedGate[track] = stepTicks;
+
+            if (steps[step].isLegato())
+            {
+                _renderedGate[track]++;
+                _renderedLegato |= (1 << track);
+            }
+        }
+
+        renderMessage(track, midi::NoteOn, _renderedNote[track], steps[step].getVelocity());
     }
+}
 
-    // Calculate next step
-    _playBackStep = random(0, LENGTH - 1);
+/*
+* Returns the note actually played for a note of a step: transposed and, if the scale lock is on, moved to the nearest
+* note within the scale with a single table read. At both ends of the MIDI range the nearest note may be out of it,
+* then the nearest one on the other side is searched
+* note: the note of the step
+*/
+uint8_t Sequencer::mapNote(uint8_t note)
+{
+    note = constrain(note + _transpose, 0, 127);
 
-    // Play current step if enabled
-    if (_steps[_playBackStep].isEnabled())
+    if (!_scaleLock)
     {
-        // set current note being played
-        _currentNotePlayed = _steps[_playBackStep].getNote();
+        return note;
+    }
 
-        msgNoteOn.setType(midi::NoteOn);
-        msgNoteOn.setDataByte1(_steps[_playBackStep].getNote());
-        msgNoteOn.setDataByte2(127);
-        _midiWorker->sendMIDIMessage(&msgNoteOn, _midiChannel);
+    int16_t scaleNote = note + _scaleOffsets[MIDIUtils::getNoteNumber(note)];
+
+    if (scaleNote > 127)
+    {
+        for (scaleNote = note; !bitRead(_scaleMask, MIDIUtils::getNoteNumber(scaleNote)); scaleNote--);
     }
 
-    // send note off message when legato is on
-    if (isStepLegato)
+    else if (scaleNote < 0)
     {
-        _midiWorker->sendMIDIMessage(&msgNoteOff, _midiChannel);
+        for (scaleNote = note; !bitRead(_scaleMask, MIDIUtils::getNoteNumber(scaleNote)); scaleNote++);
     }
+
+    return scaleNote;
 }
 
 /*
-* Stop current note being played
+* Returns the step that follows the current one of a track in Forward mode
+* track: the track
 */
-void Sequencer::stopCurrentNotePlayed()
+uint8_t Sequencer::advanceForward(uint8_t track)
 {
-    MIDIMessage msgNoteOff;
-
-    msgNoteOff.setType(midi::NoteOff);
-    msgNoteOff.setDataByte1(_currentNotePlayed);
-    _midiWorker->sendMIDIMessage(&msgNoteOff, _midiChannel);
+    return (_trackStep[track] + 1 < _trackLength[track]) ? _trackStep[track] + 1 : 0;
+}
 
-    _stopCurrentPlayedNote = 0;
+/*
+* Returns the step that follows the current one of a track in Backward mode
+* track: the track
+*/
+uint8_t Sequencer::advanceBackward(uint8_t track)
+{
+    return (_trackStep[track] > 0) ? _trackStep[track] - 1 : _trackLength[track] - 1;
 }
 
 /*
-* Send Note Off MIDI messages for all the steps within a sequence
+* Returns the step that follows the current one of a track in Random mode. Every step of the sequence can be selected
+* track: the track
 */
-void Sequencer::stopAllNotes()
+uint8_t Sequencer::advanceRandom(uint8_t track)
 {
-    // send note off messages before loading new sequence
-    MIDIMessage msgNoteOff;
+    return getRandom() % _trackLength[track];
+}
 
-    //Send Note Off messages
-    msgNoteOff.setType(midi::NoteOff);
+/*
+* Returns the step that follows the current one of a track in Ping-Pong mode. The direction changes at both ends
+* of the sequence, so the first and the last steps are not repeated
+* track: the track
+*/
+uint8_t Sequencer::advancePingPong(uint8_t track)
+{
+    int8_t step = _trackStep[track] + _trackDirection[track];
 
-    for (int i = 0; i < LENGTH; i++)
+    if (step < 0 || step >= _trackLength[track])
     {
-        msgNoteOff.setDataByte1(_steps[i].getNote());
-        _midiWorker->sendMIDIMessage(&msgNoteOff, _midiChannel);
+        _trackDirection[track] = -_trackDirection[track];
+        step = _trackStep[track] + _trackDirection[track];
     }
+
+    return constrain(step, 0, _trackLength[track] - 1);
 }
 
 /*
-* Display current sequence and total number of sequences available, general bpm and playback status
-* syncManager: object that contains the global Bpm value
+* Returns the step that follows the current one of a track in Random Walk mode: one of its two neighbours,
+* wrapping around the ends of the sequence
+* track: the track
 */
-void Sequencer::printDefault(SyncManager syncManager)
+uint8_t Sequencer::advanceRandomWalk(uint8_t track)
 {
-    _screenManager->printDefaultSequencer(_currentSequence, NUM_SEQUENCES, syncManager.getBpm(), _playBackOn);    
+    _trackDirection[track] = (getRandom() & 0x01) ? 1 : -1;
+
+    return (_trackDirection[track] > 0) ? advanceForward(track) : advanceBackward(track);
 }
 
 /*
-* Display sequencer global configuration parameters
-9 globalConfig: contains the global configuration of the system
+* Returns the step that follows the current one of a track in Shuffle mode. Each cycle starts from a random step and
+* moves a random stride coprime with the length, wrapping around the sequence, so every step is played once per cycle
+* and each cycle has a different order without keeping the order of the steps
+* track: the track
 */
-void Sequencer::printEditConfig(GlobalConfig globalConfig)
+uint8_t Sequencer::advanceShuffle(uint8_t track)
 {
-    _screenManager->printEditSequencerConfig(getPlayBackModeName(), getStepSizeName(), globalConfig.getSequencerMIDIChannel(), globalConfig.getSendClockWhilePlayback());
+    uint8_t length = _trackLength[track];
+    uint8_t position = _trackShufflePosition[track];
+    uint8_t step;
+
+    if (position == 0)
+    {
+        _trackShuffleStride[track] = getShuffleStride(length);
+        step = getRandom() % length;
+    }
+
+    else
+    {
+        step = _trackStep[track] + _trackShuffleStride[track];
+        step = (step >= length) ? step - length : step;
+    }
+
+    _trackShufflePosition[track] = (position + 1 < length) ? position + 1 : 0;
+
+    return step;
 }
 
 /*
-* Display the step's information that is being played
+* Returns a random stride of a shuffle cycle: the first value from a random one that is coprime with the length
+* length: number of steps of the sequence
 */
-void Sequencer::updateDisplayedStep()
+uint8_t Sequencer::getShuffleStride(uint8_t length)
 {
+    uint8_t stride = getRandom() % length;
 
-    switch (_playBackMode)
+    while (true)
     {
-    case FORWARD:
+        // greatest common divisor of the stride and the length
+        uint8_t divisor = length;
+        uint8_t remainder = stride;
 
-        if (_playBackStep == 0)
+        while (remainder != 0)
         {
-            _screenManager->updateDisplayedPlaybackStep(_steps[LENGTH - 1], LENGTH, LENGTH);
+            uint8_t next = divisor % remainder;
+            divisor = remainder;
+            remainder = next;
         }
 
-        else
+        if (divisor == 1)
         {
-            _screenManager->updateDisplayedPlaybackStep(_steps[_playBackStep - 1], LENGTH, _playBackStep);
+            return stride;
         }
 
-        break;
+        stride = (stride + 1 < length) ? stride + 1 : 0;
+    }
+}
 
-    case BACKWARD:
+/*
+* Returns 1 if the next step of a track will be played on the first tick of a bar, 0 otherwise.
+* It has to be called with interrupts disabled while playback is on
+* track: the track
+*/
+uint8_t Sequencer::isBarStart(uint8_t track)
+{
+    return ((_barTicks + _trackTicks[track]) % (BAR_LENGTH * TICKS_PER_QUARTER)) == 0;
+}
 
-        if (_playBackStep == LENGTH - 1)
-        {
-            _screenManager->updateDisplayedPlaybackStep(_steps[0], LENGTH, 1);
-        }
+/*
+* Returns the next value of the xorshift random number generator. It takes a few shifts, so it can be called from the Timer1 interrupt
+*/
+uint8_t Sequencer::getRandom()
+{
+    _randomState ^= _randomState << 7;
+    _randomState ^= _randomState >> 9;
+    _randomState ^= _randomState << 8;
 
-        else
-        {
-            _screenManager->updateDisplayedPlaybackStep(_steps[_playBackStep + 1], LENGTH, _playBackStep + 2);
-        }
+    return (uint8_t)_randomState;
+}
 
-        break;
+/*
+* Return the number of MIDI clock ticks of a step of a track regarding its step size
+* track: the track
+*/
+uint8_t Sequencer::getStepTicks(uint8_t track)
+{
+    return TICKS_PER_QUARTER / _trackStepSize[track];
+}
 
-    case RANDOM:
+/*
+* Display the sequence of the selected track and total number of sequences available, or its song position, general bpm, playback and record status and selected track
+* syncManager: object that contains the global Bpm value
+*/
+void Sequencer::printDefault(SyncManager syncManager)
+{
+    if (_selectedTrack == 0 && _songMode)
+    {
+        _screenManager->printDefaultSequencer(_songPosition + 1, _chainLength, syncManager.getBpm(), _playBackOn, _recording, _selectedTrack + 1, 1);
+    }
+
+    else
+    {
+        _screenManager->printDefaultSequencer(_trackSequence[_selectedTrack], NUM_SEQUENCES, syncManager.getBpm(), _playBackOn, _recording, _selectedTrack + 1, 0);
+    }
 
-        _screenManager->updateDisplayedPlaybackStep(_steps[_playBackStep], LENGTH, _playBackStep + 1);
+    // while playing, the second line shows the steps of the selected track instead of the playback status
+    if (_playBackOn && !_recording)
+    {
+        _screenManager->printStepGrid(getSequence(), getSequenceLength(), _trackPlayedStep[_selectedTrack]);
+    }
+}
 
-        break;
+/*
+* Move the current step of the step grid to the last step played by the selected track. Only the cells of
+* the steps that changed are sent to the screen
+*/
+void Sequencer::updateDisplayedPlaybackStep()
+{
+    if (_playBackOn && !_recording)
+    {
+        _screenManager->updateDisplayedPlaybackStep(getSequence(), getSequenceLength(), _trackPlayedStep[_selectedTrack]);
     }
 }
 
+/*
+* Display sequencer global configuration parameters
+* globalConfig: contains the global configuration of the system
+*/
+void Sequencer::printEditConfig(GlobalConfig globalConfig)
+{
+    _screenManager->printEditSequencerConfig(getPlayBackModeName(), getStepSizeName(), _trackMIDIChannel[_selectedTrack], globalConfig.getSendClockWhilePlayback());
+}
+
 /*
 * Display the screen with the step information for edit: current step, total available steps, note of the step, legato and enabled values
 */
 void Sequencer::printEditStepData()
 {
-    _screenManager->printEditStepData(_steps[0], 1, LENGTH);
+    _screenManager->printEditStepData(getSequence()[0], 1, _trackLength[_selectedTrack]);
 }
 
 /*
@@ -556,7 +1423,7 @@ void Sequencer::printPreviousStep()
 {
     if (_screenManager->getDisplayedStepNumber() - 1 > 0)
     {
-        _screenManager->printEditStepData(_steps[_screenManager->getDisplayedStepNumber() - 2], _screenManager->getDisplayedStepNumber() - 1, LENGTH);
+        _screenManager->printEditStepData(getSequence()[_screenManager->getDisplayedStepNumber() - 2], _screenManager->getDisplayedStepNumber() - 1, _trackLength[_selectedTrack]);
     }
 }
 
@@ -565,17 +1432,18 @@ void Sequencer::printPreviousStep()
 */
 void Sequencer::printNextStep()
 {
-    if (_screenManager->getDisplayedStepNumber() - 1 < LENGTH - 1)
+    if (_screenManager->getDisplayedStepNumber() < _trackLength[_selectedTrack])
     {
-        _screenManager->printEditStepData(_steps[_screenManager->getDisplayedStepNumber()], _screenManager->getDisplayedStepNumber() + 1, LENGTH);
+        _screenManager->printEditStepData(getSequence()[_screenManager->getDisplayedStepNumber()], _screenManager->getDisplayedStepNumber() + 1, _trackLength[_selectedTrack]);
     }
 }
 
 /*
-* When edit step information, move cursor to note value parameter
+* When edit step information, move cursor to note value parameter. The legato and enabled values are displayed again
 */
 void Sequencer::moveCursorToNote()
 {
+    _screenManager->printStepFlags(getSequence()[_screenManager->getDisplayedStepNumber() - 1]);
     _screenManager->moveCursorToStepNote();
 }
 
@@ -595,6 +1463,40 @@ void Sequencer::moveCursorToEnabled()
     _screenManager->moveCursorToStepEnabled();
 }
 
+/*
+* When edit step information, move cursor to sequence length parameter
+*/
+void Sequencer::moveCursorToLength()
+{
+    _screenManager->moveCursorToStepLength();
+}
+
+/*
+* When edit step information, move cursor to velocity parameter. The velocity, probability and ratchets values
+* are displayed instead of the legato and enabled ones
+*/
+void Sequencer::moveCursorToVelocity()
+{
+    _screenManager->printStepParameters(getSequence()[_screenManager->getDisplayedStepNumber() - 1]);
+    _screenManager->moveCursorToStepVelocity();
+}
+
+/*
+* When edit step information, move cursor to probability parameter
+*/
+void Sequencer::moveCursorToProbability()
+{
+    _screenManager->moveCursorToStepProbability();
+}
+
+/*
+* When edit step information, move cursor to ratchets parameter
+*/
+void Sequencer::moveCursorToRatchets()
+{
+    _screenManager->moveCursorToStepRatchets();
+}
+
 /*
 * When edit sequencer configuration, move cursor to playback mode parameter
 */
@@ -627,6 +1529,31 @@ void Sequencer::moveCursorToMIDIChannel()
     _screenManager->moveCursorToSequencerMIDIChannel();
 }
 
+/*
+* When edit sequencer configuration, display the euclidean pattern parameters and move cursor to the hits parameter
+*/
+void Sequencer::moveCursorToEuclideanHits()
+{
+    _screenManager->printEuclideanParameters(getEuclideanHits(), getEuclideanSteps(), getEuclideanRotation());
+    _screenManager->moveCursorToEuclideanHits();
+}
+
+/*
+* When edit sequencer configuration, move cursor to the euclidean pattern steps parameter
+*/
+void Sequencer::moveCursorToEuclideanSteps()
+{
+    _screenManager->moveCursorToEuclideanSteps();
+}
+
+/*
+* When edit sequencer configuration, move cursor to the euclidean pattern rotation parameter
+*/
+void Sequencer::moveCursorToEuclideanRotation()
+{
+    _screenManager->moveCursorToEuclideanRotation();
+}
+
 /*
 * When edit sequencer configuration, update the value of the playback mode parameter
 */
@@ -660,133 +1587,82 @@ void Sequencer::refreshDisplayedMIDIChannel(uint8_t midiChannel)
 }
 
 /*
-* Returns a char * with the playback mode to be displayed on the screen
+* Returns the name of the playback mode of the selected track to be displayed on the screen
 */
-char *Sequencer::getPlayBackModeName()
+const __FlashStringHelper *Sequencer::getPlayBackModeName()
 {
-    char buffer[10];
-
-    switch (_playBackMode)
-    {
-    case FORWARD:
-        getMessage(MSG_FORWARD, buffer);
-        break;
-
-    case BACKWARD:
-        getMessage(MSG_BACKWARD, buffer);
-        break;
-
-    case RANDOM:
-        getMessage(MSG_RANDOM, buffer);
-        break;
-
-    default:
-        getMessage(MSG_NA, buffer);
-    }
-
-    return buffer;
+    return getPlayBackModeName(_trackPlayBackMode[_selectedTrack]);
 }
 
 /*
-* Returns a char * with the step size to be displayed on the screen
+* Returns the name of the step size of the selected track to be displayed on the screen
 */
-char *Sequencer::getStepSizeName()
+const __FlashStringHelper *Sequencer::getStepSizeName()
 {
-    char buffer[5];
-
-    switch (_stepSize)
-    {
-    case QUARTER:
-        getMessage(MSG_QUARTER, buffer);
-        break;
-
-    case EIGHTH:
-        getMessage(MSG_EIGHTH, buffer);
-        break;
-
-    case SIXTEENTH:
-        getMessage(MSG_SIXTEENTH, buffer);
-        break;
-
-    case THIRTYSECOND:
-        getMessage(MSG_THIRTYSECOND, buffer);
-        break;
-
-    default:
-        getMessage(MSG_NA, buffer);
-    }
-
-    return buffer;
+    return getStepSizeName(_trackStepSize[_selectedTrack]);
 }
 
 /*
-* Returns a char * with the playback mode to be displayed on the screen
+* Returns the name of a playback mode to be displayed on the screen
 * playBackMode: the value to be returned
 */
-char *Sequencer::getPlayBackModeName(uint8_t playBackMode)
+const __FlashStringHelper *Sequencer::getPlayBackModeName(uint8_t playBackMode)
 {
-    char buffer[10];
-
     switch (playBackMode)
     {
     case FORWARD:
-        getMessage(MSG_FORWARD, buffer);
-        break;
+        return getString(MSG_FORWARD);
 
     case BACKWARD:
-        getMessage(MSG_BACKWARD, buffer);
-        break;
+        return getString(MSG_BACKWARD);
 
     case RANDOM:
-        getMessage(MSG_RANDOM, buffer);
-        break;
+        return getString(MSG_RANDOM);
+
+    case PING_PONG:
+        return getString(MSG_PING_PONG);
+
+    case RANDOM_WALK:
+        return getString(MSG_RANDOM_WALK);
+
+    case SHUFFLE:
+        return getString(MSG_SHUFFLE);
 
     default:
-        getMessage(MSG_NA, buffer);
+        return getString(MSG_NA);
     }
-
-    return buffer;
 }
 
 /*
-* Returns a char * with the step size to be displayed on the screen
+* Returns the name of a step size to be displayed on the screen
 * stepSize: the value to be returned 
 */
-char *Sequencer::getStepSizeName(uint8_t stepSize)
+const __FlashStringHelper *Sequencer::getStepSizeName(uint8_t stepSize)
 {
-    char buffer[5];
-
     switch (stepSize)
     {
     case QUARTER:
-        getMessage(MSG_QUARTER, buffer);
-        break;
+        return getString(MSG_QUARTER);
 
     case EIGHTH:
-        getMessage(MSG_EIGHTH, buffer);
-        break;
+        return getString(MSG_EIGHTH);
 
     case SIXTEENTH:
-        getMessage(MSG_SIXTEENTH, buffer);
-        break;
+        return getString(MSG_SIXTEENTH);
 
     case THIRTYSECOND:
-        getMessage(MSG_THIRTYSECOND, buffer);
-        break;
+        return getString(MSG_THIRTYSECOND);
 
     default:
-        getMessage(MSG_NA, buffer);
+        return getString(MSG_NA);
     }
-
-    return buffer;
 }
 
 /*
-* Load a string of chars from the PROGMEM
-* msgIndex: text to Load
-* buffer: array of chars where the text will be loaded
+* Return a string stored in PROGMEM
+* msgIndex: text to return
 */
-void Sequencer::getMessage(uint8_t msgIndex, char *buffer)
+const __FlashStringHelper *Sequencer::getString(uint8_t msgIndex)
 {
-    strcpy_P(buffer, (char *)pgm_read_word(&(sequencerMessages[msgIndex])));
+    return (const __FlashStringHelper *)pgm_read_word(&(sequencerMessages[msgIndex]));
 }
\ No newline at end of file
@@ -1,7 +1,8 @@
 /*
  * Sequencer.h
  *
- * Step sequencer implementation allowing three different playback modes (Forward, Backward and Random) and different step sizes (1/4, 1/8, 1/16 and 1/32) 
+ * Step sequencer implementation allowing six different playback modes (Forward, Backward, Random, Ping-Pong, Random Walk and Shuffle) and different step sizes (1/4, 1/8, 1/16 and 1/32) 
+ * The sequencer plays up to four tracks at the same time, each one with its own sequence, MIDI channel, playback mode and step size
  *
  * Copyright 2018 3K MEDIALAB
  *   
@@ -31,7 +32,11 @@
 #include "ControllerConfig.h"
 #include "GlobalConfig.h"
 #include "SyncManager.h"
+#include "EventScheduler.h"
+#include "EuclideanGenerator.h"
+#include "MIDIUtils.h"
 #include <avr/pgmspace.h>
+#include <util/atomic.h>
 
 #define MICROSECONDS_PER_MINUTE 60000000
 
@@ -44,6 +49,9 @@
 #define MSG_SIXTEENTH 5
 #define MSG_THIRTYSECOND 6
 #define MSG_NA 7
+#define MSG_PING_PONG 8
+#define MSG_RANDOM_WALK 9
+#define MSG_SHUFFLE 10
 
 // Messages that will be displayed on the screen
 const char msg_Forward[] PROGMEM = "Fwd";
@@ -54,8 +62,12 @@ const char msg_Eighth[] PROGMEM = "1/8";
 const char msg_Sixteenth[] PROGMEM = "1/16";
 const char msg_ThirtySecond[] PROGMEM = "1/32";
 const char msg_NA[] PROGMEM = "N/A";
+const char msg_PingPong[] PROGMEM = "P-P";
+const char msg_RandomWalk[] PROGMEM = "Wlk";
+const char msg_Shuffle[] PROGMEM = "Shf";
 
-const char *const sequencerMessages[] PROGMEM = {msg_Forward, msg_Backward, msg_Random, msg_Quarter, msg_Eighth, msg_Sixteenth, msg_ThirtySecond, msg_NA};
+const char *const sequencerMessages[] PROGMEM = {msg_Forward, msg_Backward, msg_Random, msg_Quarter, msg_Eighth, msg_Sixteenth, msg_ThirtySecond, msg_NA,
+                                                 msg_PingPong, msg_RandomWalk, msg_Shuffle};
 
 class Sequencer
 {
@@ -65,7 +77,10 @@ public:
   {
     FORWARD,
     BACKWARD,
-    RANDOM
+    RANDOM,
+    PING_PONG,
+    RANDOM_WALK,
+    SHUFFLE
   }; // playback modes
   enum
   {
@@ -77,48 +92,112 @@ public:
   enum
   {
     LENGTH = 16
-  }; // number of steps within a sequence
+  }; // number of steps of the region of each track. A longer sequence takes the regions of the following tracks
   enum
   {
-    PLAYBACK_MODE_TYPES = 3
+    TRACKS = SEQUENCER_TRACKS
+  }; // number of tracks played at the same time, each one with its own sequence
+  enum
+  {
+    PLAYBACK_MODE_TYPES = 6
   };
+  enum
+  {
+    TICKS_PER_QUARTER = 24
+  }; // MIDI clock ticks within a quarter note
+  enum
+  {
+    RENDER_BUFFER_SIZE = 3
+  }; // bytes of a pre-rendered step: note on of the next step
+  enum
+  {
+    NO_NOTE = 0xFF
+  }; // a rendered step that does not switch on any note
+  enum
+  {
+    NO_SEQUENCE = 0
+  }; // sequence number of a track that is off
+  enum
+  {
+    NO_TRACK = 0xFF
+  }; // no track is loading a sequence
+  enum
+  {
+    SONG = 0
+  }; // sequence number of the first track when it plays the song chain
+  enum
+  {
+    NO_PRELOAD,
+    PRELOAD_LOADING,
+    PRELOAD_READY
+  }; // status of the preload of the next sequence of the song chain
+  enum
+  {
+    RECORD_QUEUE_SIZE = 4
+  }; // recorded notes waiting to be written into the steps. It has to be a power of two
+  enum
+  {
+    LOAD_STEPS_PER_PASS = 8
+  }; // steps decoded from EEPROM on each main loop pass while playback is on
 
   uint8_t isPlayBackOn();
+  uint8_t isRecording();
   uint8_t isStepSizeValueValid(uint8_t stepSizeValue);
-  int8_t getPlayBackStep();
   uint8_t getPlayBackMode();
   uint8_t getPlayBackModeTypesNumber();
   uint8_t getMIDIChannel();
   uint8_t getSequenceLength();
+  uint8_t getMaxSequenceLength();
   uint8_t getCurrentSequence();
+  uint8_t getFirstSequence();
+  uint8_t getSelectedTrack();
+  uint8_t getTracksNumber();
   Step *getSequence();
-  Step getSequenceStep(uint8_t pos);
   uint8_t getStepSize();
+  uint8_t getEuclideanHits();
+  uint8_t getEuclideanSteps();
+  uint8_t getEuclideanRotation();
+  uint8_t wasSongPositionChanged();
+  void updateDisplayedPlaybackStep();
+  int8_t getTranspose();
+  uint8_t isScaleLockOn();
 
   void setMidiWorker(MidiWorker *midiWorker);
-  void setPlayBackStep(int8_t currentStep);
+  void setRecording(uint8_t recording);
+  void setTranspose(int8_t transpose);
+  void setScaleLock(uint8_t scaleLock);
+  void setScale(uint8_t rootNote, uint8_t mode);
   void setMIDIChannel(uint8_t channel);
   void setCurrentSequence(uint8_t numSequence);
+  void setSelectedTrack(uint8_t track);
   void setPlayBackMode(uint8_t mode);
   void setStepSize(uint8_t size);
   void setDisplayedStepNote(uint8_t note);
   void setDisplayedStepLegato(uint8_t legato);
   void setDisplayedStepEnabled(uint8_t enabled);
+  void setDisplayedStepVelocity(uint8_t velocity);
+  void setDisplayedStepProbability(uint8_t probability);
+  void setDisplayedStepRatchets(uint8_t ratchets);
+  void setDisplayedSequenceLength(uint8_t length);
+  void setEuclideanHits(uint8_t hits);
+  void setEuclideanSteps(uint8_t steps);
+  void setEuclideanRotation(uint8_t rotation);
   void refreshDisplayedPlayBackMode(uint8_t playBackMode);
   void refreshDisplayedSendClockWhilePlayback(uint8_t sendClockWhilePlayback);
   void refreshDisplayedStepSizeValue(uint8_t stepSize);
   void refreshDisplayedMIDIChannel(uint8_t midiChannel);
 
+  void loadChain();
   void loadCurrentSequence();
-  void saveCurrentSequence();
+  uint8_t saveCurrentSequence();
 
   void startPlayBack();
   void stopPlayBack();
-  uint8_t playBackSequence();
-  void stopNote();
+  void tick();
+  void renderNextStep();
+  void recordNote(uint8_t note, uint8_t velocity);
 
   void printDefault(SyncManager syncManager);
-  void updateDisplayedStep();
   void printEditStepData();
   void printPreviousStep();
   void printNextStep();
@@ -127,37 +206,139 @@ public:
   void moveCursorToNote();
   void moveCursorToLegato();
   void moveCursorToEnabled();
+  void moveCursorToLength();
+  void moveCursorToVelocity();
+  void moveCursorToProbability();
+  void moveCursorToRatchets();
   void moveCursorToPlayBackMode();
   void moveCursorToSendClockWhilePlayback();
   void moveCursorToStepSize();
   void moveCursorToMIDIChannel();
+  void moveCursorToEuclideanHits();
+  void moveCursorToEuclideanSteps();
+  void moveCursorToEuclideanRotation();
   void refreshDisplayedStepNote();
 
 private:
-  void playBackForward();
-  void playBackBackward();
-  void playBackRandom();
-  void stopAllNotes();
-  void stopCurrentNotePlayed();
+  void playTrackStep(uint8_t track);
+  void renderStep(uint8_t track);
+  uint8_t advanceForward(uint8_t track);
+  uint8_t advanceBackward(uint8_t track);
+  uint8_t advanceRandom(uint8_t track);
+  uint8_t advancePingPong(uint8_t track);
+  uint8_t advanceRandomWalk(uint8_t track);
+  uint8_t advanceShuffle(uint8_t track);
+  uint8_t getShuffleStride(uint8_t length);
+  void renderMessage(uint8_t track, uint8_t type, uint8_t note, uint8_t velocity);
+  void renderStepNote(uint8_t track, uint8_t step);
+  void writeRecordedNotes();
+  uint8_t mapNote(uint8_t note);
+  void resetTrack(uint8_t track);
+  void setTrackLength(uint8_t track, uint8_t length);
+  void updateCoveredTracks();
+  void loadTracks(uint8_t numSteps);
+  void completeTrackLoads();
+  void startSong();
+  void advanceSong();
+  void preloadNextSequence();
+  uint8_t getNextSongPosition();
+  uint8_t getStepTicks(uint8_t track);
+  uint8_t isBarStart(uint8_t track);
+  void startEuclideanPattern();
+  void completeEuclideanPattern();
+  void applyEuclideanPattern(uint8_t track);
+  uint8_t getRandom();
+  Step *getTrackSteps(uint8_t track);
 
-  char *getPlayBackModeName();
-  char *getPlayBackModeName(uint8_t playBackMode);
-  char *getStepSizeName();
-  char *getStepSizeName(uint8_t stepSize);
+  const __FlashStringHelper *getPlayBackModeName();
+  const __FlashStringHelper *getPlayBackModeName(uint8_t playBackMode);
+  const __FlashStringHelper *getStepSizeName();
+  const __FlashStringHelper *getStepSizeName(uint8_t stepSize);
+
+  const __FlashStringHelper *getString(uint8_t msgIndex);
+
+  struct RecordedNote
+  {
+    uint8_t note;     // note played
+    uint8_t velocity; // velocity of the note
+    uint8_t tick;     // MIDI clock tick when the note was played
+    uint8_t track;    // track the note is recorded into
+  };
 
-  void getMessage(uint8_t msgIndex, char *buffer);
+  typedef uint8_t (Sequencer::*AdvanceFunction)(uint8_t track);
+  static const AdvanceFunction advanceFunctions[PLAYBACK_MODE_TYPES]; // function that moves a track to its next step, one per playback mode
 
   uint8_t _playBackOn;                      // 1 when playback is on, 0 otherwise
-  int8_t _playBackStep;                     // current step being played
-  uint8_t _midiChannel;                     // MIDI channel of the sequencer
   MidiWorker *_midiWorker;                  // Worker to deal with MIDI operations
-  uint8_t _playBackMode;                    // playback mode (forward, Backward or Random)
-  uint8_t _stepSize;                        // step size, where 1/4 is the length of a quarter note
-  uint8_t _currentSequence;                 // current sequence assigned to the sequencer
-  Step _steps[LENGTH];                      // steps array within a sequence
-  uint8_t _stopCurrentPlayedNote;           // flag to stop current note being played
-  uint8_t _currentNotePlayed;               // current note being played
-  uint8_t _loadNewSequence;                 // indicates when a new sequence has been loaded
+  uint8_t _selectedTrack;                   // track shown on the screen and modified by the edit operations
+  uint16_t _randomState;                    // state of the xorshift random number generator
+  uint8_t _recording;                       // 1 when the notes played are recorded into the selected track, 0 otherwise
+  int8_t _transpose;                        // semitones added to the notes of every track when they are rendered
+  uint8_t _scaleLock;                       // 1 when the rendered notes are moved to the nearest note of the scale, 0 otherwise
+  uint8_t _scaleRootNote;                   // root note of the scale of the scale lock
+  uint8_t _scaleMode;                       // musical mode of the scale of the scale lock
+  uint16_t _scaleMask;                      // notes (C = bit 0) of the scale of the scale lock
+  int8_t _scaleOffsets[12];                 // semitones from every note of an octave to the nearest note within the scale. Rebuilt only when the scale changes
+  volatile uint8_t _clockTicks;             // MIDI clock ticks played since playback started, wrapping around. It timestamps the recorded notes
+
+  // Track table. Each array holds one value per track so the clock dispatch walks them with a single index
+  uint8_t _trackSequence[TRACKS];           // sequence assigned to each track. NO_SEQUENCE when the track is off
+  uint8_t _trackLength[TRACKS];             // number of steps of the sequence of each track
+  uint8_t _trackMIDIChannel[TRACKS];        // MIDI channel of each track
+  uint8_t _trackPlayBackMode[TRACKS];       // playback mode (Forward, Backward, Random, Ping-Pong, Random Walk or Shuffle) of each track
+  uint8_t _trackStepSize[TRACKS];           // step size of each track, where 1/4 is the length of a quarter note
+  int8_t _trackStep[TRACKS];                // next step to be rendered of each track
+  int8_t _trackDirection[TRACKS];           // direction (1 or -1) of each track in ping-pong mode
+  uint8_t _trackShufflePosition[TRACKS];    // position of each track within its shuffle cycle in shuffle mode
+  uint8_t _trackShuffleStride[TRACKS];      // steps moved by each track within its shuffle cycle, coprime with its length
+  uint8_t _trackTicks[TRACKS];              // MIDI clock ticks left until each track plays its next step
+  uint8_t _trackPlayedStep[TRACKS];         // last step played by each track
+  uint8_t _trackPlayedTick[TRACKS];         // MIDI clock tick when each track played its last step
+  uint8_t _trackEuclideanHits[TRACKS];      // hits of the last euclidean pattern generated for each track
+  uint8_t _trackEuclideanSteps[TRACKS];     // steps of the last euclidean pattern generated for each track
+  uint8_t _trackEuclideanRotation[TRACKS];  // rotation of the last euclidean pattern generated for each track
+  uint8_t _barTicks;                        // MIDI clock ticks played since the current bar started
+  uint8_t _coveredTracks;                   // tracks (one bit each) whose steps region is taken by a longer sequence of a previous track
+  uint8_t _loadTracks;                      // tracks (one bit each) whose new sequence has to be loaded
+  uint8_t _loadingTrack;                    // track whose sequence is being decoded from EEPROM. Its steps are muted until they are decoded
+  uint8_t _loadingStep;                     // next step of the loading track to be decoded
+
+  Step _steps[TRACKS * LENGTH];             // steps of all the tracks, one sequence after the other
+
+  uint8_t _renderBuffer[TRACKS][RENDER_BUFFER_SIZE]; // MIDI messages of the next step of each track, ready to be sent by the Timer1 interrupt
+  uint8_t _renderLength[TRACKS];                     // number of bytes within the render buffer of each track
+  uint8_t _renderedStep[TRACKS];                     // step of the sequence rendered for each track
+  uint8_t _renderedNote[TRACKS];                     // note switched on by the rendered step of each track
+  uint8_t _renderedGate[TRACKS];                     // MIDI clock ticks until the note off of the rendered step of each track
+  uint8_t _renderedRatchets[TRACKS];                 // number of times the note of the rendered step of each track is played
+  uint8_t _renderedRatchetTicks[TRACKS];             // MIDI clock ticks between two ratchets of the rendered step of each track
+  volatile uint8_t _renderedTracks;                  // tracks (one bit each) whose next step has been rendered and not sent yet
+  uint8_t _renderedLegato;                           // tracks (one bit each) whose rendered step is a legato one
+  uint8_t _legatoEvent[TRACKS];                      // scheduled event of the pending legato note off of each track. EventScheduler::NO_EVENT if there is none
+
+  // Song chain played by the first track. The first steps of the next sequence are preloaded during the last bar of the current one
+  uint8_t _songMode;                        // 1 when the first track plays the song chain, 0 otherwise
+  uint8_t _chainLength;                     // number of entries of the song chain
+  uint8_t _chainSequences[CHAIN_LENGTH];    // sequence number of each entry of the song chain
+  uint8_t _chainRepeats[CHAIN_LENGTH];      // times the sequence of each entry of the song chain is played
+  uint8_t _songPosition;                    // entry of the song chain being played
+  uint16_t _songSteps;                      // steps of the first track played since the current entry started
+  volatile uint8_t _songPositionChanged;    // 1 when the song has moved to another entry since the screen was refreshed
+  uint8_t _preloadStatus;                   // status of the preload of the next sequence
+  uint8_t _preloadLength;                   // number of steps of the preloaded sequence
+  uint8_t _preloadStep;                     // next step of the preloaded sequence to be decoded
+  Step _preloadSteps[LENGTH];               // first steps of the next sequence of the song chain
+
+  // Notes recorded by the main loop and written into the steps by the Timer1 interrupt. The main loop only moves the head
+  // and the interrupt only moves the tail, so no lock is needed
+  RecordedNote _recordQueue[RECORD_QUEUE_SIZE];
+  volatile uint8_t _recordHead;             // next free entry of the record queue
+  volatile uint8_t _recordTail;             // next recorded note to be written into the steps
+
+  EventScheduler _eventScheduler;           // Note offs waiting for the end of their gate
+
+  EuclideanGenerator _euclideanGenerator;   // Euclidean pattern being generated. It is the back buffer of the enabled flags of a track
+  uint8_t _euclideanTrack;                  // track the euclidean pattern is generated for. NO_TRACK if there is none
 
   MemoryManager *_memoryManager;            // Worker that manages memory load/store operations
   ScreenManager *_screenManager;            // Worker that manages screen display operations
@@ -5,6 +5,11 @@
  * Note: is the MIDI note that will be played
  * Enabled: wether the note should be played or not.
  * legato: wether the note should be played legato with the foloowing step
+ * Velocity: velocity of the note
+ * Probability: chance of the note to be played each time the step is reached
+ * Ratchets: number of times the note is repeated within the step
+ *
+ * The attributes are packed into three bytes, so a step takes the same memory as before
  *
  * Copyright 2018 3K MEDIALAB
  *   
@@ -27,42 +32,88 @@ Step::Step(){}
 
 Step::Step (uint8_t note, uint8_t enabled, uint8_t legato)
 {
-	_note = note;
-    _enabled = enabled;
-    _legato = legato;
+    _note = note & 0x7F;
+    _velocity = DEFAULT_VELOCITY;
+    _parameters = MAX_PROBABILITY;
+
+    setEnabled(enabled);
+    setLegato(legato);
 }
 
 uint8_t Step::getNote()
 {
-    return _note;
+    return _note & 0x7F;
 }
 
 uint8_t Step::isEnabled()
 {
-    return _enabled;
+    return bitRead(_velocity, 7);
 }
 
 uint8_t Step::isLegato()
 {
-    return _legato;
+    return bitRead(_note, 7);
+}
+
+uint8_t Step::getVelocity()
+{
+    return _velocity & 0x7F;
+}
+
+uint8_t Step::getProbability()
+{
+    return _parameters & 0x0F;
+}
+
+uint8_t Step::getRatchets()
+{
+    return ((_parameters >> 4) & 0x03) + 1;
+}
+
+/*
+* Returns 1 if the step velocity, probability and ratchets are the ones of a new step, 0 otherwise
+*/
+uint8_t Step::hasDefaultParameters()
+{
+    return (getVelocity() == DEFAULT_VELOCITY) && (_parameters == MAX_PROBABILITY);
 }
 
-static uint8_t Step::getSize()
+/*
+* Returns the size of a step stored into EEPROM: the note with the legato flag on its most significant bit.
+* The enabled flag is stored within the sequence bitmap. Velocity, probability and ratchets are only stored when
+* they are not the default ones
+*/
+uint8_t Step::getSize()
 {
-	return (sizeof(uint8_t) * 3);
+	return sizeof(uint8_t);
 }
 
 void Step::setNote(uint8_t note)
 {
-    _note = note;
+    _note = (_note & 0x80) | (note & 0x7F);
 }
 
 void Step::setEnabled(uint8_t enabled)
 {
-    _enabled = enabled;
+    bitWrite(_velocity, 7, enabled ? 1 : 0);
 }
 
 void Step::setLegato(uint8_t legato)
 {
-    _legato = legato;
-}
\ No newline at end of file
+    bitWrite(_note, 7, legato ? 1 : 0);
+}
+
+void Step::setVelocity(uint8_t velocity)
+{
+    _velocity = (_velocity & 0x80) | (velocity & 0x7F);
+}
+
+void Step::setProbability(uint8_t probability)
+{
+    _parameters = (_parameters & 0xF0) | (min(probability, MAX_PROBABILITY) & 0x0F);
+}
+
+void Step::setRatchets(uint8_t ratchets)
+{
+    _parameters = (_parameters & 0x0F) | (((constrain(ratchets, 1, MAX_RATCHETS) - 1) & 0x03) << 4);
+}
@@ -5,6 +5,11 @@
  * Note: is the MIDI note that will be played
  * Enabled: wether the note should be played or not.
  * legato: wether the note should be played legato with the foloowing step
+ * Velocity: velocity of the note
+ * Probability: chance of the note to be played each time the step is reached
+ * Ratchets: number of times the note is repeated within the step
+ *
+ * The attributes are packed into three bytes, so a step takes the same memory as before
  *
  * Copyright 2018 3K MEDIALAB
  *   
@@ -32,22 +37,46 @@ class Step
   
   Step();
 	Step (uint8_t note, uint8_t enabled, uint8_t legato);
+
+    enum
+    {
+      DEFAULT_NOTE = 60
+    }; // note (C4) of a step that is not stored into EEPROM because it is disabled
+    enum
+    {
+      DEFAULT_VELOCITY = 127
+    }; // velocity of a new step
+    enum
+    {
+      MAX_PROBABILITY = 15
+    }; // probability level of a step that is always played. Level n plays the step (n + 1) times out of 16
+    enum
+    {
+      MAX_RATCHETS = 4
+    }; // maximum number of times the note of a step is repeated within the step
 	
     uint8_t getNote();
     uint8_t isEnabled();
     uint8_t isLegato();
+    uint8_t getVelocity();
+    uint8_t getProbability();
+    uint8_t getRatchets();
+    uint8_t hasDefaultParameters();
 
     void setNote (uint8_t note);
     void setEnabled(uint8_t enabled);
     void setLegato(uint8_t legato);    
+    void setVelocity(uint8_t velocity);
+    void setProbability(uint8_t probability);
+    void setRatchets(uint8_t ratchets);
 	
 	static uint8_t getSize();
 
   private:
 
-    uint8_t _note;
-    uint8_t _enabled;
-    uint8_t _legato;
+    uint8_t _note;        // note (bits 0-6) and legato flag (bit 7)
+    uint8_t _velocity;    // velocity (bits 0-6) and enabled flag (bit 7)
+    uint8_t _parameters;  // probability level (bits 0-3) and number of ratchets minus one (bits 4-5)
   
 };
 #endif
\ No newline at end of file
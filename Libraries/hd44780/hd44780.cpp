@@ -85,18 +85,21 @@ hd44780::hd44780()
 
 	setExecTimes(HD44780_CHEXECTIME, HD44780_INSEXECTIME);
 
+	_busyFlagPolling = 0;
 	markStart(0); // initialize last start time to 'now'
 }
 
 hd44780::hd44780(uint8_t cols, uint8_t rows) : _cols(cols), _rows(rows)
 {
 	setExecTimes(HD44780_CHEXECTIME, HD44780_INSEXECTIME);
+	_busyFlagPolling = 0;
 	markStart(0); // initialize last start time to 'now'
 }
 
 hd44780::hd44780(uint8_t cols, uint8_t rows, uint32_t chExecTimeUs, uint32_t insExecTimeus) :
 		 _cols(cols), _rows(rows), _chExecTime(chExecTimeUs), _insExecTime(insExecTimeus)
 {
+	_busyFlagPolling = 0;
 	markStart(0); // initialize last start time to 'now'
 }
 
@@ -789,6 +792,94 @@ int rvalue = ioread(HD44780_IOcmd);
 	return(rvalue);
 }
 
+// busyFlagPolling() - read the busy flag to know when long commands end
+// The clear and home commands are specified to take up to 2ms, but
+// most LCDs finish them much sooner. With busy flag polling the LCD is
+// considered ready as soon as the busy flag is cleared, instead of
+// after the whole execution time.
+// Short commands and data writes keep using their execution time as
+// reading the status takes longer than them on most i/o interfaces.
+// returns:
+// 	success: zero
+//	failure: non zero if status reads are not supported by the i/o subclass
+int hd44780::busyFlagPolling()
+{
+	if(status() < 0)
+		return(RV_ENOTSUP);
+
+	_busyFlagPolling = 1;
+	return(RV_ENOERR);
+}
+
+// isReady() - check if the LCD can take the next command or data byte
+// returns:
+// 	1 if the LCD is ready, 0 if it is still executing the last command
+int hd44780::isReady()
+{
+	return(ready(0));
+}
+
+// tryWrite() - write a data byte to the LCD only if it is ready
+// Unlike write() it never waits, so the caller can do other work
+// and try again later.
+// returns:
+// 	success: zero
+//	failure: RV_EBUSY if the LCD was not ready, other non zero on error
+int hd44780::tryWrite(uint8_t value)
+{
+	if(!isReady())
+		return(RV_EBUSY);
+
+	if(write(value) != 1)
+		return(RV_EIO);
+
+	return(RV_ENOERR);
+}
+
+// tryWrite() - write a block of data bytes to the LCD only if it is ready
+// returns:
+// 	success: zero
+//	failure: RV_EBUSY if the LCD was not ready, other non zero on error
+int hd44780::tryWrite(const uint8_t *buffer, size_t size)
+{
+	if(!isReady())
+		return(RV_EBUSY);
+
+	if(write(buffer, size) != size)
+		return(RV_EIO);
+
+	return(RV_ENOERR);
+}
+
+// ready() - check execution time and busy flag of the last command
+// offsetUs: time in Us the i/o interface takes before the LCD sees
+//           the next command, which can be discounted from the wait
+// returns:
+// 	1 if the LCD is ready, 0 if it is still executing the last command
+int hd44780::ready(int32_t offsetUs)
+{
+int rvalue;
+
+	if((((uint32_t)micros()) - (_startTime + offsetUs)) >= _execTime)
+		return(1);
+
+	if(_busyFlagPolling && (_execTime > _insExecTime))
+	{
+		// i/o classes may wait for the LCD inside ioread(),
+		// so polling is disabled while reading the status
+		_busyFlagPolling = 0;
+		rvalue = status();
+		_busyFlagPolling = 1;
+
+		if((rvalue >= 0) && !(rvalue & HD44780_BUSYFLAG))
+		{
+			markStart(0); // command finished, no more execution time
+			return(1);
+		}
+	}
+	return(0);
+}
+
 // read() - read a data byte from LCD
 // returns:
 // 	success: 8 bit value read
@@ -829,6 +920,38 @@ size_t rval;
 }
 
 
+// write() - process a block of data character bytes to lcd
+// When there is no line processing to do, the whole block is handed
+// to the i/o class so it can send it with as few transfers as possible.
+// i/o classes without block write support get the bytes one at a time.
+// returns number of bytes successfully written to device
+size_t hd44780::write(const uint8_t *buffer, size_t size)
+{
+size_t n = 0;
+int status;
+
+	if(!_wraplines)
+	{
+		status = iowrite(HD44780_IOdata, buffer, size);
+		if(status != RV_ENOTSUP)
+		{
+			markStart(_insExecTime);
+			if(status)
+				return(0); // block write was unsuccessful
+			return(size);
+		}
+	}
+
+	while(size--)
+	{
+		if(write(*buffer++))
+			n++;
+		else
+			break;
+	}
+	return(n);
+}
+
 // _write() - send raw data byte to lcd
 // returns 1 if success or 0 if no byte was processed (error)
 size_t hd44780::_write(uint8_t value)
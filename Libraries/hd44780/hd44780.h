@@ -119,6 +119,9 @@ public:
 	static const uint8_t HD44780_SETCGRAMADDR = 0x40;
 	static const uint8_t HD44780_SETDDRAMADDR = 0x80;
 
+	// status byte flags
+	static const uint8_t HD44780_BUSYFLAG = 0x80;
+
 	// flags for entry mode set;
 	static const uint8_t HD44780_ENTRYLEFT2RIGHT = 0x02;
 	static const uint8_t HD44780_ENTRYAUTOSHIFT = 0x01;
@@ -191,6 +194,7 @@ public:
 	int setCursor(uint8_t col, uint8_t row); 
 	size_t write(uint8_t value);	// does char & line processing
 	size_t _write(uint8_t value);	// does not do char & line processing
+	size_t write(const uint8_t *buffer, size_t size); // block write, burst when no line processing
 // write() overloads for 0 or null which is an int
 // This is only because Print class doesn't do it.
 	inline size_t write(unsigned int value) { return(write((uint8_t)value)); }
@@ -345,6 +349,17 @@ public:
 	// disable automatic line wrapping
 	int noLineWrap(void){ _wraplines=0; return(RV_ENOERR);};		// turn off automatic line wrapping
 
+	// enable busy flag polling (needs status read support from the i/o class)
+	int busyFlagPolling(void);
+	// disable busy flag polling
+	int noBusyFlagPolling(void){ _busyFlagPolling=0; return(RV_ENOERR);};	// turn off busy flag polling
+
+	// non blocking interface: check if the lcd can take the next command or data
+	// and write to the lcd only if it can, instead of waiting for it
+	int isReady(void);
+	int tryWrite(uint8_t value);
+	int tryWrite(const uint8_t *buffer, size_t size);
+
 	// set execution times for commmands to override defaults
 	inline void setExecTimes(uint32_t chExecTimeUs, uint32_t insExecTimeUs)
 		{ _chExecTime = chExecTimeUs; _insExecTime = insExecTimeUs;}
@@ -369,8 +384,8 @@ protected:
 	uint8_t _rows;
 
 	// wait for lcd to be ready
-	inline void waitReady() {_waitReady((_startTime), _execTime);}
-	inline void waitReady(int32_t offsetUs) {_waitReady((_startTime+offsetUs), _execTime);}
+	inline void waitReady() {while(!ready(0)){}}
+	inline void waitReady(int32_t offsetUs) {while(!ready(offsetUs)){}}
 
 	inline void _waitReady(uint32_t _stime, uint32_t _etime)
 		{while(( ((uint32_t)micros()) - _stime) < _etime){}}
@@ -380,16 +395,20 @@ private:
 	uint8_t _curcol;	// current LCD col if doing char & line processing
 	uint8_t _currow;	// current LCD row if doing char & line processing
 	uint8_t _wraplines;	// set to nonzero if wrapping long lines
+	uint8_t _busyFlagPolling; // set to nonzero if reading the busy flag during long commands
 
 	// i/o subclass functions
 	virtual int ioinit() {return 0;}	// optional - successful if not implemented
 	virtual int ioread(hd44780::iotype type) {if(type) return(RV_ENOTSUP);else return(RV_ENOTSUP);}	// optional, return fail if not implemented
 	virtual int iowrite(hd44780::iotype type, uint8_t value)=0;// mandatory
+	virtual int iowrite(hd44780::iotype type, const uint8_t *values, size_t count){if(type || values || count) return(RV_ENOTSUP);else return(RV_ENOTSUP);}	// optional, block write
 	virtual int iosetBacklight(uint8_t dimvalue){if(dimvalue) return(RV_ENOTSUP); else return(RV_ENOTSUP);}	// optional
 	virtual int iosetContrast(uint8_t contvalue){if(contvalue) return(RV_ENOTSUP); else return(RV_ENOTSUP);}// optional
 
 	uint8_t _rowOffsets[4]; // memory address of start of each row/line
 
+	int ready(int32_t offsetUs); // check execution time and busy flag
+
 	// stuff for tracking execution times
 	inline void markStart(uint32_t exectime) { _startTime = (uint32_t) micros(); _execTime = exectime;}
 	uint32_t _chExecTime;	// time in Us of execution time for clear/home
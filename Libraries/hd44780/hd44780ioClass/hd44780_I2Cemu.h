@@ -0,0 +1,560 @@
+// vi:ts=4
+// ---------------------------------------------------------------------------
+//  hd44780_I2Cemu.h - hd44780_I2Cemu i/o subclass for hd44780 library
+//  Copyright (c) 2018  3K MEDIALAB
+//
+// ---------------------------------------------------------------------------
+//
+//  This file is part of the hd44780 library
+//
+//  hd44780_I2Cemu is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation version 3 of the License.
+//
+//  hd44780_I2Cemu is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with hd44780_I2Cemu.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// It implements a host side hd44780 library i/o subclass that emulates
+// an hd44780 LCD behind a PCF8574 i2c i/o expander backpack, so the code
+// that drives the LCD can be run and measured without hardware.
+//
+// The i/o functions build the same expander port writes that
+// hd44780_I2Cexp sends over i2c, including the burst block writes.
+// Each port write is fed into an emulated PCF8574 and each falling edge
+// of E latches a nibble (4 bit mode) or a byte (8 bit mode) into an
+// emulated hd44780 with its DDRAM, CGRAM, address counter, entry mode,
+// display control and display shift.
+//
+// The emulator keeps its own clock instead of using micros():
+// - every i2c byte takes 9 bit times (8 bits + ack) and every transaction
+//   adds a start, the address byte and a stop.
+// - before each write the host waits for the execution time of the last
+//   command, as the hd44780 base class does with its default execution
+//   times, and that wait is accounted apart from the bus time.
+// - the emulated LCD is busy for 37us after each instruction or data
+//   byte and 1.52ms after clear and home. A strobe while it is busy is
+//   counted as a busy violation: real LCDs lose those writes.
+//
+// The rendered text can be read with getLine() for assertions.
+//
+// Expander pin mapping is the common PCF8574 backpack one:
+//	rs=0, rw=1, en=2, bl=3 (active HIGH), d4=4, d5=5, d6=6, d7=7
+//
+// ---------------------------------------------------------------------------
+
+#ifndef hd44780_I2Cemu_h
+#define hd44780_I2Cemu_h
+
+// size of the emulated Wire library transmit buffer
+#define hd44780_I2Cemu_BUFFER_LENGTH 32
+
+class hd44780_I2Cemu : public hd44780
+{
+public:
+// ====================
+// === constructors ===
+// ====================
+
+// emulate a 400Khz i2c bus
+hd44780_I2Cemu() : _bitTimeNs(2500) { powerOn(); }
+
+// emulate an i2c bus at a given clock frequency
+hd44780_I2Cemu(uint32_t busClockHz) : _bitTimeNs(1000000000UL / busClockHz) { powerOn(); }
+
+// ===========================
+// === emulator inspection ===
+// ===========================
+
+// getLine() - copy the characters shown on a row of the display
+// buffer must have room for the columns of the display plus the '\0'
+// returns the buffer, or an empty string for rows out of the display
+char *getLine(uint8_t row, char *buffer)
+{
+uint8_t col;
+
+	buffer[0] = '\0';
+	if(row >= _rows)
+		return(buffer);
+
+	for(col = 0; col < _cols; col++)
+	{
+		buffer[col] = _ddram[ddramIndex((row ? 0x40 : 0x00) + ((col + _shift) % LINE_LENGTH))];
+	}
+	buffer[col] = '\0';
+	return(buffer);
+}
+
+// getCGRAM() - return the 8 rows of a custom character
+const uint8_t *getCGRAM(uint8_t charval)
+{
+	return(&_cgram[(charval & 0x7) * 8]);
+}
+
+// display state
+uint8_t getAddressCounter() { return(_ac); }
+uint8_t isDisplayOn() { return((_displayCtl & HD44780_DISPLAYON) != 0); }
+uint8_t isBacklightOn() { return((_port & BL) != 0); }
+
+// accounting
+uint32_t getTransactions() { return(_transactions); }	// i2c transactions
+uint32_t getBusBytes() { return(_busBytes); }			// i2c bytes, addresses included
+uint64_t getBusTimeNs() { return(_busTimeNs); }			// time spent on the i2c bus
+uint64_t getWaitTimeNs() { return(_waitTimeNs); }		// time waiting for lcd execution times
+uint64_t getTimeNs() { return(_nowNs); }				// emulated time since power on
+uint32_t getBusyViolations() { return(_busyViolations); }	// strobes while the lcd was busy
+
+// resetStats() - clear the accounting, the display state is kept
+void resetStats()
+{
+	_transactions = 0;
+	_busBytes = 0;
+	_busTimeNs = 0;
+	_waitTimeNs = 0;
+	_busyViolations = 0;
+}
+
+private:
+// ==========================
+// === emulator constants ===
+// ==========================
+
+// expander pin masks
+static const uint8_t RS = (1 << 0);
+static const uint8_t RW = (1 << 1);
+static const uint8_t EN = (1 << 2);
+static const uint8_t BL = (1 << 3);
+
+// hd44780 memory sizes
+static const uint8_t LINE_LENGTH = 40;	// DDRAM characters per line in 2 line mode
+static const uint8_t DDRAM_SIZE = 80;
+static const uint8_t CGRAM_SIZE = 64;
+
+// hd44780 execution times at 270Khz (Table 6 of the Hitachi datasheet)
+static const uint32_t LCD_INSEXECTIME_NS = 37000;
+static const uint32_t LCD_CHEXECTIME_NS = 1520000;
+
+// host side offset of the execution time wait, as hd44780_I2Cexp does
+static const uint32_t WAIT_OFFSET_NS = 45000;
+
+// ====================
+// === private data ===
+// ====================
+
+const uint32_t _bitTimeNs;	// i2c bit time
+
+// expander state
+uint8_t _port;			// expander output port
+
+// lcd state
+uint8_t _ddram[DDRAM_SIZE];	// display data ram, line 1 first
+uint8_t _cgram[CGRAM_SIZE];	// character generator ram
+uint8_t _ac;			// address counter
+uint8_t _cgmode;		// set when the address counter points to CGRAM
+uint8_t _entryMode;		// entry mode set flags
+uint8_t _displayCtl;	// display on/off control flags
+uint8_t _shift;			// display shift in characters
+uint8_t _fourBitMode;	// set when the interface is 4 bits wide
+uint8_t _twoLines;		// set when the display has 2 lines
+uint8_t _nibble;		// upper nibble latched in 4 bit mode
+uint8_t _haveNibble;	// set when the upper nibble was latched
+uint64_t _busyUntilNs;	// time when the lcd ends the last instruction
+
+// host state
+uint64_t _nowNs;		// emulated time
+uint64_t _readyNs;		// time when the host considers the lcd ready
+
+// accounting
+uint32_t _transactions;
+uint32_t _busBytes;
+uint64_t _busTimeNs;
+uint64_t _waitTimeNs;
+uint32_t _busyViolations;
+
+// ==================================================
+// === hd44780 i/o subclass virtual i/o functions ===
+// ==================================================
+
+// ioinit() - initialize the expander port
+// Returns non zero if initialization failed.
+int ioinit()
+{
+	beginTransmission();
+	portWrite(0); // Set the entire output port to LOW
+	endTransmission();
+	return(hd44780::RV_ENOERR);
+}
+
+// ioread(type) - read status or a data byte from the emulated lcd
+// The bus traffic is the one of hd44780_I2Cexp: 2 nibble reads, each one
+// with a port write to raise E, an i2c read and a port write to lower E.
+// returns:
+// 	success:  8 bit value read
+int ioread(hd44780::iotype type)
+{
+uint8_t gpioValue = (_port & BL) | 0xf0 | RW;
+int iodata;
+
+	// the busy flag can be read while an instruction is executing
+	if(type == hd44780::HD44780_IOdata)
+		hostWait();
+
+	if(type == hd44780::HD44780_IOdata)
+		gpioValue |= RS;
+
+	beginTransmission();
+	portWrite(gpioValue);
+	endTransmission();
+
+	for(uint8_t i = 0; i < 2; i++)
+	{
+		beginTransmission();
+		portWrite(gpioValue | EN);
+		endTransmission();
+
+		beginTransmission();
+		busByte(); // port value read back
+		endTransmission();
+
+		beginTransmission();
+		portWrite(gpioValue);
+		endTransmission();
+	}
+
+	if(type == hd44780::HD44780_IOdata)
+	{
+		iodata = _cgmode ? _cgram[_ac & (CGRAM_SIZE - 1)] : _ddram[ddramIndex(_ac)];
+		moveAddressCounter();
+		_readyNs = _nowNs + ((uint64_t)HD44780_INSEXECTIME * 1000);
+		return(iodata);
+	}
+
+	iodata = _ac;
+	if(_nowNs < _busyUntilNs)
+		iodata |= HD44780_BUSYFLAG;
+	return(iodata);
+}
+
+// iowrite(type, value) - send either command or data byte to lcd
+// returns zero on success
+int iowrite(hd44780::iotype type, uint8_t value)
+{
+	hostWait();
+
+	// the initialization 4 bit commands are followed by delay() calls
+	// that are not seen by the emulated clock
+	if(type == hd44780::HD44780_IOcmd4bit && _nowNs < _busyUntilNs)
+		_nowNs = _busyUntilNs;
+
+	beginTransmission();
+	write4bits((value >> 4), type);
+	if(type != hd44780::HD44780_IOcmd4bit)
+	{
+		write4bits((value & 0x0F), type);
+	}
+	endTransmission();
+
+	markReady(type, value);
+	return(hd44780::RV_ENOERR);
+}
+
+// iowrite(type, values, count) - send a block of command or data bytes to lcd
+// As many bytes as fit in the Wire buffer are sent in each transaction
+// returns zero on success, non zero on failure
+int iowrite(hd44780::iotype type, const uint8_t *values, size_t count)
+{
+uint8_t bytes;
+
+	if(type == hd44780::HD44780_IOcmd4bit)
+		return(hd44780::RV_ENOTSUP);
+
+	hostWait();
+
+	while(count)
+	{
+		beginTransmission();
+		bytes = 0;
+		while(count && (bytes + 4) <= hd44780_I2Cemu_BUFFER_LENGTH)
+		{
+			write4bits((*values >> 4), type);
+			write4bits((*values & 0x0F), type);
+			markReady(type, *values);
+			values++;
+			count--;
+			bytes += 4;
+		}
+		endTransmission();
+	}
+
+	return(hd44780::RV_ENOERR);
+}
+
+// iosetBacklight()  - set backlight brightness
+// any non zero value will turn on the backlight.
+int iosetBacklight(uint8_t dimvalue)
+{
+	beginTransmission();
+	portWrite(dimvalue ? BL : 0);
+	endTransmission();
+	return(hd44780::RV_ENOERR);
+}
+
+// ================================
+// === internal class functions ===
+// ================================
+
+// powerOn() - lcd state after power on: 8 bit interface, 1 line, display off
+void powerOn()
+{
+	_port = 0;
+	for(uint8_t i = 0; i < DDRAM_SIZE; i++)
+		_ddram[i] = ' ';
+	for(uint8_t i = 0; i < CGRAM_SIZE; i++)
+		_cgram[i] = 0;
+	_ac = 0;
+	_cgmode = 0;
+	_entryMode = HD44780_ENTRYLEFT2RIGHT;
+	_displayCtl = 0;
+	_shift = 0;
+	_fourBitMode = 0;
+	_twoLines = 0;
+	_nibble = 0;
+	_haveNibble = 0;
+	_busyUntilNs = 0;
+	_nowNs = 0;
+	_readyNs = 0;
+	resetStats();
+}
+
+// hostWait() - wait for the execution time of the last command,
+// minus the time the i2c transfer takes to reach the lcd
+void hostWait()
+{
+	if(_nowNs + WAIT_OFFSET_NS < _readyNs)
+	{
+		_waitTimeNs += _readyNs - WAIT_OFFSET_NS - _nowNs;
+		_nowNs = _readyNs - WAIT_OFFSET_NS;
+	}
+}
+
+// markReady() - set when the host considers the lcd ready again,
+// using the default execution times of the hd44780 base class
+void markReady(hd44780::iotype type, uint8_t value)
+{
+uint32_t execTimeUs = HD44780_INSEXECTIME;
+
+	if(type != hd44780::HD44780_IOdata &&
+			(value == HD44780_CLEARDISPLAY || value == HD44780_RETURNHOME))
+	{
+		execTimeUs = HD44780_CHEXECTIME;
+	}
+	_readyNs = _nowNs + ((uint64_t)execTimeUs * 1000);
+}
+
+// i2c bus accounting
+void beginTransmission()
+{
+	_transactions++;
+	busTime(1); // start condition
+	busByte();  // address byte
+}
+
+void endTransmission()
+{
+	busTime(1); // stop condition
+}
+
+void busByte()
+{
+	_busBytes++;
+	busTime(9);
+}
+
+void busTime(uint8_t bits)
+{
+	_busTimeNs += (uint64_t)bits * _bitTimeNs;
+	_nowNs += (uint64_t)bits * _bitTimeNs;
+}
+
+// write4bits - send a nibble through the emulated expander port
+void write4bits(uint8_t value, hd44780::iotype type)
+{
+uint8_t gpioValue = (_port & BL) | ((value & 0x0F) << 4);
+
+	if(type == hd44780::HD44780_IOdata)
+	{
+		gpioValue |= RS;
+	}
+
+	portWrite(gpioValue | EN); // with E HIGH
+	portWrite(gpioValue);      // with E LOW
+}
+
+// portWrite() - send a byte to the expander and decode the lcd signals
+void portWrite(uint8_t gpioValue)
+{
+uint8_t strobe = (_port & EN) && !(gpioValue & EN);
+
+	busByte();
+	_port = gpioValue;
+
+	// the lcd latches its inputs on the falling edge of E
+	if(!strobe || (gpioValue & RW))
+		return;
+
+	if(_nowNs < _busyUntilNs)
+		_busyViolations++;
+
+	if(!_fourBitMode)
+	{
+		// d0-d3 are not wired, they are read as zeros
+		latch(gpioValue & RS, gpioValue & 0xf0);
+	}
+	else if(!_haveNibble)
+	{
+		_nibble = gpioValue & 0xf0;
+		_haveNibble = 1;
+	}
+	else
+	{
+		_haveNibble = 0;
+		latch(gpioValue & RS, _nibble | (gpioValue >> 4));
+	}
+}
+
+// latch() - execute an instruction or a data write
+void latch(uint8_t rs, uint8_t value)
+{
+uint32_t execTimeNs = LCD_INSEXECTIME_NS;
+
+	if(rs)
+	{
+		if(_cgmode)
+			_cgram[_ac & (CGRAM_SIZE - 1)] = value;
+		else
+			_ddram[ddramIndex(_ac)] = value;
+
+		moveAddressCounter();
+		if(!_cgmode && (_entryMode & HD44780_ENTRYAUTOSHIFT))
+			shiftDisplay(!(_entryMode & HD44780_ENTRYLEFT2RIGHT));
+	}
+	else if(value & HD44780_SETDDRAMADDR)
+	{
+		_ac = value & 0x7f;
+		_cgmode = 0;
+	}
+	else if(value & HD44780_SETCGRAMADDR)
+	{
+		_ac = value & 0x3f;
+		_cgmode = 1;
+	}
+	else if(value & HD44780_FUNCTIONSET)
+	{
+		_fourBitMode = !(value & HD44780_8BITMODE);
+		_twoLines = (value & HD44780_2LINE) != 0;
+		_haveNibble = 0;
+	}
+	else if(value & HD44780_CURDISPSHIFT)
+	{
+		if(value & HD44780_DISPLAYMOVE)
+			shiftDisplay(value & HD44780_MOVERIGHT);
+		else
+			moveAddressCounter(value & HD44780_MOVERIGHT);
+	}
+	else if(value & HD44780_DISPLAYCONTROL)
+	{
+		_displayCtl = value;
+	}
+	else if(value & HD44780_ENTRYMODESET)
+	{
+		_entryMode = value;
+	}
+	else if(value & HD44780_RETURNHOME)
+	{
+		_ac = 0;
+		_cgmode = 0;
+		_shift = 0;
+		execTimeNs = LCD_CHEXECTIME_NS;
+	}
+	else if(value & HD44780_CLEARDISPLAY)
+	{
+		for(uint8_t i = 0; i < DDRAM_SIZE; i++)
+			_ddram[i] = ' ';
+		_ac = 0;
+		_cgmode = 0;
+		_shift = 0;
+		_entryMode |= HD44780_ENTRYLEFT2RIGHT;
+		execTimeNs = LCD_CHEXECTIME_NS;
+	}
+
+	_busyUntilNs = _nowNs + execTimeNs;
+}
+
+// moveAddressCounter() - move the address counter as set in the entry mode
+void moveAddressCounter()
+{
+	moveAddressCounter(_entryMode & HD44780_ENTRYLEFT2RIGHT);
+}
+
+// moveAddressCounter() - move the address counter one position
+// DDRAM addresses are 0x00-0x27 and 0x40-0x67 in 2 line mode,
+// 0x00-0x4f in 1 line mode
+void moveAddressCounter(uint8_t increment)
+{
+	if(_cgmode)
+	{
+		_ac = (_ac + (increment ? 1 : CGRAM_SIZE - 1)) & (CGRAM_SIZE - 1);
+		return;
+	}
+
+	if(!_twoLines)
+	{
+		_ac = (_ac + (increment ? 1 : DDRAM_SIZE - 1)) % DDRAM_SIZE;
+		return;
+	}
+
+	if(increment)
+	{
+		if(_ac == 0x27)
+			_ac = 0x40;
+		else if(_ac == 0x67)
+			_ac = 0x00;
+		else
+			_ac++;
+	}
+	else
+	{
+		if(_ac == 0x40)
+			_ac = 0x27;
+		else if(_ac == 0x00)
+			_ac = 0x67;
+		else
+			_ac--;
+	}
+}
+
+// shiftDisplay() - shift the display one position
+// a shift to the left shows the characters on the right
+void shiftDisplay(uint8_t right)
+{
+	_shift = (_shift + (right ? LINE_LENGTH - 1 : 1)) % LINE_LENGTH;
+}
+
+// ddramIndex() - position in DDRAM of an address
+uint8_t ddramIndex(uint8_t address)
+{
+	if(!_twoLines)
+		return(address % DDRAM_SIZE);
+
+	return(((address & 0x40) ? LINE_LENGTH : 0) + ((address & 0x3f) % LINE_LENGTH));
+}
+
+}; // end of class definition
+
+#endif
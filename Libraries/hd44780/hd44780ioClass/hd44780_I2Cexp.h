@@ -185,6 +185,14 @@
                                                                       // It sounds like it changes to vcc with is REALLY dumb!
 
 
+// size of the Wire library transmit buffer. Block writes are split
+// into i2c transactions that fit in it.
+#if defined(BUFFER_LENGTH)
+#define hd44780_I2Cexp_BUFFER_LENGTH BUFFER_LENGTH
+#else
+#define hd44780_I2Cexp_BUFFER_LENGTH 32
+#endif
+
 //FIXME these can't go in the class unless they are referenced using the classname
 
 enum I2CexpType { I2Cexp_UNKNOWN, I2Cexp_PCF8574, I2Cexp_MCP23008 };
@@ -271,6 +279,10 @@ enum I2CexpProp
 	Prop_d7,
 	Prop_bl,
 	Prop_blLevel,
+#if defined(hd44780_I2Cexp_STATS)
+	Prop_i2cTransactions,
+	Prop_i2cBytes,
+#endif
 };
 
 int mask2bit(uint8_t mask)
@@ -309,6 +321,12 @@ int getProp(I2CexpProp propID)
 			return(mask2bit(_bl));
 		case Prop_blLevel:
 			return(_blLevel);
+#if defined(hd44780_I2Cexp_STATS)
+		case Prop_i2cTransactions:
+			return(_i2cTransactions);
+		case Prop_i2cBytes:
+			return(_i2cBytes);
+#endif
 		default:
 			return(hd44780::RV_EINVAL);
 	}
@@ -333,6 +351,12 @@ uint8_t _bl;			// I2C chip IO pin mask for Backlight
 uint8_t _blLevel;		// backlight active control level HIGH/LOW
 uint8_t _blCurState;	// Current IO pin state mask for Backlight
 
+#if defined(hd44780_I2Cexp_STATS)
+// i2c write transactions and bytes (address included) sent by iowrite()
+uint16_t _i2cTransactions;
+uint16_t _i2cBytes;
+#endif
+
 // ==================================================
 // === hd44780 i/o subclass virtual i/o functions ===
 // ==================================================
@@ -475,9 +499,12 @@ int rval = hd44780::RV_EIO;
 	 * At 400Khz (max rate supported by the i/o expanders) 16 bits plus start
 	 * and stop bits is 45us.
 	 * So there is at least 45us of time overhead in the physical interface.
+	 * The busy flag can be read while an instruction is executing,
+	 * so status reads do not wait.
 	 */
 
-	waitReady(-45);
+	if(type == hd44780::HD44780_IOdata)
+		waitReady(-45);
    
 	// put all the expander LCD data pins into input mode.
 	// PCF8574 psuedo inputs use pullups so setting them to 1
@@ -620,12 +647,68 @@ int iowrite(hd44780::iotype type, uint8_t value)
 	{
 		write4bits( (value & 0x0F), type); // lower nibble, if not 4bit cmd
 	}
+#if defined(hd44780_I2Cexp_STATS)
+	_i2cTransactions++;
+	_i2cBytes += (_expType == I2Cexp_MCP23008) ? 6 : 5;
+#endif
 	if(Wire.endTransmission(1))
 		return(hd44780::RV_EIO);
 
 	return(hd44780::RV_ENOERR);
 }
 
+// iowrite(type, values, count) - send a block of command or data bytes to lcd
+// Each byte takes 4 i/o expander writes (2 nibbles with an E strobe each)
+// and as many bytes as fit in the Wire buffer are sent in the same i2c
+// transaction, instead of one transaction per byte.
+// No wait is needed between the bytes of a transaction: at 400Khz the
+// 2 i/o expander writes before the next E strobe take 45us, which is more
+// than the instruction execution time of the LCD.
+// returns zero on success, non zero on failure
+int iowrite(hd44780::iotype type, const uint8_t *values, size_t count)
+{
+uint8_t bytes;
+
+	// If no address or expander type is unknown, then drop data
+	if(!_addr || _expType == I2Cexp_UNKNOWN)
+		return(hd44780::RV_ENXIO);
+
+	// "4 bit commands" are only sent one at a time during initalization
+	if(type == hd44780::HD44780_IOcmd4bit)
+		return(hd44780::RV_ENOTSUP);
+
+	waitReady(-45);
+
+	while(count)
+	{
+		// grab i2c bus
+		Wire.beginTransmission(_addr);
+		bytes = 0;
+		if(_expType == I2Cexp_MCP23008)
+		{
+			Wire.write(9); // point to GPIO
+			bytes++;
+		}
+
+		while(count && (bytes + 4) <= hd44780_I2Cexp_BUFFER_LENGTH)
+		{
+			write4bits( (*values >> 4), type );  // send upper nibble
+			write4bits( (*values & 0x0F), type); // send lower nibble
+			values++;
+			count--;
+			bytes += 4;
+		}
+#if defined(hd44780_I2Cexp_STATS)
+		_i2cTransactions++;
+		_i2cBytes += bytes + 1;
+#endif
+		if(Wire.endTransmission(1))
+			return(hd44780::RV_EIO);
+	}
+
+	return(hd44780::RV_ENOERR);
+}
+
 // iosetBacklight()  - set backlight brightness
 // Since dimming is not supported, any non zero value
 // will turn on the backlight.
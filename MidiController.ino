@@ -91,14 +91,11 @@ MIDIPotentiometer<MuxPotentiometer> p3(&muxMIDIPots1, MIDI_POT3_MUX1_CHANNEL, WI
 IMIDIComponent *components[NUM_MIDI_BUTTONS + NUM_MIDI_POTS] = {&b1, &b2, &b3, &b4, &b5, &b6, &b7, &b8, &b9, &p1, &p2, &p3};
 
 // MIDI processing handler
-MidiWorker worker(MIDI);
+MidiWorker worker(MIDI, Serial);
 
 // Creates the MIDI Controller object
 volatile MIDIController controller(&worker, components, NUM_MIDI_BUTTONS + NUM_MIDI_POTS);
 
-// Times a MIDI tick is sent. Used to calculate when next step should be played within a sequence
-volatile uint8_t periods = 0;
-
 void setup(void)
 {
   //Initializes MIDI interface
@@ -106,9 +103,6 @@ void setup(void)
   
   controller.begin();
 
-  // Used for random step playback mode
-  randomSeed(analogRead(0));
-
   // Default time a MIDI tick is sent
   Timer1.initialize((MICROSECONDS_PER_MINUTE / controller.getBpm()) / 24);
   
@@ -124,50 +118,28 @@ void executeRealTimeTasks()
 {
   // update the period in case the Bpm has changed
   Timer1.setPeriod((MICROSECONDS_PER_MINUTE / controller.getBpm()) / 24);
-  periods++;
 
   // start sequence
   if (controller.getResetMIDIClockPeriod())
   {
-    // reset the period of the sequence in order to start in sync with the MIDI clock
-    switch (controller.getStepSize())
-    {
-    case 1:
-      periods = 24;
-      break;
-
-    case 2:
-      periods = 12;
-      break;
-
-    case 4:
-      periods = 6;
-      break;
-
-    case 8:
-      periods = 3;
-      break;
-    }
-
+    // restart the timer in order to start the sequence in sync with the MIDI clock
     controller.setResetMIDIClockPeriod(0);
     Timer1.restart();
   }
 
-  // play next step of the sequence regarding the step size
-  if ((controller.getStepSize() == 1 && periods == 24) ||
-      (controller.getStepSize() == 2 && periods == 12) ||
-      (controller.getStepSize() == 4 && periods == 6) ||
-      (controller.getStepSize() == 8 && periods == 3))
-  {
-    periods = 0;
-    controller.playBackSequence();
-  }
+  // play the steps of the sequencer tracks and send the note offs due on this tick
+  controller.playBackSequence();
+
+  // play the next note of the arpeggio of the held notes
+  controller.playArpeggio();
 
   controller.sendMIDIClock();  
 }
 
 void loop(void)
 {
+  // Prepare the next step of the sequence before the timer1 interrupt plays it
+  controller.renderNextStep();
 
   // Process the select value potentiometer
   controller.processSelectValuePot();
@@ -186,4 +158,7 @@ void loop(void)
 
   // Process change operation mode button
   controller.processOperationModeButton();
+
+  // Draw the values changed on the screen, at most 30 times per second
+  controller.refreshScreen();
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+/*
+ * HostTest.h
+ *
+ * Checks shared by the host tests. A failed check prints its file, line and expression and the test goes on,
+ * so a run reports every failure. hostTestResult() prints the summary and returns the exit code of the test
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HostTest_h
+#define HostTest_h
+
+#include <stdio.h>
+#include <string.h>
+
+static unsigned int hostChecks = 0;   // checks run
+static unsigned int hostFailures = 0; // checks failed
+
+#define CHECK(condition) hostCheck((condition) != 0, __FILE__, __LINE__, #condition)
+#define CHECK_EQUAL(expected, actual) hostCheckEqual((long)(expected), (long)(actual), __FILE__, __LINE__, #actual)
+#define CHECK_STRING(expected, actual) hostCheckString((expected), (actual), __FILE__, __LINE__, #actual)
+
+static inline void hostCheck(bool passed, const char *file, int line, const char *expression)
+{
+    hostChecks++;
+
+    if (!passed)
+    {
+        hostFailures++;
+        printf("%s:%d: check failed: %s\n", file, line, expression);
+    }
+}
+
+static inline void hostCheckEqual(long expected, long actual, const char *file, int line, const char *expression)
+{
+    hostChecks++;
+
+    if (expected != actual)
+    {
+        hostFailures++;
+        printf("%s:%d: %s is %ld, expected %ld\n", file, line, expression, actual, expected);
+    }
+}
+
+static inline void hostCheckString(const char *expected, const char *actual, const char *file, int line, const char *expression)
+{
+    hostChecks++;
+
+    if (strcmp(expected, actual) != 0)
+    {
+        hostFailures++;
+        printf("%s:%d: %s is \"%s\", expected \"%s\"\n", file, line, expression, actual, expected);
+    }
+}
+
+/*
+* Print the summary of the checks
+* Return: 0 if every check passed, 1 otherwise
+* test: name of the test
+*/
+static inline int hostTestResult(const char *test)
+{
+    printf("%s: %u checks, %u failed\n", test, hostChecks, hostFailures);
+
+    return hostFailures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,442 @@
+/*
+ * controller_states_test.cpp
+ *
+ * Host test of the transition tables of the MIDI controller: every event is processed on every state and substate,
+ * under the contexts that open and close the guards of the transitions, and the state and substate the controller
+ * moves to are checked against the switches of the input handlers the tables replaced. A note that transposes the
+ * sequencer sends neither its note on nor its note off
+ *
+ * Copyright 2018 3K MEDIALAB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include "HostTest.h"
+
+// the test drives the controller through its private event processing and sets its status directly
+#define private public
+#define protected public
+#include <MIDIController.cpp>
+#include <MIDIButton.cpp>
+#undef private
+#undef protected
+
+typedef MIDIController C;
+
+// contexts of the guards. Each flag opens or closes the guards of some transitions
+#define CONTEXT_FLAGS 1  // the configuration screens were just entered, the sequencer was transposed and a shortcut was used
+#define CONTEXT_EDIT 2   // the edit mode button is held and the last track is selected
+#define CONTEXT_CLOCK 4  // the MIDI clock is on
+#define CONTEXTS 8
+
+// message types of the MIDI message displayed on the edit page screen
+const uint8_t messageTypes[] = {midi::NoteOn, midi::ControlChange, MIDIMessage::NRPN, MIDIMessage::RPN, midi::ProgramChange};
+
+// state each substate belongs to, in the same order as the substates
+const uint8_t subStateOwners[C::SUBSTATES] = {C::CONTROLLER, C::CONTROLLER, C::EDIT_GLOBAL_CONFIG, C::EDIT_GLOBAL_CONFIG, C::EDIT_GLOBAL_CONFIG,
+                                              C::EDIT_PAGE, C::EDIT_PAGE, C::EDIT_PAGE, C::EDIT_PAGE, C::EDIT_PAGE, C::EDIT_PAGE, C::EDIT_PAGE,
+                                              C::SEQUENCER, C::SEQUENCER, C::SEQUENCER_EDIT_STEP, C::SEQUENCER_EDIT_STEP, C::SEQUENCER_EDIT_STEP,
+                                              C::SEQUENCER_EDIT_STEP, C::SEQUENCER_EDIT_STEP, C::SEQUENCER_EDIT_STEP, C::SEQUENCER_EDIT_STEP,
+                                              C::SEQUENCER_EDIT_CONFIG, C::SEQUENCER_EDIT_CONFIG, C::SEQUENCER_EDIT_CONFIG, C::SEQUENCER_EDIT_CONFIG,
+                                              C::SEQUENCER_EDIT_CONFIG, C::SEQUENCER_EDIT_CONFIG, C::SEQUENCER_EDIT_CONFIG,
+                                              C::ARPEGGIATOR, C::ARPEGGIATOR, C::ARPEGGIATOR};
+
+static MIDIButton<Button> button(MIDI_BUTTON1_PIN, PULLUP, INVERT, DEBOUNCE_MS);
+static IMIDIComponent *components[] = {&button};
+static MidiInterface midiInterface(Serial);
+static MidiWorker worker(midiInterface, Serial);
+static MIDIController controller(&worker, components, 1);
+
+struct Status
+{
+    uint8_t state;
+    uint8_t subState;
+};
+
+/*
+* Returns 1 if the edit page screen can be on a substate while it displays a message type
+* subState: substate of the edit page
+* type: type of the displayed message
+*/
+uint8_t isSubStateOfType(uint8_t subState, uint8_t type)
+{
+    switch (subState)
+    {
+    case C::EDIT_NOTE:
+    case C::EDIT_VELOCITY:
+        return type == midi::NoteOn;
+
+    case C::EDIT_CC:
+        return type == midi::ControlChange;
+
+    case C::EDIT_PARAM_MSB:
+    case C::EDIT_PARAM_LSB:
+        return type == MIDIMessage::NRPN || type == MIDIMessage::RPN;
+
+    default:
+        return 1;
+    }
+}
+
+/*
+* Put the controller on a state and substate under a context. The MIDI clock and the sequencer playback follow
+* the substate of the default screens
+* state: the state
+* subState: the substate
+* context: the context flags
+* type: type of the message displayed on the edit page screen
+*/
+void setStatus(uint8_t state, uint8_t subState, uint8_t context, uint8_t type)
+{
+    controller._sequencer.stopPlayBack();
+    controller._sequencer.setSelectedTrack((context & CONTEXT_EDIT) ? Sequencer::TRACKS - 1 : 0);
+    controller._sequencer.printEditStepData();
+
+    controller._isMIDIClockOn = (state == C::CONTROLLER) ? (subState == C::MIDI_CLOCK_ON) : ((context & CONTEXT_CLOCK) != 0);
+    controller._currentPage = 2;
+
+    uint8_t flags = (context & CONTEXT_FLAGS) ? 1 : 0;
+
+    controller._accesToGloabalEdit = flags;
+    controller._accesToSequencerEdit = flags;
+    controller._wasTransposeEdited = flags;
+    controller._wasShortcutPressed = flags;
+    controller._editButton._state = (context & CONTEXT_EDIT) ? 1 : 0;
+
+    button.getMessages()[0] = MIDIMessage(type, 60, 100);
+    controller._screenManager.setMIDIComponentToDisplay(&button);
+    controller._screenManager._currentMIDIMessageDisplayed = 1;
+
+    if (subState == C::PLAYBACK_ON)
+    {
+        controller._sequencer.startPlayBack();
+    }
+
+    controller._state = state;
+    controller._subState = subState;
+}
+
+/*
+* Returns the status the controller moved to on an event before the transition tables. It follows the switches
+* of the input handlers of that version, without their other effects
+* event: the event
+*/
+Status getExpectedStatus(uint8_t event)
+{
+    Status status = {controller._state, controller._subState};
+    uint8_t clockOn = controller._isMIDIClockOn;
+    uint8_t playBackOn = controller._sequencer.isPlayBackOn();
+    uint8_t messageIndex = controller._screenManager.getDisplayedMessageIndex();
+    uint8_t type = controller._screenManager.getDisplayedMessageType();
+
+    switch (event)
+    {
+    // processMultiplePurposeButton()
+    case C::MULTIPLE_PURPOSE_PRESSED_EVENT:
+
+        switch (status.state)
+        {
+        case C::CONTROLLER:
+            if (!playBackOn)
+            {
+                status.subState = (status.subState == C::MIDI_CLOCK_OFF) ? C::MIDI_CLOCK_ON : C::MIDI_CLOCK_OFF;
+            }
+            break;
+
+        // moveCursorToValue()
+        case C::EDIT_PAGE:
+            switch (type)
+            {
+            case midi::ControlChange:
+                if (status.subState == C::EDIT_MIDI_TYPE)
+                    status.subState = C::EDIT_CC;
+                else if (status.subState == C::EDIT_CC)
+                    status.subState = C::EDIT_MIDI_TYPE;
+                break;
+
+            case MIDIMessage::NRPN:
+            case MIDIMessage::RPN:
+                if (status.subState == C::EDIT_MIDI_TYPE)
+                    status.subState = C::EDIT_PARAM_MSB;
+                else if (status.subState == C::EDIT_PARAM_MSB)
+                    status.subState = C::EDIT_PARAM_LSB;
+                else if (status.subState == C::EDIT_PARAM_LSB)
+                    status.subState = C::EDIT_MIDI_TYPE;
+                break;
+
+            case midi::NoteOn:
+            case midi::NoteOff:
+                if (status.subState == C::EDIT_MIDI_TYPE)
+                    status.subState = C::EDIT_NOTE;
+                else if (status.subState == C::EDIT_NOTE)
+                    status.subState = C::EDIT_VELOCITY;
+                else if (status.subState == C::EDIT_VELOCITY)
+                    status.subState = C::EDIT_MIDI_TYPE;
+                break;
+            }
+            break;
+
+        // moveCursorToGLobalConfigParameter(), moveCursorToStepValue(), moveCursorToSequencerConfigParameter() and
+        // moveCursorToArpeggiatorParameter() walk the parameters of their screen in a loop
+        case C::EDIT_GLOBAL_CONFIG:
+            status.subState = (status.subState == C::EDIT_GLOBAL_MIDI_CH) ? C::EDIT_GLOBAL_MODE : status.subState + 1;
+            break;
+
+        case C::SEQUENCER_EDIT_STEP:
+            status.subState = (status.subState == C::SEQUENCER_EDIT_STEP_RATCHETS) ? C::SEQUENCER_EDIT_STEP_NOTE : status.subState + 1;
+            break;
+
+        case C::SEQUENCER_EDIT_CONFIG:
+            status.subState = (status.subState == C::SEQUENCER_EDIT_EUCLIDEAN_ROTATION) ? C::SEQUENCER_EDIT_PLAYBACK_MODE : status.subState + 1;
+            break;
+
+        case C::ARPEGGIATOR:
+            status.subState = (status.subState == C::ARPEGGIATOR_EDIT_RATE) ? C::ARPEGGIATOR_EDIT_MODE : status.subState + 1;
+            break;
+        }
+
+        break;
+
+    // updateSequencerPlayBackStatus() on the release of the button
+    case C::MULTIPLE_PURPOSE_RELEASED_EVENT:
+
+        if (status.state == C::SEQUENCER && !controller._wasShortcutPressed &&
+            (!clockOn || (controller._globalConfig.getSendClockWhilePlayback() && playBackOn)))
+        {
+            status.subState = (status.subState == C::PLAYBACK_OFF) ? C::PLAYBACK_ON : C::PLAYBACK_OFF;
+        }
+
+        break;
+
+    // processIncDecButtons()
+    case C::DEC_PAGE_PRESSED_EVENT:
+    case C::INC_PAGE_PRESSED_EVENT:
+
+        if (status.state == C::EDIT_PAGE && status.subState != C::DEFAULT_EDIT_MSG &&
+            (event == C::DEC_PAGE_PRESSED_EVENT ? messageIndex > 1 : messageIndex < button.getNumMessages()))
+        {
+            status.subState = C::EDIT_MIDI_TYPE;
+        }
+
+        if (status.state == C::SEQUENCER_EDIT_STEP)
+        {
+            status.subState = C::SEQUENCER_EDIT_STEP_NOTE;
+        }
+
+        break;
+
+    // processEditModeButton() on a release that does not follow a save
+    case C::EDIT_RELEASED_EVENT:
+
+        switch (status.state)
+        {
+        case C::CONTROLLER:
+            status = {C::EDIT_PAGE, C::DEFAULT_EDIT_MSG};
+            break;
+
+        case C::EDIT_GLOBAL_CONFIG:
+            if (controller._accesToGloabalEdit)
+                break;
+            // fall through
+        case C::EDIT_PAGE:
+            status = {C::CONTROLLER, (uint8_t)(clockOn ? C::MIDI_CLOCK_ON : C::MIDI_CLOCK_OFF)};
+            break;
+
+        case C::SEQUENCER:
+            status = {C::SEQUENCER_EDIT_STEP, C::SEQUENCER_EDIT_STEP_NOTE};
+            break;
+
+        case C::SEQUENCER_EDIT_CONFIG:
+            if (controller._accesToSequencerEdit)
+                break;
+            // fall through
+        case C::SEQUENCER_EDIT_STEP:
+            status = {C::SEQUENCER, (uint8_t)(playBackOn ? C::PLAYBACK_ON : C::PLAYBACK_OFF)};
+            break;
+        }
+
+        break;
+
+    // processEditModeButton() on a long press. A save stops the MIDI clock and the playback
+    case C::EDIT_HELD_EVENT:
+
+        switch (status.state)
+        {
+        case C::CONTROLLER:
+            status = {C::EDIT_GLOBAL_CONFIG, C::EDIT_GLOBAL_MODE};
+            break;
+
+        case C::SEQUENCER:
+            if (!controller._wasTransposeEdited)
+                status = {C::SEQUENCER_EDIT_CONFIG, C::SEQUENCER_EDIT_PLAYBACK_MODE};
+            break;
+
+        case C::EDIT_GLOBAL_CONFIG:
+            if (controller._accesToGloabalEdit)
+                break;
+            // fall through
+        case C::EDIT_PAGE:
+            status = {C::CONTROLLER, C::MIDI_CLOCK_OFF};
+            break;
+
+        case C::SEQUENCER_EDIT_CONFIG:
+            if (controller._accesToSequencerEdit)
+                break;
+            // fall through
+        case C::SEQUENCER_EDIT_STEP:
+            status = {C::SEQUENCER, C::PLAYBACK_OFF};
+            break;
+        }
+
+        break;
+
+    // processOperationModeButton()
+    case C::OPERATION_MODE_PRESSED_EVENT:
+
+        switch (status.state)
+        {
+        case C::CONTROLLER:
+            status = {C::SEQUENCER, (uint8_t)(playBackOn ? C::PLAYBACK_ON : C::PLAYBACK_OFF)};
+            break;
+
+        case C::SEQUENCER:
+            if (controller._sequencer.getSelectedTrack() == Sequencer::TRACKS - 1)
+                status = {C::ARPEGGIATOR, C::ARPEGGIATOR_EDIT_MODE};
+            break;
+
+        case C::ARPEGGIATOR:
+            status = {C::CONTROLLER, (uint8_t)(clockOn ? C::MIDI_CLOCK_ON : C::MIDI_CLOCK_OFF)};
+            break;
+        }
+
+        break;
+
+    // the select value potentiometer, the long press of the multiple purpose button and the release that
+    // acknowledges a save never moved the controller
+    default:
+        break;
+    }
+
+    return status;
+}
+
+/*
+* Process every event on every substate of every state, under every context
+*/
+void testTransitions()
+{
+    uint16_t transitions = 0;
+
+    for (uint8_t context = 0; context < CONTEXTS; context++)
+    {
+        for (uint8_t subState = 0; subState < C::SUBSTATES; subState++)
+        {
+            for (uint8_t i = 0; i < sizeof(messageTypes); i++)
+            {
+                uint8_t state = subStateOwners[subState];
+
+                // only the edit page screen depends on the message type displayed
+                if ((state != C::EDIT_PAGE && i > 0) || !isSubStateOfType(subState, messageTypes[i]))
+                {
+                    continue;
+                }
+
+                for (uint8_t event = 0; event < C::EVENTS; event++)
+                {
+                    setStatus(state, subState, context, messageTypes[i]);
+
+                    Status expected = getExpectedStatus(event);
+                    controller.processEvent(event);
+
+                    if (controller._state != expected.state || controller._subState != expected.subState)
+                    {
+                        printf("context %u, state %u, substate %u, type 0x%02X, event %u: status %u/%u, expected %u/%u\n", context, state, subState,
+                               messageTypes[i], event, controller._state, controller._subState, expected.state, expected.subState);
+                    }
+
+                    CHECK_EQUAL(expected.state, controller._state);
+                    CHECK_EQUAL(expected.subState, controller._subState);
+                    transitions++;
+                }
+            }
+        }
+    }
+
+    printf("controller_states_test: %u transitions checked\n", transitions);
+}
+
+/*
+* The entry substates of the table are the ones the handlers set when they entered each state
+*/
+void testEntrySubStates()
+{
+    const uint8_t expected[C::STATES] = {C::MIDI_CLOCK_OFF, C::PLAYBACK_OFF, C::DEFAULT_EDIT_MSG, C::EDIT_GLOBAL_MODE,
+                                         C::SEQUENCER_EDIT_STEP_NOTE, C::SEQUENCER_EDIT_PLAYBACK_MODE, C::ARPEGGIATOR_EDIT_MODE};
+
+    for (uint8_t state = 0; state < C::STATES; state++)
+    {
+        setStatus(C::CONTROLLER, C::MIDI_CLOCK_OFF, 0, midi::NoteOn);
+        controller.enterState(state);
+
+        CHECK_EQUAL(state, controller._state);
+        CHECK_EQUAL(expected[state], controller._subState);
+    }
+}
+
+/*
+* Press or release the MIDI button and process it as the main loop does
+* pressed: TRUE for pressing the button, FALSE for releasing it
+* Return: number of bytes sent to the MIDI output
+*/
+uint32_t pushButton(uint8_t pressed)
+{
+    hostSetDigitalPin(MIDI_BUTTON1_PIN, pressed ? LOW : HIGH);
+    hostAdvanceMicros((DEBOUNCE_MS + 1) * 1000UL);
+    Serial.clearOutput();
+
+    controller.processMidiComponent(&button, 0);
+
+    return Serial.getBytesWritten();
+}
+
+/*
+* A note that transposes the sequencer while the edit mode button is held sends neither its note on nor its note off,
+* even if the edit mode button is released first. The following notes are sent again
+*/
+void testTransposeNoteOff()
+{
+    setStatus(C::SEQUENCER, C::PLAYBACK_OFF, CONTEXT_EDIT, midi::NoteOn);
+
+    CHECK_EQUAL(0, pushButton(1));
+    CHECK_EQUAL(60 - TRANSPOSE_REFERENCE_NOTE, controller._sequencer.getTranspose());
+
+    controller._editButton._state = 0;
+
+    CHECK_EQUAL(0, pushButton(0));
+    CHECK(pushButton(1) > 0);
+    CHECK(pushButton(0) > 0);
+
+    controller._sequencer.setTranspose(0);
+}
+
+int main()
+{
+    worker.begin();
+    controller.begin();
+
+    testEntrySubStates();
+    testTransitions();
+    testTransposeNoteOff();
+
+    return hostTestResult("controller_states_test");
+}
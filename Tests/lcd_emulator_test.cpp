@@ -0,0 +1,154 @@
+/*
+ * lcd_emulator_test.cpp
+ *
+ * Host test of the hd44780_I2Cemu i/o class: the text and the custom characters drawn through the hd44780 API
+ * are read back from the emulated LCD, and the I2C accounting and the busy violations are checked against the
+ * traffic of the PCF8574 backpack
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <hd44780.h>
+#include <hd44780ioClass/hd44780_I2Cemu.h>
+#include "HostTest.h"
+
+#define COLUMNS 16
+#define ROWS 2
+
+// bus time (ns) of a transaction with a number of port writes at 400 kHz: start, address byte, port bytes and stop
+#define TRANSACTION_NS(portWrites) ((1 + (9 * (1 + (portWrites))) + 1) * 2500UL)
+
+const uint8_t glyph[8] = {0x1F, 0x11, 0x11, 0x11, 0x11, 0x11, 0x1F, 0x00};
+
+// The hd44780 class expects the zero initialization of a global object, as the LCD is on the controller,
+// so every test uses its own static LCD
+
+/*
+* The text printed on each row is shown on the emulated display
+*/
+void testPrint()
+{
+    static hd44780_I2Cemu lcd;
+    char line[COLUMNS + 1];
+
+    CHECK_EQUAL(0, lcd.begin(COLUMNS, ROWS));
+    CHECK(lcd.isDisplayOn());
+    CHECK(lcd.isBacklightOn());
+    CHECK_STRING("                ", lcd.getLine(0, line));
+
+    lcd.print("Seq:1/10 120 BPM");
+    lcd.setCursor(0, 1);
+    lcd.print("Step:1/16");
+
+    CHECK_STRING("Seq:1/10 120 BPM", lcd.getLine(0, line));
+    CHECK_STRING("Step:1/16       ", lcd.getLine(1, line));
+    CHECK_STRING("", lcd.getLine(ROWS, line));
+
+    // a field overwrites the characters below it only
+    lcd.setCursor(9, 0);
+    lcd.print("90 ");
+
+    CHECK_STRING("Seq:1/10 90  BPM", lcd.getLine(0, line));
+
+    lcd.clear();
+
+    CHECK_STRING("                ", lcd.getLine(0, line));
+    CHECK_EQUAL(0, lcd.getAddressCounter());
+    CHECK_EQUAL(0, lcd.getBusyViolations());
+}
+
+/*
+* A custom character is stored into CGRAM and drawn with its character code
+*/
+void testCreateChar()
+{
+    static hd44780_I2Cemu lcd;
+    char line[COLUMNS + 1];
+
+    lcd.begin(COLUMNS, ROWS);
+    lcd.createChar(3, glyph);
+    lcd.setCursor(2, 1);
+    lcd.write(3);
+
+    CHECK_EQUAL(0, memcmp(glyph, lcd.getCGRAM(3), sizeof(glyph)));
+    CHECK_EQUAL(3, lcd.getLine(1, line)[2]);
+    CHECK_EQUAL(0, lcd.getBusyViolations());
+}
+
+/*
+* Each character written alone takes a transaction with two port writes per nibble, while a block write
+* takes as many characters as fit in the Wire buffer in each transaction
+*/
+void testBusAccounting()
+{
+    static hd44780_I2Cemu lcd;
+    char line[COLUMNS + 1];
+
+    lcd.begin(COLUMNS, ROWS);
+
+    lcd.setCursor(0, 0);
+    lcd.resetStats();
+    lcd.write('A');
+
+    CHECK_EQUAL(1, lcd.getTransactions());
+    CHECK_EQUAL(1 + 4, lcd.getBusBytes());
+    CHECK_EQUAL(TRANSACTION_NS(4), lcd.getBusTimeNs());
+
+    // 16 characters of 4 port writes take two transactions of 8 characters each
+    lcd.setCursor(0, 1);
+    lcd.resetStats();
+    lcd.write((const uint8_t *)"0123456789ABCDEF", COLUMNS);
+
+    CHECK_STRING("0123456789ABCDEF", lcd.getLine(1, line));
+    CHECK_EQUAL(2, lcd.getTransactions());
+    CHECK_EQUAL(2 + (COLUMNS * 4), lcd.getBusBytes());
+    CHECK_EQUAL(2 * TRANSACTION_NS(32), lcd.getBusTimeNs());
+    CHECK_EQUAL(0, lcd.getBusyViolations());
+}
+
+/*
+* The host only waits for the execution time of the long commands, so the bus clock must be slow enough
+* for the LCD to execute an instruction or a data write before the next strobe
+*/
+void testBusyViolations()
+{
+    static hd44780_I2Cemu lcd;
+    static hd44780_I2Cemu fastLcd(1000000);
+
+    // at 400 kHz every strobe reaches the LCD after it executed the previous write
+    lcd.begin(COLUMNS, ROWS);
+    lcd.clear();
+    lcd.write((const uint8_t *)"0123456789ABCDEF", COLUMNS);
+
+    CHECK_EQUAL(0, lcd.getBusyViolations());
+    CHECK(lcd.getWaitTimeNs() > 0);
+
+    // at 1 MHz the characters of a burst reach the LCD while it is still writing the previous one
+    fastLcd.begin(COLUMNS, ROWS);
+    fastLcd.resetStats();
+    fastLcd.write((const uint8_t *)"0123456789ABCDEF", COLUMNS);
+
+    CHECK(fastLcd.getBusyViolations() > 0);
+}
+
+int main()
+{
+    testPrint();
+    testCreateChar();
+    testBusAccounting();
+    testBusyViolations();
+
+    return hostTestResult("lcd_emulator_test");
+}
@@ -0,0 +1,197 @@
+/*
+ * midi_worker_test.cpp
+ *
+ * Host test of the running status of the MidiWorker output: the status byte is shared by consecutive messages,
+ * survives the real time messages and is sent again after a System Exclusive message or the refresh period.
+ * A message waits for room in the serial buffer before being written, unless it is sent from the interrupt.
+ * The throughput of a pot sweep at 31250 baud is measured with and without running status
+ *
+ * Copyright 2018 3K MEDIALAB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <MidiWorker.h>
+#include "HostTest.h"
+
+// time (us) taken by a byte on the MIDI wire: a start bit, 8 data bits and a stop bit at 31250 baud
+#define MIDI_BYTE_US 320
+
+static MidiInterface midiInterface(Serial);
+static MidiWorker worker(midiInterface, Serial);
+
+/*
+* Send a Control Change message through the worker
+* control: control number
+* value: control value
+*/
+void sendControlChange(uint8_t control, uint8_t value)
+{
+    MIDIMessage message(midi::ControlChange, control, value);
+
+    worker.sendMIDIMessage(&message, 1);
+}
+
+/*
+* Check the bytes written to the MIDI output since it was cleared
+* expected: the expected bytes
+* length: number of expected bytes
+*/
+void checkOutput(const uint8_t *expected, uint8_t length)
+{
+    CHECK_EQUAL(length, Serial.getBytesWritten());
+
+    for (uint8_t i = 0; i < length; i++)
+    {
+        CHECK_EQUAL(expected[i], Serial.getOutput()[i]);
+    }
+}
+
+/*
+* Consecutive messages of the same type and channel share the status byte, and the real time messages sent
+* between them do not break the running status
+*/
+void testRunningStatus()
+{
+    const uint8_t expected[] = {0xB0, 7, 10, 7, 11, 0xF8, 7, 12, 0x90, 60, 100};
+
+    worker.setRunningStatus(1);
+    Serial.clearOutput();
+
+    sendControlChange(7, 10);
+    sendControlChange(7, 11);
+    worker.sendMIDIClock();
+    sendControlChange(7, 12);
+
+    MIDIMessage noteOn(midi::NoteOn, 60, 100);
+    worker.sendMIDIMessage(&noteOn, 1);
+
+    checkOutput(expected, sizeof(expected));
+}
+
+/*
+* A System Exclusive message and the refresh period make the next message send its status byte again
+*/
+void testStatusRefresh()
+{
+    const uint8_t data[] = {0x7D, 0x01};
+    const uint8_t expected[] = {0xB0, 7, 10, 0xF0, 0x7D, 0x01, 0xF7, 0xB0, 7, 11, 7, 12, 0xB0, 7, 13};
+
+    worker.setRunningStatus(1);
+    Serial.clearOutput();
+
+    sendControlChange(7, 10);
+    worker.sendSysEx(sizeof(data), data);
+    sendControlChange(7, 11);
+
+    hostAdvanceMicros((RUNNING_STATUS_REFRESH_MS - 1) * 1000UL);
+    sendControlChange(7, 12);
+
+    hostAdvanceMicros(1000UL);
+    sendControlChange(7, 13);
+
+    checkOutput(expected, sizeof(expected));
+}
+
+/*
+* Without running status every message sends its status byte
+*/
+void testRunningStatusDisabled()
+{
+    const uint8_t expected[] = {0xB0, 7, 10, 0xB0, 7, 11};
+
+    worker.setRunningStatus(0);
+    Serial.clearOutput();
+
+    sendControlChange(7, 10);
+    sendControlChange(7, 11);
+
+    checkOutput(expected, sizeof(expected));
+}
+
+/*
+* With the serial buffer full the main loop waits until the whole message fits before writing it, while
+* the Timer1 interrupt writes it at once without reading the buffer room
+*/
+void testFullBuffer()
+{
+    const uint8_t expected[] = {0xB0, 7, 10, 0xB0, 7, 11};
+
+    worker.setRunningStatus(0);
+    Serial.clearOutput();
+
+    Serial.setRoom(0);
+    sendControlChange(7, 10);
+    CHECK(Serial.availableForWrite() > 3);
+
+    Serial.setRoom(0);
+    noInterrupts();
+    sendControlChange(7, 11);
+    interrupts();
+    CHECK_EQUAL(0, Serial.availableForWrite());
+
+    checkOutput(expected, sizeof(expected));
+    Serial.setRoom(63);
+}
+
+/*
+* Number of Control Change messages of a pot sweep that fit in one second of the MIDI wire. The clock moves
+* with the bytes written, so the status refresh is accounted for
+* runningStatus: TRUE for enabling running status on the worker
+*/
+uint16_t getControlChangesPerSecond(uint8_t runningStatus)
+{
+    uint16_t messages = 0;
+    uint32_t wireTime = 0;
+
+    worker.setRunningStatus(runningStatus);
+
+    while (wireTime < 1000000UL)
+    {
+        Serial.clearOutput();
+        sendControlChange(7, messages & 0x7F);
+
+        wireTime += Serial.getBytesWritten() * MIDI_BYTE_US;
+        hostAdvanceMicros(Serial.getBytesWritten() * MIDI_BYTE_US);
+        messages++;
+    }
+
+    return messages;
+}
+
+/*
+* A pot sweep sends 2 bytes per message with running status instead of 3, plus a status byte per refresh period
+*/
+void testThroughput()
+{
+    uint16_t plain = getControlChangesPerSecond(0);
+    uint16_t running = getControlChangesPerSecond(1);
+
+    CHECK_EQUAL(1000000UL / (3 * MIDI_BYTE_US) + 1, plain);
+    CHECK(running * 2 >= plain * 3 - 10);
+
+    printf("midi_worker_test: %u CC/s without running status, %u CC/s with running status\n", plain, running);
+}
+
+int main()
+{
+    worker.begin();
+
+    testRunningStatus();
+    testStatusRefresh();
+    testRunningStatusDisabled();
+    testFullBuffer();
+    testThroughput();
+
+    return hostTestResult("midi_worker_test");
+}
@@ -0,0 +1,166 @@
+/*
+ * screen_lines_test.cpp
+ *
+ * Host test of the lines built by the screen manager. The note names and octaves written with appendNote() and the
+ * deferred refresh of the edited fields are read back from the emulated LCD, and the I2C cost of each line is
+ * checked: a line takes a cursor move and one burst transaction per 8 characters
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <ScreenManager.h>
+#include <MIDIButton.h>
+#include <MIDIButton.cpp>
+#include <Button.h>
+#include "HostTest.h"
+
+// The hd44780 class expects the zero initialization of a global object, as the screen manager of the controller is
+static ScreenManager screen;
+static hd44780_I2Cemu *lcd;
+
+// column where the note of the step edit screen starts
+#define STEP_NOTE_COLUMN 11
+
+/*
+* Returns a row of the emulated LCD
+* row: the row
+*/
+const char *getRow(uint8_t row)
+{
+    static char line[COLUMNS + 1];
+
+    return lcd->getLine(row, line);
+}
+
+/*
+* Draw the deferred field once the refresh period has passed
+*/
+void refreshScreen()
+{
+    hostAdvanceMicros(SCREEN_REFRESH_MS * 1000UL);
+    screen.refresh();
+    I2CBus.endPass();
+}
+
+/*
+* The step edit screen shows the note name and octave of the step after the step number and the sequence length
+*/
+void testStepNote()
+{
+    screen.printEditStepData(Step(60, 1, 0), 1, 16);
+
+    CHECK_STRING("Step: 1/16 C4   ", getRow(0));
+    CHECK_STRING("Leg:No   Ena:Yes", getRow(1));
+
+    screen.printEditStepData(Step(61, 1, 1), 12, 64);
+
+    CHECK_STRING("Step:12/64 Db4  ", getRow(0));
+    CHECK_STRING("Leg:Yes  Ena:Yes", getRow(1));
+
+    // negative octaves take the place of the longest name, and a shorter name does not leave any old char behind
+    screen.printEditStepData(Step(1, 1, 0), 3, 8);
+
+    CHECK_STRING("Step: 3/8  Db-1 ", getRow(0));
+
+    screen.refreshStepNoteValue(127);
+    refreshScreen();
+
+    CHECK_STRING("Step: 3/8  G9   ", getRow(0));
+    CHECK_EQUAL(STEP_NOTE_COLUMN, lcd->getAddressCounter());
+}
+
+/*
+* Consecutive changes of the edited note are drawn once, with the last value
+*/
+void testDeferredStepNote()
+{
+    screen.printEditStepData(Step(60, 1, 0), 1, 16);
+
+    screen.refreshStepNoteValue(62);
+    screen.refreshStepNoteValue(64);
+
+    CHECK_STRING("Step: 1/16 C4   ", getRow(0));
+
+    refreshScreen();
+
+    CHECK_STRING("Step: 1/16 E4   ", getRow(0));
+}
+
+/*
+* The Note On message of a MIDI button shows its note name, octave and velocity
+*/
+void testMessageNote()
+{
+    static MIDIButton<Button> button(MIDI_BUTTON1_PIN, PULLUP, INVERT, DEBOUNCE_MS);
+
+    button.getMessages()[0] = MIDIMessage(midi::NoteOn, 70, 100);
+
+    screen.setMIDIComponentToDisplay(&button);
+    screen.displayComponentMIDIMessage(1);
+
+    CHECK_STRING("Bb4  V:100      ", getRow(1));
+
+    screen.moveCursorToNote();
+    screen.refreshNoteValue(0);
+    refreshScreen();
+
+    CHECK_STRING("C-1  V:100      ", getRow(1));
+}
+
+/*
+* A full line is drawn with a cursor move and two bursts of 8 characters, and a note field is drawn with the
+* cursor moves and the blink commands around its burst
+*/
+void testLineBusCost()
+{
+    screen.printEditStepData(Step(60, 1, 0), 1, 16);
+    lcd->resetStats();
+
+    screen.printStepParameters(Step(60, 1, 0));
+
+    // no blink, cursor move, 2 bursts and blink. Each command or char takes 4 port writes
+    CHECK_STRING("V:127 P:100 R:1 ", getRow(1));
+    CHECK_EQUAL(1 + 1 + 2 + 1, lcd->getTransactions());
+    CHECK_EQUAL(lcd->getTransactions() + (4 * (3 + COLUMNS)), lcd->getBusBytes());
+    CHECK_EQUAL(0, lcd->getBusyViolations());
+
+    uint32_t lineNs = lcd->getBusTimeNs();
+
+    lcd->resetStats();
+
+    screen.refreshStepNoteValue(61);
+    refreshScreen();
+
+    // no blink, 1 burst of the note field, cursor move and blink
+    CHECK_EQUAL(1 + 1 + 1 + 1, lcd->getTransactions());
+    CHECK_EQUAL(lcd->getTransactions() + (4 * (3 + COLUMNS - STEP_NOTE_COLUMN)), lcd->getBusBytes());
+    CHECK_EQUAL(0, lcd->getBusyViolations());
+
+    printf("screen_lines_test: full line %lu us, note field %lu us of I2C bus time\n",
+           (unsigned long)(lineNs / 1000), (unsigned long)(lcd->getBusTimeNs() / 1000));
+}
+
+int main()
+{
+    screen.initialize();
+    lcd = hd44780_I2Cexp::getLast();
+
+    testStepNote();
+    testDeferredStepNote();
+    testMessageNote();
+    testLineBusCost();
+
+    return hostTestResult("screen_lines_test");
+}
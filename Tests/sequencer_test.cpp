@@ -0,0 +1,477 @@
+/*
+ * sequencer_test.cpp
+ *
+ * Host test of the sequencer playback: the steps rendered ahead by the main loop are sent by the clock dispatch
+ * as they were rendered, and the time the dispatch takes to play a step is measured with and without the render ahead.
+ * A legato step followed by the same note ties both steps into one note. The shuffle mode plays every step once per
+ * cycle and the scale lock moves every note to the nearest one within the scale.
+ * The serial buffer of the Timer1 interrupt is measured across the MIDI clock ticks of the four tracks and the arpeggiator
+ * at MAX_BPM
+ *
+ * Copyright 2018 3K MEDIALAB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <Sequencer.h>
+#include <Arpeggiator.h>
+#include <time.h>
+#include "HostTest.h"
+
+// steps played by each measurement
+#define BENCHMARK_STEPS 100000UL
+
+// time (us) taken by a byte on the MIDI wire: a start bit, 8 data bits and a stop bit at 31250 baud
+#define MIDI_BYTE_US 320
+
+// size of the serial transmit buffer of the ATmega328 core. One byte is kept free, so the interrupt does not wait
+// while the pending bytes are less than it
+#define SERIAL_TX_BUFFER_SIZE 64
+
+static MidiInterface midiInterface(Serial);
+static MidiWorker worker(midiInterface, Serial);
+static MemoryManager memoryManager;
+static ScreenManager screenManager;
+static Sequencer sequencer(Sequencer::FORWARD, Sequencer::SIXTEENTH, &memoryManager, &screenManager);
+static Arpeggiator arpeggiator;
+
+/*
+* Returns the time (ns) of the host computer
+*/
+uint64_t getHostTime()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/*
+* Fill the sequence of the selected track with a chromatic scale
+* firstNote: note of the first step
+*/
+void fillSequence(uint8_t firstNote)
+{
+    for (uint8_t step = 0; step < Sequencer::LENGTH; step++)
+    {
+        sequencer.getSequence()[step] = Step(firstNote + step, 1, 0);
+    }
+}
+
+/*
+* Play the ticks of a step, as the Timer1 interrupt does
+* renderAhead: TRUE for rendering the step from the main loop before its first tick
+* Return: host time (ns) taken by the clock dispatch
+*/
+uint32_t playStep(uint8_t renderAhead)
+{
+    if (renderAhead)
+    {
+        sequencer.renderNextStep();
+    }
+
+    uint64_t start = getHostTime();
+
+    for (uint8_t tick = 0; tick < Sequencer::TICKS_PER_QUARTER / Sequencer::SIXTEENTH; tick++)
+    {
+        sequencer.tick();
+    }
+
+    return getHostTime() - start;
+}
+
+/*
+* The first tick of a step only sends the bytes rendered by the main loop, and the note off of the previous step
+*/
+void testRenderedStep()
+{
+    const uint8_t expected[] = {0x80, 60, 0, 0x90, 61, 127};
+
+    sequencer.startPlayBack();
+    playStep(1);
+
+    sequencer.renderNextStep();
+    Serial.clearOutput();
+    sequencer.tick();
+
+    CHECK_EQUAL(sizeof(expected), Serial.getBytesWritten());
+
+    for (uint8_t i = 0; i < sizeof(expected); i++)
+    {
+        CHECK_EQUAL(expected[i], Serial.getOutput()[i]);
+    }
+
+    sequencer.stopPlayBack();
+}
+
+/*
+* Play the steps of the sequence from its first one
+* renderAhead: TRUE for rendering each step from the main loop before its first tick
+* output: the bytes written to the MIDI output
+* Return: number of bytes written
+*/
+uint32_t playSequence(uint8_t renderAhead, uint8_t *output)
+{
+    Serial.clearOutput();
+    sequencer.startPlayBack();
+
+    for (uint8_t step = 0; step < Sequencer::LENGTH; step++)
+    {
+        playStep(renderAhead);
+    }
+
+    sequencer.stopPlayBack();
+    memcpy(output, Serial.getOutput(), min(Serial.getBytesWritten(), (uint32_t)HardwareSerial::OUTPUT_SIZE));
+
+    return Serial.getBytesWritten();
+}
+
+/*
+* A step the main loop could not render in time is rendered by the clock dispatch, and the output is the same
+*/
+void testLateRender()
+{
+    static uint8_t rendered[HardwareSerial::OUTPUT_SIZE];
+    static uint8_t late[HardwareSerial::OUTPUT_SIZE];
+
+    worker.setRunningStatus(0);
+
+    uint32_t length = playSequence(1, rendered);
+
+    CHECK_EQUAL(Sequencer::LENGTH * 6, length);
+    CHECK_EQUAL(length, playSequence(0, late));
+    CHECK(memcmp(rendered, late, length) == 0);
+
+    worker.setRunningStatus(MIDI_RUNNING_STATUS);
+}
+
+/*
+* A legato step followed by the same note cancels its note off, so the note is played once and released by the second step
+*/
+void testLegato()
+{
+    const uint8_t expected[] = {0x90, 60, 127, 0x80, 60, 0};
+
+    worker.setRunningStatus(0);
+    sequencer.getSequence()[0].setLegato(1);
+    sequencer.getSequence()[1] = Step(60, 1, 0);
+
+    Serial.clearOutput();
+    sequencer.startPlayBack();
+    playStep(1);
+    playStep(1);
+    sequencer.stopPlayBack();
+
+    CHECK_EQUAL(sizeof(expected), Serial.getBytesWritten());
+
+    for (uint8_t i = 0; i < sizeof(expected); i++)
+    {
+        CHECK_EQUAL(expected[i], Serial.getOutput()[i]);
+    }
+
+    fillSequence(60);
+    worker.setRunningStatus(MIDI_RUNNING_STATUS);
+}
+
+/*
+* Returns the notes of the note ons written to the MIDI output since it was cleared. Running status has to be disabled
+* notes: the notes played
+*/
+uint8_t getPlayedNotes(uint8_t *notes)
+{
+    uint8_t numNotes = 0;
+
+    for (uint32_t i = 0; i + 2 < Serial.getBytesWritten(); i += 3)
+    {
+        if ((Serial.getOutput()[i] & 0xF0) == midi::NoteOn)
+        {
+            notes[numNotes++] = Serial.getOutput()[i + 1];
+        }
+    }
+
+    return numNotes;
+}
+
+/*
+* Every cycle of the shuffle mode plays each step of the sequence once
+*/
+void testShuffle()
+{
+    uint8_t notes[Sequencer::LENGTH * 2];
+
+    worker.setRunningStatus(0);
+    sequencer.setPlayBackMode(Sequencer::SHUFFLE);
+    sequencer.startPlayBack();
+
+    for (uint8_t cycle = 0; cycle < 8; cycle++)
+    {
+        uint16_t playedSteps = 0;
+
+        Serial.clearOutput();
+
+        for (uint8_t step = 0; step < Sequencer::LENGTH; step++)
+        {
+            playStep(1);
+        }
+
+        CHECK_EQUAL(Sequencer::LENGTH, getPlayedNotes(notes));
+
+        for (uint8_t i = 0; i < Sequencer::LENGTH; i++)
+        {
+            playedSteps |= 1 << (notes[i] - 60);
+        }
+
+        CHECK_EQUAL(0xFFFF, playedSteps);
+    }
+
+    sequencer.stopPlayBack();
+    sequencer.setPlayBackMode(Sequencer::FORWARD);
+    worker.setRunningStatus(MIDI_RUNNING_STATUS);
+}
+
+/*
+* Returns the nearest note within a scale by searching every MIDI note, the lower one when both are at the same distance
+* note: the note
+* scaleMask: notes of the scale
+*/
+uint8_t getNearestScaleNote(uint8_t note, uint16_t scaleMask)
+{
+    for (uint8_t distance = 0; distance < 12; distance++)
+    {
+        if (note >= distance && bitRead(scaleMask, (note - distance) % 12))
+        {
+            return note - distance;
+        }
+
+        if (note + distance < 128 && bitRead(scaleMask, (note + distance) % 12))
+        {
+            return note + distance;
+        }
+    }
+
+    return note;
+}
+
+/*
+* The scale lock plays every MIDI note as the nearest note within the scale, in every key and mode
+*/
+void testScaleLock()
+{
+    static uint8_t output[HardwareSerial::OUTPUT_SIZE];
+    uint8_t notes[Sequencer::LENGTH * 2];
+    uint16_t errors = 0;
+
+    worker.setRunningStatus(0);
+    sequencer.setScaleLock(1);
+
+    for (uint8_t rootNote = MIDIUtils::C; rootNote <= MIDIUtils::B; rootNote++)
+    {
+        for (uint8_t mode = MIDIUtils::Ionian; mode <= MIDIUtils::Chromatic; mode++)
+        {
+            sequencer.setScale(rootNote, mode);
+
+            for (uint8_t firstNote = 0; firstNote < 128; firstNote += Sequencer::LENGTH)
+            {
+                fillSequence(firstNote);
+                playSequence(1, output);
+
+                if (getPlayedNotes(notes) != Sequencer::LENGTH)
+                {
+                    errors++;
+                    continue;
+                }
+
+                for (uint8_t step = 0; step < Sequencer::LENGTH; step++)
+                {
+                    errors += notes[step] != getNearestScaleNote(firstNote + step, MIDIUtils::getScaleMask(rootNote, mode));
+                }
+            }
+        }
+    }
+
+    CHECK_EQUAL(0, errors);
+
+    sequencer.setScaleLock(0);
+    sequencer.setScale(MIDIUtils::C, MIDIUtils::Chromatic);
+    fillSequence(60);
+    worker.setRunningStatus(MIDI_RUNNING_STATUS);
+}
+
+/*
+* Host time of the clock dispatch of a step in every playback mode, with the step rendered by the main loop and
+* with the step rendered by the dispatch itself as it was before the render ahead
+*/
+void benchmarkStepDispatch()
+{
+    uint64_t time[2] = {0, 0};
+
+    for (uint8_t renderAhead = 0; renderAhead < 2; renderAhead++)
+    {
+        for (uint8_t mode = 0; mode < Sequencer::PLAYBACK_MODE_TYPES; mode++)
+        {
+            sequencer.setPlayBackMode(mode);
+            sequencer.startPlayBack();
+
+            for (uint32_t step = 0; step < BENCHMARK_STEPS; step++)
+            {
+                time[renderAhead] += playStep(renderAhead);
+            }
+
+            sequencer.stopPlayBack();
+        }
+    }
+
+    sequencer.setPlayBackMode(Sequencer::FORWARD);
+
+    printf("sequencer_test: step dispatch %lu ns rendering in the interrupt, %lu ns rendered ahead (host time)\n",
+           (unsigned long)(time[0] / (BENCHMARK_STEPS * Sequencer::PLAYBACK_MODE_TYPES)),
+           (unsigned long)(time[1] / (BENCHMARK_STEPS * Sequencer::PLAYBACK_MODE_TYPES)));
+}
+
+/*
+* Assign a sequence to every track, each one with a different note range, and set the ratchets of their steps
+* ratchets: number of times the note of each step is played
+*/
+void fillTracks(uint8_t ratchets)
+{
+    for (uint8_t track = 0; track < Sequencer::TRACKS; track++)
+    {
+        sequencer.setSelectedTrack(track);
+        sequencer.setCurrentSequence(track + 1);
+        fillSequence(36 + (track * Sequencer::LENGTH));
+
+        for (uint8_t step = 0; step < Sequencer::LENGTH; step++)
+        {
+            sequencer.getSequence()[step].setRatchets(ratchets);
+        }
+    }
+
+    sequencer.setSelectedTrack(0);
+}
+
+/*
+* The four tracks are played by the same clock dispatch, each one on its own channel
+*/
+void testFourTracks()
+{
+    const uint8_t expected[] = {0x90, 36, 127, 0x91, 52, 127, 0x92, 68, 127, 0x93, 84, 127};
+
+    fillTracks(1);
+
+    sequencer.startPlayBack();
+    sequencer.renderNextStep();
+    Serial.clearOutput();
+    sequencer.tick();
+
+    CHECK_EQUAL(sizeof(expected), Serial.getBytesWritten());
+
+    for (uint8_t i = 0; i < sizeof(expected); i++)
+    {
+        CHECK_EQUAL(expected[i], Serial.getOutput()[i]);
+    }
+
+    sequencer.stopPlayBack();
+}
+
+/*
+* Worst MIDI clock tick of the four tracks in every playback mode and step size, with and without ratchets, while the
+* arpeggiator plays three held notes on another channel at its fastest rate, as the Timer1 interrupt does.
+* The worst tick takes longer than a clock period at MAX_BPM on the MIDI wire, but the ticks between the steps send
+* the MIDI clock only, so the bytes pending in the serial buffer are followed across the ticks: each clock period
+* sends clockPeriod / MIDI_BYTE_US of them. They have to stay below the buffer size, so the interrupt never waits.
+* The average host time of a tick is printed too
+*/
+void benchmarkFourTracks()
+{
+    uint32_t clockPeriod = (MICROSECONDS_PER_MINUTE / MAX_BPM) / Sequencer::TICKS_PER_QUARTER;
+    uint32_t maxBytes = 0;
+    uint32_t pendingBytes = 0;
+    uint32_t maxPendingBytes = 0;
+    uint64_t time = 0;
+    uint32_t ticks = 0;
+
+    arpeggiator.setMIDIChannel(Sequencer::TRACKS + 1);
+    arpeggiator.setRate(8);
+    arpeggiator.addNote(48);
+    arpeggiator.addNote(52);
+    arpeggiator.addNote(55);
+
+    for (uint8_t ratchets = 1; ratchets <= Step::MAX_RATCHETS; ratchets += Step::MAX_RATCHETS - 1)
+    {
+        fillTracks(ratchets);
+
+        for (uint8_t mode = 0; mode < Sequencer::PLAYBACK_MODE_TYPES; mode++)
+        {
+            for (uint8_t stepSize = Sequencer::QUARTER; stepSize <= Sequencer::THIRTYSECOND; stepSize *= 2)
+            {
+                for (uint8_t track = 0; track < Sequencer::TRACKS; track++)
+                {
+                    sequencer.setSelectedTrack(track);
+                    sequencer.setPlayBackMode(mode);
+                    sequencer.setStepSize(stepSize);
+                }
+
+                sequencer.startPlayBack();
+
+                for (uint16_t tick = 0; tick < 4 * Sequencer::LENGTH * Sequencer::TICKS_PER_QUARTER; tick++)
+                {
+                    sequencer.renderNextStep();
+                    Serial.clearOutput();
+
+                    uint64_t start = getHostTime();
+                    sequencer.tick();
+                    arpeggiator.tick(&worker);
+                    worker.sendMIDIClock();
+                    time += getHostTime() - start;
+                    ticks++;
+
+                    maxBytes = max(maxBytes, Serial.getBytesWritten());
+
+                    // the bytes left from the previous tick after one clock period, plus the ones of this tick
+                    pendingBytes = (pendingBytes > clockPeriod / MIDI_BYTE_US) ? pendingBytes - clockPeriod / MIDI_BYTE_US : 0;
+                    pendingBytes += Serial.getBytesWritten();
+                    maxPendingBytes = max(maxPendingBytes, pendingBytes);
+                }
+
+                sequencer.stopPlayBack();
+            }
+        }
+    }
+
+    arpeggiator.clear();
+
+    CHECK(maxPendingBytes < SERIAL_TX_BUFFER_SIZE);
+
+    printf("sequencer_test: worst 4 track and arpeggiator tick %lu bytes (%lu us, clock period %lu us at %u BPM), "
+           "%lu bytes pending at most, %lu ns per tick (host time)\n", (unsigned long)maxBytes, (unsigned long)(maxBytes * MIDI_BYTE_US),
+           (unsigned long)clockPeriod, MAX_BPM, (unsigned long)maxPendingBytes, (unsigned long)(time / ticks));
+}
+
+int main()
+{
+    worker.begin();
+    sequencer.setMidiWorker(&worker);
+    fillSequence(60);
+
+    testRenderedStep();
+    testLateRender();
+    testLegato();
+    testShuffle();
+    testScaleLock();
+    benchmarkStepDispatch();
+    testFourTracks();
+    benchmarkFourTracks();
+
+    return hostTestResult("sequencer_test");
+}
@@ -0,0 +1,326 @@
+/*
+ * Arduino.cpp
+ *
+ * Host shim of the Arduino core: emulated clock and pins, Print formatting, serial port, EEPROM and the global
+ * objects of the Arduino libraries
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <Wire.h>
+#include <TimerOne.h>
+#include <stdio.h>
+
+HardwareSerial Serial;
+TwoWire Wire;
+EEPROMClass EEPROM;
+TimerOne Timer1;
+
+static unsigned long long hostMicros = 0; // emulated time since power on (us)
+static int digitalPins[32];               // values returned by digitalRead()
+static int analogPins[32];                // values returned by analogRead()
+
+/*
+* ARDUINO CORE
+*/
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+long random(long howBig)
+{
+    return howBig == 0 ? 0 : rand() % howBig;
+}
+
+long random(long howSmall, long howBig)
+{
+    return howSmall >= howBig ? howSmall : howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed)
+{
+    srand(seed);
+}
+
+/*
+* Every read of the clock takes a microsecond, so the busy waits on micros() end
+*/
+unsigned long micros()
+{
+    return (unsigned long)(hostMicros++);
+}
+
+unsigned long millis()
+{
+    return (unsigned long)(hostMicros / 1000);
+}
+
+void delay(unsigned long ms)
+{
+    hostMicros += (unsigned long long)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    hostMicros += us;
+}
+
+void hostAdvanceMicros(unsigned long us)
+{
+    hostMicros += us;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (mode == INPUT_PULLUP)
+    {
+        digitalPins[pin & 0x1F] = HIGH;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    digitalPins[pin & 0x1F] = value;
+}
+
+int digitalRead(uint8_t pin)
+{
+    return digitalPins[pin & 0x1F];
+}
+
+int analogRead(uint8_t pin)
+{
+    return analogPins[pin & 0x1F];
+}
+
+void hostSetDigitalPin(uint8_t pin, int value)
+{
+    digitalPins[pin & 0x1F] = value;
+}
+
+void hostSetAnalogPin(uint8_t pin, int value)
+{
+    analogPins[pin & 0x1F] = value;
+}
+
+uint8_t SREG = _BV(SREG_I);
+
+void interrupts()
+{
+    SREG |= _BV(SREG_I);
+}
+
+void noInterrupts()
+{
+    SREG &= ~_BV(SREG_I);
+}
+
+char *itoa(int value, char *string, int radix)
+{
+    snprintf(string, 12, radix == 16 ? "%x" : "%d", value);
+    return string;
+}
+
+/*
+* PRINT
+*/
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+
+    while (size--)
+    {
+        n += write(*buffer++);
+    }
+
+    return n;
+}
+
+size_t Print::print(const __FlashStringHelper *text)
+{
+    return write((const char *)text);
+}
+
+size_t Print::print(const char *text)
+{
+    return write(text);
+}
+
+size_t Print::print(char c)
+{
+    return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base)
+{
+    return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+    char text[24];
+
+    snprintf(text, sizeof(text), base == 16 ? "%lX" : "%ld", value);
+    return write(text);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char text[24];
+
+    snprintf(text, sizeof(text), base == 16 ? "%lX" : "%lu", value);
+    return write(text);
+}
+
+size_t Print::println()
+{
+    return write("\r\n");
+}
+
+size_t Print::println(const __FlashStringHelper *text)
+{
+    return print(text) + println();
+}
+
+size_t Print::println(const char *text)
+{
+    return print(text) + println();
+}
+
+size_t Print::println(int value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base)
+{
+    return print(value, base) + println();
+}
+
+/*
+* SERIAL PORT
+*/
+
+HardwareSerial::HardwareSerial()
+{
+    clearOutput();
+    _room = 63;
+}
+
+void HardwareSerial::begin(unsigned long baud)
+{
+}
+
+void HardwareSerial::end()
+{
+}
+
+int HardwareSerial::available()
+{
+    return 0;
+}
+
+int HardwareSerial::read()
+{
+    return -1;
+}
+
+int HardwareSerial::availableForWrite()
+{
+    int room = _room;
+
+    _room = min(_room + 1, 63);
+
+    return room;
+}
+
+void HardwareSerial::flush()
+{
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+    if (_bytesWritten < OUTPUT_SIZE)
+    {
+        _output[_bytesWritten] = value;
+    }
+
+    _bytesWritten++;
+
+    return 1;
+}
+
+const uint8_t *HardwareSerial::getOutput()
+{
+    return _output;
+}
+
+uint32_t HardwareSerial::getBytesWritten()
+{
+    return _bytesWritten;
+}
+
+void HardwareSerial::clearOutput()
+{
+    _bytesWritten = 0;
+}
+
+void HardwareSerial::setRoom(int room)
+{
+    _room = room;
+}
+
+/*
+* EEPROM
+*/
+
+EEPROMClass::EEPROMClass()
+{
+    erase();
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+    _data[address % SIZE] = value;
+    _writes++;
+}
+
+void EEPROMClass::update(int address, uint8_t value)
+{
+    if (read(address) != value)
+    {
+        write(address, value);
+    }
+}
+
+void EEPROMClass::erase()
+{
+    memset(_data, 0xFF, sizeof(_data));
+    _writes = 0;
+}
@@ -0,0 +1,49 @@
+/*
+ * EEPROM.h
+ *
+ * Host shim of the Arduino EEPROM library, backed by a RAM array that starts erased (0xFF)
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include <stdint.h>
+
+class EEPROMClass
+{
+  public:
+    enum
+    {
+      SIZE = 1024
+    }; // bytes of the ATmega328 EEPROM
+
+    EEPROMClass();
+    uint8_t read(int address) { return _data[address % SIZE]; }
+    void write(int address, uint8_t value);
+    void update(int address, uint8_t value);
+    uint16_t length() { return SIZE; }
+
+    void erase();
+    uint32_t getWrites() { return _writes; }
+
+  private:
+    uint8_t _data[SIZE]; // EEPROM contents
+    uint32_t _writes;    // bytes written since the EEPROM was erased
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
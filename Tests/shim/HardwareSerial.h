@@ -0,0 +1,56 @@
+/*
+ * HardwareSerial.h
+ *
+ * Host shim of the Arduino serial port. The bytes written are kept, so the tests can check the MIDI output
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HardwareSerial_h
+#define HardwareSerial_h
+
+#include <Print.h>
+
+class HardwareSerial : public Print
+{
+  public:
+    enum
+    {
+      OUTPUT_SIZE = 4096
+    }; // number of written bytes kept
+
+    HardwareSerial();
+    void begin(unsigned long baud);
+    void end();
+    int available();
+    int read();
+    int availableForWrite();
+    void flush();
+    size_t write(uint8_t value);
+    using Print::write;
+
+    const uint8_t *getOutput();
+    uint32_t getBytesWritten();
+    void clearOutput();
+    void setRoom(int room);
+
+  private:
+    uint8_t _output[OUTPUT_SIZE]; // first bytes written since the output was cleared
+    uint32_t _bytesWritten;       // bytes written since the output was cleared
+    int _room;                    // free bytes of the transmit buffer, one more is sent each time it is read
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * TimerOne.h
+ *
+ * Host shim of the TimerOne library. The interrupt is never fired by itself: the tests call the attached
+ * function when they want a MIDI clock tick
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TimerOne_h_
+#define TimerOne_h_
+
+class TimerOne
+{
+  public:
+    TimerOne() : _period(0), _isr(0) {}
+    void initialize(unsigned long microseconds = 1000000) { _period = microseconds; }
+    void setPeriod(unsigned long microseconds) { _period = microseconds; }
+    void attachInterrupt(void (*isr)()) { _isr = isr; }
+    void detachInterrupt() { _isr = 0; }
+    void start() {}
+    void stop() {}
+    void restart() {}
+    unsigned long getPeriod() { return _period; }
+
+  private:
+    unsigned long _period; // period (us) of the interrupt
+    void (*_isr)();        // function attached to the interrupt
+};
+
+extern TimerOne Timer1;
+
+#endif
@@ -0,0 +1,48 @@
+/*
+ * Wire.h
+ *
+ * Host shim of the Arduino I2C library. No device answers on the bus: the LCD is emulated by hd44780_I2Cemu
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef Wire_h
+#define Wire_h
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH 32
+
+class TwoWire : public Print
+{
+  public:
+    TwoWire() : _clock(100000) {}
+    void begin() {}
+    void setClock(uint32_t clock) { _clock = clock; }
+    uint32_t getClock() { return _clock; }
+    void beginTransmission(uint8_t address) {}
+    uint8_t endTransmission(uint8_t sendStop = 1) { return 2; }
+    size_t write(uint8_t value) { return 1; }
+    using Print::write;
+    uint8_t requestFrom(uint8_t address, uint8_t quantity) { return 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+
+  private:
+    uint32_t _clock; // bus clock set by the last setClock() call
+};
+
+extern TwoWire Wire;
+
+#endif
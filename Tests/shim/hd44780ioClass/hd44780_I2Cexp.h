@@ -0,0 +1,44 @@
+/*
+ * hd44780_I2Cexp.h
+ *
+ * Host replacement of the i2c expander i/o class of the hd44780 library. It is the hd44780_I2Cemu emulator, so the
+ * libraries that drive the screen draw on an emulated LCD. The last LCD constructed can be reached with getLast(),
+ * as the LCD is a private member of the screen manager
+ *
+ * Copyright 2018 3K MEDIALAB
+ *   
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef hd44780_I2Cexp_h
+#define hd44780_I2Cexp_h
+
+#include <hd44780ioClass/hd44780_I2Cemu.h>
+
+class hd44780_I2Cexp : public hd44780_I2Cemu
+{
+  public:
+    hd44780_I2Cexp() { last() = this; }
+    hd44780_I2Cexp(uint8_t addr) { last() = this; }
+    hd44780_I2Cexp(uint8_t addr, uint8_t cols, uint8_t rows) { last() = this; }
+
+    static hd44780_I2Cexp *getLast() { return last(); }
+
+  private:
+    static hd44780_I2Cexp *&last()
+    {
+        static hd44780_I2Cexp *lcd = NULL;
+        return lcd;
+    }
+};
+
+#endif
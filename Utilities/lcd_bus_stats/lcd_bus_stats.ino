@@ -0,0 +1,78 @@
+/*
+   LCD bus statistics
+   Print a full screen line one character at a time and as a block, and report through the serial port
+   the I2C write transactions and bytes the LCD i/o expander needed for each of them
+   Copyright 2018 3K MEDIALAB
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+     http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// enable the I2C counters of the i/o expander class
+#define hd44780_I2Cexp_STATS
+
+#include <Wire.h>
+#include <hd44780.h>
+#include <hd44780ioClass/hd44780_I2Cexp.h>
+
+#define COLUMNS 16
+#define ROWS 2
+
+hd44780_I2Cexp _lcd;
+
+const char line[COLUMNS + 1] = "Seq:1/10 120 BPM";
+
+/*
+* Print the I2C counters of a test and reset them
+* test: name of the test
+* transactions: counter of transactions before the test
+* bytes: counter of bytes before the test
+*/
+void printStats(const __FlashStringHelper *test, int transactions, int bytes)
+{
+  Serial.print(test);
+  Serial.print(F(": "));
+  Serial.print(_lcd.getProp(hd44780_I2Cexp::Prop_i2cTransactions) - transactions);
+  Serial.print(F(" transactions, "));
+  Serial.print(_lcd.getProp(hd44780_I2Cexp::Prop_i2cBytes) - bytes);
+  Serial.println(F(" bytes"));
+}
+
+void setup()
+{
+  Serial.begin(9600);
+
+  _lcd.begin(COLUMNS, ROWS);
+  Wire.setClock(400000L);
+
+  int transactions = _lcd.getProp(hd44780_I2Cexp::Prop_i2cTransactions);
+  int bytes = _lcd.getProp(hd44780_I2Cexp::Prop_i2cBytes);
+
+  // one character at a time
+  _lcd.setCursor(0, 0);
+  for (uint8_t i = 0; i < COLUMNS; i++)
+  {
+    _lcd.write((uint8_t)line[i]);
+  }
+
+  printStats(F("Per character"), transactions, bytes);
+
+  transactions = _lcd.getProp(hd44780_I2Cexp::Prop_i2cTransactions);
+  bytes = _lcd.getProp(hd44780_I2Cexp::Prop_i2cBytes);
+
+  // the whole line, as the screen manager does
+  _lcd.setCursor(0, 1);
+  _lcd.print(line);
+
+  printStats(F("Block"), transactions, bytes);
+}
+
+void loop()
+{
+}
@@ -28,6 +28,7 @@
 /* 10 SEQUENCES WITH 8 STEPS							 		*/
 /****************************************************************/
 #define MEMORY_SIZE 1024
+#define MEMORY_FORMAT 0x5A
 
 #define NUM_PAGES 10
 #define NUM_SEQUENCES 10
@@ -39,7 +40,12 @@
 #define MIDI_POTS_SIZE 3
 
 #define SEQUENCE_LENGTH 8
-#define STEP_SIZE 3
+#define STEP_SIZE 1
+#define BITMAP_SIZE ((SEQUENCE_LENGTH + 7) / 8)
+
+#define CHAIN_LENGTH 16
+#define CHAIN_SIZE (1 + (2 * CHAIN_LENGTH))
+#define SONG_ENTRIES 4
 
 // create the global configuration object
 GlobalConfig _config = GlobalConfig(1, 2, MIDIUtils::Aeolian, MIDIUtils::C, 1);
@@ -68,10 +74,14 @@ Step s6(NOTE_A_1, 1, 0);
 Step s7(NOTE_B_1, 1, 0);
 Step s8(NOTE_C0, 1, 0);
 
+// SONG DATA: sequence and repeats of each entry of the song chain
+uint8_t songSequences[SONG_ENTRIES] = {1, 2, 1, 3};
+uint8_t songRepeats[SONG_ENTRIES] = {2, 1, 2, 4};
+
 uint16_t address = 0;
 
 uint8_t pageSize = (MIDI_BUTTONS_NUM * MIDI_BUTTONS_SIZE) + (MIDI_POTS_NUM * MIDI_POTS_SIZE);
-uint8_t sequenceSize = (SEQUENCE_LENGTH * STEP_SIZE);
+uint8_t sequenceSize = sizeof(uint8_t) + (2 * BITMAP_SIZE) + (SEQUENCE_LENGTH * STEP_SIZE);
 
 
 void setup(void)
@@ -89,6 +99,10 @@ void setup(void)
   address += sizeof(uint8_t);
   EEPROM.update(address, _config.getSendClockWhilePlayback());
   address += sizeof(uint8_t);
+
+  // STORE THE FORMAT MARKER OF THE MEMORY LAYOUT
+  EEPROM.update(address, MEMORY_FORMAT);
+  address += sizeof(uint8_t);
 	
   // STORE PAGES DATA
   for (int i = 0; i < NUM_PAGES; i++)
@@ -108,10 +122,11 @@ void setup(void)
     saveMIDIMessage(&address, p3m);
   }
   
-  // STORE SEQUENCES DATA
+  // STORE SEQUENCES DATA: length, enabled steps bitmap, stored parameters bitmap and the enabled steps
   for (int i = 0; i < NUM_SEQUENCES; i++)
   { 
-    
+    saveSequenceHeader(&address, SEQUENCE_LENGTH);
+
     if (i==0)
     {      
       saveStep(&address, s1);    
@@ -153,13 +168,25 @@ void setup(void)
  
   }
   
-  // LOAD THE REST OF THE MEMORY SLOTS WITH DEFAULT VALUE
-  while (address < MEMORY_SIZE)
+  // LOAD THE REST OF THE SEQUENCES AREA WITH DEFAULT VALUE
+  while (address < MEMORY_SIZE - CHAIN_SIZE)
   {
 	EEPROM.update(address,-1);
 	address += sizeof(uint8_t);
   } 
 
+  // STORE SONG DATA AT THE END OF THE MEMORY: number of entries, then the sequence and repeats of each entry
+  EEPROM.update(address, SONG_ENTRIES);
+  address += sizeof(uint8_t);
+
+  for (int i = 0; i < CHAIN_LENGTH; i++)
+  {
+    EEPROM.update(address, i < SONG_ENTRIES ? songSequences[i] : 0);
+    address += sizeof(uint8_t);
+    EEPROM.update(address, i < SONG_ENTRIES ? songRepeats[i] : 0);
+    address += sizeof(uint8_t);
+  }
+
   address = 0;
    
   // Print the stored global configuration
@@ -183,6 +210,10 @@ void setup(void)
   Serial.println(EEPROM.read(address), DEC);
   address++;
 
+  Serial.println("MEMORY FORMAT");
+  Serial.println(EEPROM.read(address), DEC);
+  address++;
+
   // Print the pages stored messages
   for (int i = 0; i < NUM_PAGES * ((MIDI_BUTTONS_NUM * MIDI_BUTTONS_SIZE) + (MIDI_POTS_NUM * MIDI_POTS_SIZE)); i++)
   {
@@ -197,12 +228,12 @@ void setup(void)
   }
   
   // Print the sequencers stored steps  
-  for (int i = 0; i < (NUM_SEQUENCES * SEQUENCE_LENGTH) * STEP_SIZE; i++)
+  for (int i = 0; i < NUM_SEQUENCES * sequenceSize; i++)
   {
-    if (i % 3 == 0)
+    if (i % sequenceSize == 0)
     {
-      Serial.print("STEP: ");
-      Serial.println(i / 3, DEC);
+      Serial.print("SEQUENCE: ");
+      Serial.println((i / sequenceSize) + 1, DEC);
     }
   
     Serial.println(EEPROM.read(address), DEC);
@@ -225,12 +256,28 @@ void saveMIDIMessage(uint16_t * address, MIDIMessage message)
   (*address) += sizeof(uint8_t); 
 }
 
-void saveStep(uint16_t * address, Step step)
+void saveSequenceHeader(uint16_t * address, uint8_t sequenceLength)
 {
-   EEPROM.update((*address),step.getNote());
+   EEPROM.update((*address), sequenceLength);
    (*address) += sizeof(uint8_t);
-   EEPROM.update((*address),step.isEnabled());
+
+   // all the steps are enabled
+   for (int i = 0; i < BITMAP_SIZE; i++)
+   {
+     EEPROM.update((*address), (sequenceLength - (i * 8)) >= 8 ? 0xFF : (1 << (sequenceLength - (i * 8))) - 1);
+     (*address) += sizeof(uint8_t);
+   }
+
+   // all the steps have the default velocity, probability and ratchets
+   for (int i = 0; i < BITMAP_SIZE; i++)
+   {
+     EEPROM.update((*address), 0);
+     (*address) += sizeof(uint8_t);
+   }
+}
+
+void saveStep(uint16_t * address, Step step)
+{
+   EEPROM.update((*address), (step.getNote() & 0x7F) | (step.isLegato() ? 0x80 : 0));
    (*address) += sizeof(uint8_t);
-   EEPROM.update((*address),step.isLegato());
-   (*address) += sizeof(uint8_t);  
 }